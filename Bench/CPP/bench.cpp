@@ -0,0 +1,440 @@
+/**
+* @file bench.cpp
+* @brief Benchmark suite for the OptiSim library.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*
+* Every benchmark is run with a growing number of iterations until one run takes at least the minimum time,
+* and the time per iteration of that run is reported, in the manner of Google Benchmark. The systems used by
+* the benchmarks are generated by `SystemGenerator` from a fixed seed, so results are comparable between builds.
+*
+* Usage: `OptiSimBench [--filter=<substring>] [--format=console|json|csv] [--out=<file>] [--min_time=<seconds>] [--max_size=<elements>]`
+*
+* Build with `-DCMAKE_BUILD_TYPE=Release` for meaningful numbers.
+*/
+
+#include <iostream>   // For standard output
+#include <iomanip>    // For formatting output (setw, setprecision)
+#include <fstream>    // For the result file
+#include <chrono>     // For timing
+#include <ctime>      // For the date in the result context
+#include <string>     // For benchmark names
+#include <vector>     // For the benchmark list
+#include <functional> // For the benchmark bodies
+#include <memory>     // For the state shared by a benchmark body
+#include <cstdio>     // For std::remove
+#include "OptiSim.h"  // Main header for the OptiSim library components
+
+using namespace std;
+
+#ifndef OPTISIM_BUILD_TYPE
+#define OPTISIM_BUILD_TYPE ""
+#endif
+
+/**
+ * @brief Keeps the optimizer from discarding the result of a benchmarked call.
+ */
+static volatile double sink;
+
+/**
+ * @brief A registered benchmark.
+ */
+struct benchmark {
+    /**
+     * @brief The name of the benchmark, `<operation>/<size>` for sized benchmarks.
+     */
+    string name;
+
+    /**
+     * @brief The number of items (elements, calls) processed by one iteration, for the throughput.
+     */
+    long long items;
+
+    /**
+     * @brief Builds the state of the benchmark and returns its body, which runs the given number of iterations.
+     * @details Setup is deferred so that filtered-out benchmarks build nothing.
+     */
+    function<function<void(long long)>()> prepare;
+};
+
+/**
+ * @brief The measurement of a benchmark.
+ */
+struct benchmark_result {
+    string name;
+    long long iterations;
+    double ns_per_iteration;
+    double items_per_second;
+};
+
+// Synthetic systems ----------------------------------------------------------
+
+/**
+ * @brief Fills a system with generated thin lenses only.
+ * @param OS The system to fill; it should be empty.
+ * @param count The number of lenses.
+ */
+void generate_thin_system(OpticalSystem& OS, int count){
+    SystemGenerator generator = SystemGenerator(1);
+    generator.setThickFraction(0);
+    generator.generate(OS, count);
+}
+
+/**
+ * @brief Fills a system with generated thin and thick lenses in equal proportion.
+ * @param OS The system to fill; it should be empty.
+ * @param count The number of lenses.
+ */
+void generate_mixed_system(OpticalSystem& OS, int count){
+    SystemGenerator(1).generate(OS, count);
+}
+
+// Harness --------------------------------------------------------------------
+
+/**
+ * @brief Runs a benchmark body with a growing number of iterations until one run lasts at least `min_time`.
+ * @param b The benchmark.
+ * @param min_time The minimum duration of the measured run, in seconds.
+ * @return The measurement of the last run.
+ */
+benchmark_result run_benchmark(const benchmark& b, double min_time){
+    function<void(long long)> body = b.prepare();
+    long long iterations = 1;
+    while (true) {
+        auto start = chrono::steady_clock::now();
+        body(iterations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (seconds >= min_time || iterations >= 1000000000LL) {
+            return {b.name, iterations, seconds * 1e9 / iterations, b.items * iterations / seconds};
+        }
+        // aim 40% above the minimum time, growing at most tenfold per step
+        double factor = seconds > 0 ? min_time * 1.4 / seconds : 10.0;
+        iterations = max(iterations + 1, (long long)(iterations * min(factor, 10.0)));
+    }
+}
+
+/**
+ * @brief Registers the benchmarks.
+ * @param max_size The largest system size to benchmark.
+ * @return The benchmarks in execution order.
+ */
+vector<benchmark> register_benchmarks(int max_size){
+    vector<benchmark> list;
+    vector<int> sizes;
+    for (int size = 1; size <= max_size; size *= 10) sizes.push_back(size);
+
+    list.push_back({"ThinLens::Calculate", 1, []() {
+        auto ThinL = make_shared<ThinLens>(50, 20);
+        return function<void(long long)>([ThinL](long long iterations) {
+            LightSource LS = LightSource(0, 5);
+            double acc = 0;
+            for (long long i = 0; i < iterations; i++) acc += ThinL->Calculate(LS).getX();
+            sink = acc;
+        });
+    }});
+
+    list.push_back({"ThickLens::Calculate", 1, []() {
+        auto ThickL = make_shared<ThickLens>(50, 1.5, 5, 30, -30);
+        return function<void(long long)>([ThickL](long long iterations) {
+            LightSource LS = LightSource(0, 5);
+            double acc = 0;
+            for (long long i = 0; i < iterations; i++) acc += ThickL->Calculate(LS).getX();
+            sink = acc;
+        });
+    }});
+
+    // every call follows a move, so the cached principal planes are recomputed each time
+    list.push_back({"ThickLens::Calculate/moved", 1, []() {
+        auto ThickL = make_shared<ThickLens>(50, 1.5, 5, 30, -30);
+        return function<void(long long)>([ThickL](long long iterations) {
+            LightSource LS = LightSource(0, 5);
+            double acc = 0;
+            for (long long i = 0; i < iterations; i++) {
+                ThickL->setX((i & 1) ? 50 : 51);
+                acc += ThickL->Calculate(LS).getX();
+            }
+            sink = acc;
+        });
+    }});
+
+    for (int size : sizes) {
+        if (size < 1000) continue;
+        list.push_back({"OpticalSystem::add/" + to_string(size), size, [size]() {
+            return function<void(long long)>([size](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    OpticalSystem OS = OpticalSystem();
+                    generate_thin_system(OS, size);
+                }
+            });
+        }});
+    }
+
+    for (int size : sizes) {
+        list.push_back({"OpticalSystem::Calculate/" + to_string(size), size, [size]() {
+            auto OS = make_shared<OpticalSystem>();
+            generate_mixed_system(*OS, size);
+            return function<void(long long)>([OS](long long iterations) {
+                double acc = 0;
+                for (long long i = 0; i < iterations; i++) acc += OS->Calculate().getX();
+                sink = acc;
+            });
+        }});
+    }
+
+    // a bundle of skew rays through ten elements, on the on-axis and on the general path, and with
+    // apertures that block part of the bundle so the live rays are compacted along the way
+    for (int size : sizes) {
+        if (size < 100) continue;
+        for (string mode : {"centered", "tilted", "vignetted"}) {
+            string name = "OpticalSystem::TraceRays/" + mode + "/" + to_string(size);
+            list.push_back({name, size, [size, mode]() {
+                auto OS = make_shared<OpticalSystem>();
+                generate_mixed_system(*OS, 10);
+                for (const element_info& info : OS->getElements()) {
+                    if (mode == "tilted") OS->modifyOpticalObject(info.name, "tilt_y", 1);
+                    if (mode == "vignetted") OS->modifyOpticalObject(info.name, "aperture", 2);
+                }
+                auto rays = make_shared<ray_bundle>();
+                for (int i = 0; i < size; i++) {
+                    rays->x.push_back(0);
+                    rays->y.push_back(1);
+                    rays->z.push_back(0);
+                    rays->u.push_back(-0.05 + 0.1 * i / size);
+                    rays->v.push_back(0.01);
+                }
+                auto bundle = make_shared<ray_bundle>(*rays);
+                return function<void(long long)>([OS, rays, bundle](long long iterations) {
+                    double acc = 0;
+                    for (long long i = 0; i < iterations; i++) {
+                        *bundle = *rays;
+                        OS->TraceRays(*bundle);
+                        acc += bundle->y[0];
+                    }
+                    sink = acc;
+                });
+            }});
+        }
+    }
+
+    // a batch of Gaussian beams through ten elements
+    for (int size : sizes) {
+        if (size < 100) continue;
+        list.push_back({"OpticalSystem::PropagateBeams/" + to_string(size), size, [size]() {
+            auto OS = make_shared<OpticalSystem>();
+            generate_mixed_system(*OS, 10);
+            auto beams = make_shared<beam_bundle>();
+            for (int i = 0; i < size; i++) {
+                beams->waist_x.push_back(-1.0 * i / size);
+                beams->waist_w.push_back(0.1 + 0.5 * i / size);
+                beams->wavelength.push_back(0.4 + 0.3 * i / size);
+            }
+            return function<void(long long)>([OS, beams](long long iterations) {
+                double acc = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    OS->PropagateBeams(*beams);
+                    acc += beams->w.back();
+                }
+                sink = acc;
+            });
+        }});
+    }
+
+    for (int size : sizes) {
+        if (size < 100) continue;
+        list.push_back({"OpticalSystem::save/" + to_string(size), size, [size]() {
+            auto OS = make_shared<OpticalSystem>();
+            generate_mixed_system(*OS, size);
+            return function<void(long long)>([OS](long long iterations) {
+                for (long long i = 0; i < iterations; i++) OS->save("bench_system.json");
+            });
+        }});
+        list.push_back({"OpticalSystem::OpticalSystem(string)/" + to_string(size), size, [size]() {
+            OpticalSystem OS = OpticalSystem();
+            generate_mixed_system(OS, size);
+            OS.save("bench_system.json");
+            return function<void(long long)>([](long long iterations) {
+                for (long long i = 0; i < iterations; i++) OpticalSystem("bench_system.json");
+            });
+        }});
+    }
+
+    for (int size : sizes) {
+        if (size < 100) continue;
+        list.push_back({"OpticalSystem::getRays/" + to_string(size), size, [size]() {
+            auto OS = make_shared<OpticalSystem>();
+            generate_mixed_system(*OS, size);
+            OS->Calculate();
+            return function<void(long long)>([OS](long long iterations) {
+                double acc = 0;
+                for (long long i = 0; i < iterations; i++) acc += OS->getRays().at("ray_1").x.size();
+                sink = acc;
+            });
+        }});
+        list.push_back({"OpticalSystem::getSystemElements/" + to_string(size), size, [size]() {
+            auto OS = make_shared<OpticalSystem>();
+            generate_mixed_system(*OS, size);
+            return function<void(long long)>([OS](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    map<string, OpticalObject*> elements = OS->getSystemElements();
+                    for (auto& element : elements) delete element.second;
+                }
+            });
+        }});
+        list.push_back({"OpticalSystem::getElements/" + to_string(size), size, [size]() {
+            auto OS = make_shared<OpticalSystem>();
+            generate_mixed_system(*OS, size);
+            return function<void(long long)>([OS](long long iterations) {
+                double acc = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    for (const element_info& info : OS->getElements()) acc += info.x;
+                }
+                sink = acc;
+            });
+        }});
+        list.push_back({"OpticalSystem::exportElements/" + to_string(size), size, [size]() {
+            auto OS = make_shared<OpticalSystem>();
+            generate_mixed_system(*OS, size);
+            auto columns = make_shared<vector<double>>(2 * size);
+            return function<void(long long)>([OS, columns, size](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    OS->exportElements(nullptr, columns->data(), columns->data() + size, nullptr, nullptr, nullptr, nullptr, size);
+                }
+                sink = (*columns)[0];
+            });
+        }});
+    }
+    // the image list and the rays in every output format, written to a file
+    for (int size : sizes) {
+        if (size < 100) continue;
+        for (string format : {"text", "json", "csv", "bin"}) {
+            list.push_back({"Report::write/" + format + "/" + to_string(size), size, [size, format]() {
+                auto OS = make_shared<OpticalSystem>();
+                generate_mixed_system(*OS, size);
+                OS->Calculate();
+                report_format output_format = Report::parseFormat(format);
+                return function<void(long long)>([OS, output_format](long long iterations) {
+                    for (long long i = 0; i < iterations; i++) {
+                        ofstream file("bench_output", ios::out | ios::binary);
+                        Report::write(*OS, file, true, true, output_format);
+                    }
+                });
+            }});
+        }
+    }
+    return list;
+}
+
+// Reporting ------------------------------------------------------------------
+
+/**
+ * @brief Writes the results as a Google Benchmark style JSON document.
+ * @param os The output stream.
+ * @param results The measurements.
+ */
+void write_json(ostream& os, const vector<benchmark_result>& results){
+    time_t now = time(nullptr);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    os << "{\n  \"context\": {\n"
+       << "    \"date\": \"" << date << "\",\n"
+       << "    \"library_version\": \"" << getOptiSimVersionString() << "\",\n"
+       << "    \"library_build_type\": \"" << OPTISIM_BUILD_TYPE << "\"\n"
+       << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        os << (i ? "," : "") << "\n    {\"name\": \"" << results[i].name << "\", "
+           << "\"iterations\": " << results[i].iterations << ", "
+           << "\"real_time\": " << setprecision(10) << results[i].ns_per_iteration << ", "
+           << "\"time_unit\": \"ns\", "
+           << "\"items_per_second\": " << results[i].items_per_second << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+/**
+ * @brief Writes the results as CSV, one benchmark per line.
+ * @param os The output stream.
+ * @param results The measurements.
+ */
+void write_csv(ostream& os, const vector<benchmark_result>& results){
+    os << "name,iterations,real_time,time_unit,items_per_second\n";
+    for (const auto& result : results) {
+        os << "\"" << result.name << "\"," << result.iterations << "," << setprecision(10)
+           << result.ns_per_iteration << ",ns," << result.items_per_second << "\n";
+    }
+}
+
+/**
+ * @brief Prints one result as a row of the console table.
+ * @param result The measurement.
+ */
+void write_console_row(const benchmark_result& result){
+    cout << left << setw(48) << result.name << right << setw(14) << fixed << setprecision(1)
+         << result.ns_per_iteration << " ns" << setw(12) << result.iterations
+         << setw(16) << setprecision(0) << result.items_per_second << " items/s\n";
+    cout.unsetf(ios::fixed);
+}
+
+/**
+ * @brief Main function to run the benchmarks.
+ * @return 0 on success, 1 on invalid arguments or an unwritable output file.
+ */
+int main(int argc, char* argv[]){
+    string filter = "";
+    string format = "console";
+    string out = "";
+    double min_time = 0.5;
+    int max_size = 100000;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        try {
+            if (key == "--filter") filter = value;
+            else if (key == "--format") format = value;
+            else if (key == "--out") out = value;
+            else if (key == "--min_time") min_time = stod(value);
+            else if (key == "--max_size") max_size = stoi(value);
+            else throw invalid_argument(arg);
+        } catch (exception&) {
+            cerr << "ERROR: \tInvalid argument: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (format != "console" && format != "json" && format != "csv") {
+        cerr << "ERROR: \tInvalid format: " << format << "\n";
+        return 1;
+    }
+
+    if (format == "console") {
+        cout << "OptiSim " << getOptiSimVersionString() << " benchmarks\n"
+             << left << setw(48) << "Benchmark" << right << setw(17) << "Time" << setw(12) << "Iterations"
+             << setw(24) << "Throughput" << "\n" << string(101, '-') << "\n";
+    }
+
+    vector<benchmark_result> results;
+    for (const benchmark& b : register_benchmarks(max_size)) {
+        if (b.name.find(filter) == string::npos) continue;
+        results.push_back(run_benchmark(b, min_time));
+        if (format == "console") write_console_row(results.back());
+    }
+    std::remove("bench_system.json");
+    std::remove("bench_output");
+
+    if (format != "console") {
+        ofstream file;
+        if (!out.empty()) {
+            file.open(out);
+            if (!file.is_open()) {
+                cerr << "ERROR: \tFailed to open file for writing: " << out << "\n";
+                return 1;
+            }
+        }
+        ostream& os = out.empty() ? cout : file;
+        if (format == "json") write_json(os, results);
+        else write_csv(os, results);
+    }
+    return 0;
+}
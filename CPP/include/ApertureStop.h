@@ -0,0 +1,40 @@
+/**
+* @file ApertureStop.h
+* @brief Defines the ApertureStop class, a diaphragm that limits the rays without refracting them.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef APERTURESTOP_H
+#define APERTURESTOP_H
+
+#include "OpticalObject.h"  // Inherits from the base OpticalObject class
+
+/**
+ * @class ApertureStop
+ * @brief Represents a circular opening (an iris or a diaphragm) in an optical system.
+ *
+ * A stop has no optical power: it leaves every image where it is and only blocks the rays
+ * that pass outside its aperture radius.
+ */
+class ApertureStop: public OpticalObject{
+    public:
+        /**
+         * @brief Constructs a new ApertureStop object.
+         */
+        ApertureStop(double, double);
+
+        /**
+         * @brief Calculates the image formed by this stop, which is the subject itself.
+         * @return An `Image` object at the position of the subject.
+         */
+        Image Calculate(const ImagingSubject&) override;
+
+        /**
+         * @brief Traces a bundle of rays to the plane of this stop.
+         */
+        void TraceRays(double*, double*, double*, double*, double*, char*, size_t) override;
+};
+
+#endif // APERTURESTOP_H
@@ -0,0 +1,155 @@
+/**
+* @file BatchRunner.h
+* @brief Defines the BatchRunner class, which evaluates many system files in one process.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <vector>           // For the inputs and errors
+#include <string>           // For file names
+#include "Report.h"         // For the report formats
+
+using namespace std;
+
+/**
+ * @struct batch_result
+ * @brief Summarizes a batch run.
+ */
+struct batch_result {
+    /** @brief The number of input systems. */
+    long long inputs;
+    /** @brief The number of inputs that could not be loaded, calculated or written. */
+    long long failed;
+    /** @brief The number of optical elements evaluated over all successful inputs. */
+    long long elements;
+    /** @brief The wall-clock duration of the run in seconds. */
+    double elapsed_seconds;
+    /** @brief The number of input systems processed per second. */
+    double systems_per_second;
+    /** @brief The number of optical elements evaluated per second. */
+    double elements_per_second;
+    /** @brief One message per failed input, "<input>: <error>", in input order. */
+    vector<string> errors;
+};
+
+/**
+ * @class BatchRunner
+ * @brief Loads, calculates and reports many system files concurrently.
+ *
+ * Inputs are collected from single files, directories, glob patterns and manifest files, and are then
+ * processed by a pool of worker threads, each taking the next unprocessed input. Every input produces the
+ * same report as a single run of the `OptiSim` tool, written either to its own file in an output directory
+ * or, in input order, to one aggregated file. A failing input does not stop the batch; its error is recorded
+ * in the result instead.
+ */
+class BatchRunner{
+    private:
+        /**
+         * @brief The input files, in processing order.
+         */
+        vector<string> inputs;
+
+        /**
+         * @brief The number of worker threads.
+         */
+        int threads;
+
+        /**
+         * @brief The directory receiving one report per input, or empty.
+         */
+        string output_directory;
+
+        /**
+         * @brief The file receiving all reports, or empty.
+         */
+        string aggregate_file;
+
+        /**
+         * @brief True to append the image list to the reports.
+         */
+        bool image_list;
+
+        /**
+         * @brief True to append the ray coordinates to the reports.
+         */
+        bool rays;
+
+        /**
+         * @brief The format of the reports.
+         */
+        report_format format;
+
+    public:
+        /**
+         * @brief Constructs a BatchRunner without inputs.
+         */
+        BatchRunner();
+
+        /**
+         * @brief Adds one system file.
+         */
+        void addInput(const string&);
+
+        /**
+         * @brief Adds every `.json` file of a directory.
+         */
+        void addDirectory(const string&);
+
+        /**
+         * @brief Adds every file matching a glob pattern.
+         */
+        void addGlob(const string&);
+
+        /**
+         * @brief Adds the system files listed in a manifest file.
+         */
+        void addManifest(const string&);
+
+        /**
+         * @brief Retrieves the inputs collected so far.
+         * @return The input files in processing order.
+         */
+        vector<string> getInputs();
+
+        /**
+         * @brief Sets the number of worker threads.
+         */
+        void setThreads(int);
+
+        /**
+         * @brief Writes one report per input into a directory.
+         */
+        void setOutputDirectory(const string&);
+
+        /**
+         * @brief Writes all reports, in input order, into one file.
+         */
+        void setAggregateOutput(const string&);
+
+        /**
+         * @brief Sets whether the reports include the image list.
+         */
+        void setImageList(bool);
+
+        /**
+         * @brief Sets whether the reports include the ray coordinates.
+         */
+        void setRays(bool);
+
+        /**
+         * @brief Sets the format of the reports.
+         */
+        void setFormat(report_format);
+
+        /**
+         * @brief Processes all inputs.
+         * @return The summary of the run.
+         */
+        batch_result run();
+};
+
+#endif // BATCHRUNNER_H
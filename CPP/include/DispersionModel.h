@@ -0,0 +1,86 @@
+/**
+* @file DispersionModel.h
+* @brief Defines the DispersionModel class, the wavelength dependence of a refractive index.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef DISPERSIONMODEL_H
+#define DISPERSIONMODEL_H
+
+#include <vector>           // For the coefficients
+#include <string>           // For the model name
+#include <cstddef>          // For size_t
+
+using namespace std;
+
+/**
+ * @brief The wavelength of the helium d-line in micrometres, the reference wavelength of the scalar refractive index.
+ */
+#define OPTISIM_REFERENCE_WAVELENGTH 0.5875618
+
+/**
+ * @class DispersionModel
+ * @brief Computes the refractive index of a material as a function of wavelength.
+ *
+ * Two models are supported, both with wavelengths in micrometres:
+ * - **Cauchy:** $ n(\lambda) = A_0 + A_1 / \lambda^2 + A_2 / \lambda^4 + \dots $
+ * - **Sellmeier:** $ n^2(\lambda) = 1 + \sum_i B_i \lambda^2 / (\lambda^2 - C_i) $, with $C_i$ in square micrometres.
+ *
+ * The batch method evaluates many wavelengths in one pass over contiguous arrays.
+ */
+class DispersionModel{
+    private:
+        /**
+         * @brief True for the Sellmeier model, false for the Cauchy model.
+         */
+        bool sellmeier;
+
+        /**
+         * @brief The Cauchy coefficients $A_i$ or the Sellmeier coefficients $B_i$.
+         */
+        vector<double> b;
+
+        /**
+         * @brief The Sellmeier coefficients $C_i$ (unused by the Cauchy model).
+         */
+        vector<double> c;
+
+    public:
+        /**
+         * @brief Constructs a DispersionModel from a model name and its coefficients.
+         */
+        DispersionModel(string, vector<double>, vector<double> c = {});
+
+        /**
+         * @brief Retrieves the name of the model.
+         * @return "cauchy" or "sellmeier".
+         */
+        string getModel() const;
+
+        /**
+         * @brief Retrieves the Cauchy coefficients or the Sellmeier B coefficients.
+         * @return The coefficients passed to the constructor as the first list.
+         */
+        vector<double> getB() const;
+
+        /**
+         * @brief Retrieves the Sellmeier C coefficients.
+         * @return The coefficients passed to the constructor as the second list.
+         */
+        vector<double> getC() const;
+
+        /**
+         * @brief Computes the refractive index at one wavelength.
+         * @return The refractive index at the given wavelength (in micrometres).
+         */
+        double getIndex(double) const;
+
+        /**
+         * @brief Computes the refractive index at many wavelengths.
+         */
+        void getIndices(const double*, double*, size_t) const;
+};
+
+#endif // DISPERSIONMODEL_H
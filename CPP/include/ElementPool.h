@@ -0,0 +1,111 @@
+/**
+* @file ElementPool.h
+* @brief Defines the ElementPool class, the memory pool of the elements of an optical system.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef ELEMENTPOOL_H
+#define ELEMENTPOOL_H
+
+#include <memory_resource>  // For the pool and the upstream resource
+#include <cstddef>          // For std::max_align_t
+#include <new>              // For placement new
+#include <type_traits>      // For std::is_polymorphic
+#include <utility>          // For std::forward
+
+using namespace std;
+
+/**
+ * @class ElementPool
+ * @brief Allocates the elements of an optical system from pooled memory.
+ *
+ * Objects of the same size are carved out of large chunks, so the lenses of a system lie next to each other
+ * in memory instead of being scattered over the heap, and a destroyed object's slot is reused by the next one.
+ * The chunks are requested from an upstream `std::pmr::memory_resource`, the default resource unless the
+ * caller supplies another one (e.g. a `monotonic_buffer_resource` over a stack buffer), and are all returned
+ * at once when the pool is destroyed.
+ *
+ * The objects are still destroyed one by one with `destroy`, which runs their destructors; only their memory
+ * is released in bulk.
+ */
+class ElementPool{
+    private:
+        /**
+         * @brief The size of the header in front of every object, which records the size of its slot.
+         */
+        static constexpr size_t header_size = alignof(max_align_t);
+
+        /**
+         * @brief The pool the slots are taken from.
+         */
+        pmr::unsynchronized_pool_resource pool;
+
+        /**
+         * @brief The number of live objects.
+         */
+        size_t live;
+
+        /**
+         * @brief Takes a slot for an object of the given size from the pool.
+         */
+        void* allocate(size_t);
+
+        /**
+         * @brief Returns the slot of an object to the pool.
+         */
+        void deallocate(void*);
+
+    public:
+        /**
+         * @brief Constructs an empty ElementPool drawing its memory from an upstream resource.
+         */
+        explicit ElementPool(pmr::memory_resource* = pmr::get_default_resource());
+
+        ElementPool(const ElementPool&) = delete;
+        ElementPool& operator=(const ElementPool&) = delete;
+
+        /**
+         * @brief Constructs an object in the pool.
+         * @return A pointer to the new object, to be destroyed with `destroy`.
+         */
+        template <class T, class... Args>
+        T* create(Args&&... args){
+            static_assert(alignof(T) <= header_size, "ElementPool does not support over-aligned types");
+            void* slot = allocate(sizeof(T));
+            try {
+                return new (slot) T(forward<Args>(args)...);
+            } catch (...) {
+                deallocate(slot);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Destroys an object created by `create` and returns its slot to the pool; `nullptr` is ignored.
+         */
+        template <class T>
+        void destroy(T* object){
+            if (object == nullptr) return;
+            void* slot;
+            if constexpr (is_polymorphic<T>::value) slot = dynamic_cast<void*>(object); // the most derived object
+            else slot = object;
+            object->~T();
+            deallocate(slot);
+        }
+
+        /**
+         * @brief Retrieves the number of live objects.
+         * @return The number of objects created and not yet destroyed.
+         */
+        size_t size();
+
+        /**
+         * @brief Retrieves the resource the pool draws its memory from.
+         * @return The upstream resource.
+         */
+        pmr::memory_resource* getUpstream();
+};
+
+#endif // ELEMENTPOOL_H
@@ -0,0 +1,231 @@
+/**
+* @file ElementRegistry.h
+* @brief Defines the ElementRegistry class, the table of the element types a system can hold.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef ELEMENTREGISTRY_H
+#define ELEMENTREGISTRY_H
+
+#include "OpticalObject.h"      // The elements described by the registry
+#include "ElementPool.h"        // For copying elements into a system
+#include "OutputWriter.h"       // For the system summary
+#include "DispersionModel.h"    // For the dispersion of lenses
+
+#include <nlohmann/json.hpp>    // For the serializer hooks
+#include <vector>               // For the parameter schemas
+#include <string>               // For type and parameter names
+#include <string_view>          // For parameter lookup
+#include <memory>               // For std::unique_ptr
+#include <typeinfo>             // For the class of an element
+#include <atomic>               // For lock-free readers of the registry
+#include <mutex>                // For serializing registrations
+
+using namespace std;
+
+struct element_info;
+
+/**
+ * @brief The largest number of parameters in the schema of an element type.
+ */
+const size_t ELEMENT_MAX_PARAMS = 8;
+
+/**
+ * @brief The largest number of element types in the registry.
+ */
+const int ELEMENT_MAX_TYPES = 64;
+
+/**
+ * @struct element_param
+ * @brief One numeric parameter in the schema of an element type.
+ */
+struct element_param {
+    /** @brief The name used by `modifyOpticalObject`, the optimizer and the tolerance analysis (e.g. "f"). */
+    string name;
+    /** @brief The key in system files (e.g. "focal_length"); ignored for a read-only parameter. */
+    string key;
+    /** @brief The value of a missing key, or NaN if the key is required. An optional parameter equal to it is not written. */
+    double fallback;
+    /** @brief Reads the parameter. */
+    double (*get)(const OpticalObject&);
+    /** @brief Sets the parameter, or `nullptr` for a derived parameter such as the focal length of a thick lens. */
+    void (*set)(OpticalObject&, double);
+};
+
+/**
+ * @struct principal_planes
+ * @brief The paraxial imaging of an element: its focal length and the positions of its principal planes.
+ */
+struct principal_planes {
+    /** @brief The focal length; infinite for an element without optical power. */
+    double f;
+    /** @brief The position of the object-side principal plane. */
+    double h_left;
+    /** @brief The position of the image-side principal plane. */
+    double h_right;
+};
+
+/**
+ * @struct element_class
+ * @brief Everything a system needs to know about one type of optical objects.
+ *
+ * The position, decentering, tilt and aperture are common to all types and are handled by the registry
+ * and the system; the schema lists the other parameters. Loading, saving, printing, comparing and modifying
+ * elements work from the schema alone, and the optional hooks cover what a schema cannot express,
+ * such as the material of a thick lens.
+ */
+struct element_class {
+    /** @brief The type ID, assigned by `ElementRegistry::add`. */
+    int id;
+    /** @brief The value of the `type` key in system files (e.g. "thin"). */
+    string name;
+    /** @brief The name of the type in the system summary (e.g. "Thin Lens"). */
+    string label;
+    /** @brief The class of the elements; an element of a derived class is a type of its own. */
+    const type_info* cls;
+    /** @brief The parameters of the type besides the common ones, in the order `create` takes them. */
+    vector<element_param> params;
+    /** @brief Creates an element at a position from the values of its parameters, in schema order (read-only ones are NaN). */
+    unique_ptr<OpticalObject> (*create)(double, const double*);
+    /** @brief Copies an element into the pool of a system; see `copy_element`. */
+    OpticalObject* (*copy)(ElementPool&, const OpticalObject&);
+    /** @brief Copies an element onto the heap; see `clone_element`. */
+    OpticalObject* (*clone)(const OpticalObject&);
+    /** @brief The paraxial kernel: the principal planes of an element and, for arrays that are not `nullptr`, their derivatives with respect to the schema parameters. */
+    principal_planes (*kernel)(const OpticalObject&, double*, double*, double*);
+    /** @brief Optional: creates an element from its JSON description instead of `create`. */
+    unique_ptr<OpticalObject> (*load)(const nlohmann::json&);
+    /** @brief Optional: writes what the schema does not cover to the JSON description of an element. */
+    void (*save)(const OpticalObject&, nlohmann::json&);
+    /** @brief Optional: appends the position and parameters of an element to the summary instead of the schema. */
+    void (*print)(OutputWriter&, const OpticalObject&);
+    /** @brief Optional: compares what the schema does not cover. */
+    bool (*same)(const OpticalObject&, const OpticalObject&);
+    /** @brief Optional: fills in the parameters of an element in its `element_info`. */
+    void (*describe)(const OpticalObject&, element_info&);
+
+    /**
+     * @brief Looks up a parameter of the schema by name.
+     * @return The index of the parameter, or -1 if the type has no such parameter.
+     */
+    int param(string_view) const;
+};
+
+/**
+ * @brief Copies an element of class `T` into the element pool; the `copy` entry of the class `T`.
+ */
+template <class T>
+OpticalObject* copy_element(ElementPool& pool, const OpticalObject& element){
+    return pool.create<T>(static_cast<const T&>(element));
+}
+
+/**
+ * @brief Copies an element of class `T` onto the heap; the `clone` entry of the class `T`.
+ */
+template <class T>
+OpticalObject* clone_element(const OpticalObject& element){
+    return new T(static_cast<const T&>(element));
+}
+
+/**
+ * @class ElementRegistry
+ * @brief Stores the element types and dispatches the type-specific work of the systems by type ID.
+ *
+ * Every type is registered once, with a compact integer ID; the built-in types are registered first, so
+ * their IDs are the values of `element_type`. A system looks up the type of an element once, when the element
+ * is added, and afterwards finds its class by indexing the registry with the ID. Lookups take no lock, and
+ * types can be registered while other threads use the registry. A new type registered with
+ * `add` is loaded, saved, printed, modified, optimized and toleranced like the built-in ones, without changes
+ * to the rest of the library. The registry is shared by the whole process through `global()`.
+ */
+class ElementRegistry{
+    private:
+        /**
+         * @brief The registered classes, indexed by type ID. A registered class never moves or changes.
+         */
+        unique_ptr<const element_class> classes[ELEMENT_MAX_TYPES];
+
+        /**
+         * @brief The number of registered classes, published after the class itself so lookups need no lock.
+         */
+        atomic<int> count;
+
+        /**
+         * @brief Serializes registrations.
+         */
+        mutex registration;
+
+        /**
+         * @brief Constructs the registry with the built-in types.
+         */
+        ElementRegistry();
+
+    public:
+        /**
+         * @brief Retrieves the registry shared by the whole process.
+         * @return The global registry.
+         */
+        static ElementRegistry& global();
+
+        /**
+         * @brief Registers a new element type.
+         * @return The type ID of the new type.
+         */
+        int add(element_class);
+
+        /**
+         * @brief Retrieves a type by its ID.
+         * @return The class of the type.
+         */
+        const element_class& get(int) const;
+
+        /**
+         * @brief Retrieves the type of an element.
+         * @return The class of the element's type.
+         */
+        const element_class& of(const OpticalObject&) const;
+
+        /**
+         * @brief Looks up a type by its name in system files.
+         * @return The class of the type, or `nullptr` if there is no such type.
+         */
+        const element_class* find(const string&) const;
+
+        /**
+         * @brief Retrieves the number of registered types.
+         * @return The number of types.
+         */
+        int size() const;
+
+        /**
+         * @brief Creates an element from its JSON description, parameters and placement included.
+         * @return The new element.
+         */
+        static unique_ptr<OpticalObject> read(const element_class&, const nlohmann::json&);
+
+        /**
+         * @brief Writes the type, parameters and placement of an element to its JSON description.
+         */
+        static void write(const element_class&, const OpticalObject&, nlohmann::json&);
+
+        /**
+         * @brief Writes a dispersion model to its JSON description, in the form of the `dispersion` key of a lens.
+         * @return The JSON object describing the model.
+         */
+        static nlohmann::json writeDispersion(const DispersionModel&);
+
+        /**
+         * @brief Appends the position, parameters and placement of an element to the system summary.
+         */
+        static void print(const element_class&, OutputWriter&, const OpticalObject&);
+
+        /**
+         * @brief Tells whether two elements of a type have the same position, parameters and placement.
+         * @return True if the elements are interchangeable.
+         */
+        static bool same(const element_class&, const OpticalObject&, const OpticalObject&);
+};
+
+#endif // ELEMENTREGISTRY_H
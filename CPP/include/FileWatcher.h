@@ -0,0 +1,57 @@
+/**
+* @file FileWatcher.h
+* @brief Defines the FileWatcher class, which waits for a file to be rewritten.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <string>           // For file names
+
+using namespace std;
+
+/**
+ * @class FileWatcher
+ * @brief Reports when a file has been written, using inotify.
+ *
+ * The directory of the file is watched rather than the file itself, so the watcher keeps working when an
+ * editor saves by writing a new file and renaming it over the old one. A change is reported once the file
+ * is closed after writing or renamed into place; the events of one save are reported as a single change.
+ */
+class FileWatcher{
+    private:
+        /**
+         * @brief The name of the watched file within its directory.
+         */
+        string file_name;
+
+        /**
+         * @brief The inotify descriptor.
+         */
+        int fd;
+
+    public:
+        /**
+         * @brief Constructs a FileWatcher for a file.
+         */
+        FileWatcher(const string&);
+
+        /**
+         * @brief Stops watching and destroys the FileWatcher.
+         */
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /**
+         * @brief Waits until the file is written.
+         * @return True if the file was written, false if the timeout expired first.
+         */
+        bool wait(int timeout_ms = -1);
+};
+
+#endif // FILEWATCHER_H
@@ -28,7 +28,7 @@ class Image:public ImagingSubject{
         /**
          * @brief Constructs a new Image object.
          */
-        Image(double, double, bool);
+        Image(double, double, bool, double = 0);
         /**
          * @brief Sets the real/virtual status of the image.
          */
@@ -37,7 +37,7 @@ class Image:public ImagingSubject{
          * @brief Retrieves the real/virtual status of the image.
          * @return True if the image is real, false if it's virtual. 
          */
-        bool getReal();
+        bool getReal() const;
 };
 
 #endif // IMAGE_H
\ No newline at end of file
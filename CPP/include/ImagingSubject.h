@@ -12,7 +12,8 @@
  * @brief A base class representing a subject within an imaging system.
  *
  * This class provides fundamental properties like x and y coordinates for any
- * object that can be part of an imaging process. It uses a protected constructor,
+ * object that can be part of an imaging process. The z-coordinate places the subject
+ * out of the meridional plane; it is 0 unless the system has decentered or tilted elements. It uses a protected constructor,
  * meaning it's primarily intended to be subclassed by other classes (like `Image`).
  */
 #ifndef IMAGINGSUBJECT_H
@@ -23,7 +24,7 @@ class ImagingSubject{
         /**
          * @brief Constructs an ImagingSubject with given coordinates.
          */
-        ImagingSubject(double, double);
+        ImagingSubject(double, double, double = 0);
 
         /**
          * @brief The x-coordinate of the imaging subject.
@@ -34,12 +35,17 @@ class ImagingSubject{
          * @brief The y-coordinate of the imaging subject.
          */
         double y;
+
+        /**
+         * @brief The z-coordinate of the imaging subject, perpendicular to the meridional (x-y) plane.
+         */
+        double z;
     public:
         /**
          * @brief Retrieves the x-coordinate of the imaging subject.
          * @return The current x-coordinate.
          */
-        double getX();
+        double getX() const;
 
         /**
          * @brief Sets the x-coordinate of the imaging subject.
@@ -50,12 +56,23 @@ class ImagingSubject{
          * @brief Retrieves the y-coordinate of the imaging subject.
          * @return The current y-coordinate.
          */
-        double getY();
+        double getY() const;
 
         /**
          * @brief Sets the y-coordinate of the imaging subject.
          */
         void setY(double);
+
+        /**
+         * @brief Retrieves the z-coordinate of the imaging subject.
+         * @return The current z-coordinate.
+         */
+        double getZ() const;
+
+        /**
+         * @brief Sets the z-coordinate of the imaging subject.
+         */
+        void setZ(double);
 };
 
 #endif // IMAGINGSUBJECT_H
\ No newline at end of file
@@ -0,0 +1,168 @@
+/**
+* @file Instrumentation.h
+* @brief Defines the instrumentation layer: per-phase timers and event counters.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*
+* The library measures its hot paths through the `OPTISIM_TIME_SCOPE` and `OPTISIM_COUNT` macros.
+* Building with `OPTISIM_INSTRUMENTATION=0` (CMake option `OPTISIM_INSTRUMENTATION=OFF`) turns both macros
+* into no-ops, removing every measurement from the compiled code; the `Instrumentation` class stays available
+* and then reports zeros.
+*/
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>           // For the scoped timers
+#include <iostream>         // For the report
+
+using namespace std;
+
+#ifndef OPTISIM_INSTRUMENTATION
+/**
+ * @brief 1 to compile the timers and counters into the library, 0 to remove them.
+ */
+#define OPTISIM_INSTRUMENTATION 1
+#endif
+
+/**
+ * @brief The timed phases of a simulation run.
+ */
+enum stats_phase {
+    PHASE_PARSE,        ///< Reading and parsing a system file.
+    PHASE_ADD,          ///< Inserting an element into a system.
+    PHASE_CALCULATE,    ///< Evaluating a system.
+    PHASE_SAVE,         ///< Writing a system file.
+    PHASE_OUTPUT,       ///< Formatting and writing the results of the command-line tool.
+    PHASE_COUNT         ///< The number of phases.
+};
+
+/**
+ * @brief The counted events.
+ */
+enum stats_counter {
+    COUNTER_ELEMENT_EVALUATIONS,   ///< Images computed by single optical elements.
+    COUNTER_ALLOCATIONS,           ///< Optical elements and light sources allocated by systems.
+    COUNTER_EXCEPTIONS,            ///< `OptiSimError` exceptions created.
+    COUNTER_COUNT                  ///< The number of counters.
+};
+
+/**
+ * @class Instrumentation
+ * @brief Aggregates the timings and counters of the whole process.
+ *
+ * All values are kept in relaxed atomics, so the timers and counters can be updated from any thread
+ * (for instance by the workers of `ToleranceAnalysis`) without locks.
+ */
+class Instrumentation{
+    public:
+        /**
+         * @brief Records one timed call of a phase.
+         */
+        static void addTime(stats_phase, long long);
+
+        /**
+         * @brief Adds to a counter.
+         */
+        static void count(stats_counter, long long n = 1);
+
+        /**
+         * @brief Retrieves the number of timed calls of a phase.
+         * @return The number of calls.
+         */
+        static long long getCalls(stats_phase);
+
+        /**
+         * @brief Retrieves the total time spent in a phase.
+         * @return The total time in seconds.
+         */
+        static double getSeconds(stats_phase);
+
+        /**
+         * @brief Retrieves the longest single call of a phase.
+         * @return The longest call in seconds.
+         */
+        static double getMaxSeconds(stats_phase);
+
+        /**
+         * @brief Retrieves the value of a counter.
+         * @return The value of the counter.
+         */
+        static long long getCount(stats_counter);
+
+        /**
+         * @brief Retrieves the name of a phase.
+         * @return The name of the phase, e.g. "calculate".
+         */
+        static const char* getName(stats_phase);
+
+        /**
+         * @brief Retrieves the name of a counter.
+         * @return The name of the counter, e.g. "element_evaluations".
+         */
+        static const char* getName(stats_counter);
+
+        /**
+         * @brief Tells whether the library was compiled with instrumentation.
+         * @return True if the timers and counters are compiled in.
+         */
+        static bool isEnabled();
+
+        /**
+         * @brief Sets every timer and counter to zero.
+         */
+        static void reset();
+
+        /**
+         * @brief Writes a table of all timers and counters.
+         */
+        static void report(ostream& os = cout);
+};
+
+/**
+ * @class ScopedTimer
+ * @brief Times the scope it lives in and records it as one call of a phase.
+ */
+class ScopedTimer{
+    private:
+        /**
+         * @brief The phase being timed.
+         */
+        stats_phase phase;
+
+        /**
+         * @brief The time the scope was entered.
+         */
+        chrono::steady_clock::time_point start;
+
+    public:
+        /**
+         * @brief Starts timing a phase.
+         */
+        explicit ScopedTimer(stats_phase);
+
+        /**
+         * @brief Stops timing and records the call.
+         */
+        ~ScopedTimer();
+};
+
+#define OPTISIM_CONCAT_IMPL(a, b) a##b
+#define OPTISIM_CONCAT(a, b) OPTISIM_CONCAT_IMPL(a, b)
+
+#if OPTISIM_INSTRUMENTATION
+/**
+ * @brief Times the rest of the enclosing scope as one call of a phase.
+ */
+#define OPTISIM_TIME_SCOPE(phase) ScopedTimer OPTISIM_CONCAT(optisim_timer_, __LINE__)(phase)
+/**
+ * @brief Adds `n` to a counter.
+ */
+#define OPTISIM_COUNT(counter, n) Instrumentation::count(counter, n)
+#else
+#define OPTISIM_TIME_SCOPE(phase) ((void)0)
+#define OPTISIM_COUNT(counter, n) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_H
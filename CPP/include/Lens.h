@@ -33,12 +33,23 @@ class Lens: public OpticalObject{
          */
         double f;
 
+        /**
+         * @brief Calculates the image formed by an ideal thin element of focal length `f` at the position of the lens.
+         * @return An `Image` object representing the calculated image.
+         */
+        Image CalculateThin(const ImagingSubject&) const;
+
+        /**
+         * @brief Calculates the images formed by an ideal thin element of focal length `f` for many subjects at once.
+         */
+        void CalculateThinSpectrum(double*, double*, char*, size_t) const;
+
     public:
         /**
          * @brief Retrieves the focal length of the lens.
          * @return The current focal length ('f') of the lens.
          */
-        double getF();
+        double getF() const;
 };
 
 #endif // LENS_H
\ No newline at end of file
@@ -23,7 +23,7 @@ class LightSource:public ImagingSubject{
         /**
          * @brief Constructs a new LightSource object.
          */
-        LightSource(double, double);
+        LightSource(double, double, double = 0);
 };
 
 #endif // LIGHTSOURCE_H
\ No newline at end of file
@@ -0,0 +1,155 @@
+/**
+* @file MaterialCatalog.h
+* @brief Defines the MaterialCatalog class, a shared table of named glasses.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef MATERIALCATALOG_H
+#define MATERIALCATALOG_H
+
+#include "DispersionModel.h"    // The dispersion of every material
+
+#include <vector>               // For the interned materials
+#include <string>               // For material names and file names
+#include <memory>               // For std::shared_ptr
+#include <unordered_map>        // For name lookup and the index cache
+#include <set>                  // For the loaded files
+#include <shared_mutex>         // For concurrent readers of the cache
+#include <cstdint>              // For the wavelength keys
+
+using namespace std;
+
+/**
+ * @class MaterialCatalog
+ * @brief Stores named materials and caches their refractive indices per wavelength.
+ *
+ * Every material name is interned once and referred to by a compact integer ID, which lenses store
+ * instead of the name. Refractive indices are cached per (material, wavelength) pair, so the dispersion
+ * formula of a material is evaluated only once per wavelength no matter how many lenses use it.
+ * The catalog is shared by the whole process through `global()`, and can be used from several threads.
+ *
+ * Catalogs are loaded from JSON files of the form
+ * `{"materials": [{"name": "N-BK7", "model": "sellmeier", "B": [...], "C": [...]}, ...]}`
+ * (Cauchy materials use a `"coefficients"` list), or from CSV files with one material per line:
+ * `name,model,coefficients...`, where Sellmeier lines list all B coefficients followed by all C coefficients.
+ */
+class MaterialCatalog{
+    private:
+        /**
+         * @brief The material names, indexed by ID.
+         */
+        vector<string> names;
+
+        /**
+         * @brief The dispersion models, indexed by ID.
+         */
+        vector<shared_ptr<const DispersionModel>> models;
+
+        /**
+         * @brief The ID of every interned name.
+         */
+        unordered_map<string, int> ids;
+
+        /**
+         * @brief The cached refractive indices of every material, keyed by the bit pattern of the wavelength.
+         */
+        vector<unordered_map<uint64_t, double>> cache;
+
+        /**
+         * @brief The files that were already loaded.
+         */
+        set<string> loaded_files;
+
+        /**
+         * @brief The number of refractive indices computed by the dispersion models.
+         */
+        long long evaluations;
+
+        /**
+         * @brief Protects every member against concurrent modification.
+         */
+        mutable shared_mutex mutex;
+
+        /**
+         * @brief Loads the materials of a JSON catalog file.
+         */
+        void loadJson(const string&);
+
+        /**
+         * @brief Loads the materials of a CSV catalog file.
+         */
+        void loadCsv(const string&);
+
+    public:
+        /**
+         * @brief Constructs an empty MaterialCatalog.
+         */
+        MaterialCatalog();
+
+        /**
+         * @brief Retrieves the catalog shared by the whole process.
+         * @return The global catalog.
+         */
+        static MaterialCatalog& global();
+
+        /**
+         * @brief Loads the materials of a JSON or CSV catalog file.
+         */
+        void load(const string&);
+
+        /**
+         * @brief Adds a material, or finds an identical one with the same name.
+         * @return The ID of the material.
+         */
+        int add(const string&, shared_ptr<const DispersionModel>);
+
+        /**
+         * @brief Looks up the ID of a material.
+         * @return The ID of the material.
+         */
+        int getId(const string&) const;
+
+        /**
+         * @brief Retrieves the name of a material.
+         * @return The name of the material.
+         */
+        string getName(int) const;
+
+        /**
+         * @brief Retrieves the dispersion model of a material.
+         * @return The dispersion model of the material.
+         */
+        shared_ptr<const DispersionModel> getModel(int) const;
+
+        /**
+         * @brief Retrieves the number of materials.
+         * @return The number of materials.
+         */
+        int size() const;
+
+        /**
+         * @brief Retrieves the refractive index of a material at one wavelength.
+         * @return The refractive index, computed at most once per wavelength.
+         */
+        double getIndex(int, double);
+
+        /**
+         * @brief Retrieves the refractive indices of a material at many wavelengths.
+         */
+        void getIndices(int, const double*, double*, size_t);
+
+        /**
+         * @brief Retrieves the number of refractive indices computed so far.
+         * @return The number of dispersion formula evaluations (cache misses).
+         */
+        long long getEvaluations() const;
+
+        /**
+         * @brief Empties the refractive index cache.
+         */
+        void clearCache();
+};
+
+#endif // MATERIALCATALOG_H
@@ -0,0 +1,69 @@
+/**
+* @file Mirror.h
+* @brief Defines the Mirror class, representing a spherical or plane mirror.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef MIRROR_H
+#define MIRROR_H
+
+#include "Lens.h"           // Inherits from the base Lens class
+
+#include <limits>           // For the radius of a plane mirror
+
+using namespace std;
+
+/**
+ * @class Mirror
+ * @brief Represents a spherical or plane mirror in an optical system.
+ *
+ * Mirrors are modelled in the unfolded system: the space behind a mirror is the mirror image of the space
+ * in front of it, so the light keeps travelling along +x. A spherical mirror of radius `r` then acts like
+ * a thin lens of focal length `-r/2` (a concave mirror, whose center of curvature lies in front of it,
+ * has a negative radius and converges the light), and a plane mirror, such as a folding mirror, leaves
+ * every image where it is.
+ */
+class Mirror: public Lens{
+    private:
+        /**
+         * @brief The radius of curvature; infinite for a plane mirror.
+         */
+        double r;
+
+    public:
+        /**
+         * @brief Constructs a new Mirror object; without a radius, the mirror is plane.
+         */
+        Mirror(double, double = numeric_limits<double>::infinity());
+
+        /**
+         * @brief Calculates the image formed by this mirror.
+         * @return An `Image` object representing the calculated image.
+         */
+        Image Calculate(const ImagingSubject&) override;
+
+        /**
+         * @brief Calculates the images formed by this mirror for many wavelengths at once.
+         */
+        void CalculateSpectrum(const double*, double*, double*, char*, size_t) override;
+
+        /**
+         * @brief Traces a bundle of rays through this mirror.
+         */
+        void TraceRays(double*, double*, double*, double*, double*, char*, size_t) override;
+
+        /**
+         * @brief Retrieves the radius of curvature of the mirror.
+         * @return The radius, infinite for a plane mirror.
+         */
+        double getR() const;
+
+        /**
+         * @brief Sets the radius of curvature of the mirror.
+         */
+        void setR(double);
+};
+
+#endif // MIRROR_H
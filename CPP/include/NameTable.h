@@ -0,0 +1,81 @@
+/**
+* @file NameTable.h
+* @brief Defines the NameTable class, which interns the element names of an optical system.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef NAMETABLE_H
+#define NAMETABLE_H
+
+#include <deque>            // For names that never move
+#include <string>           // For the stored names
+#include <string_view>      // For lookups without temporary strings
+#include <unordered_map>    // For name lookup
+#include <vector>           // For the released IDs
+
+using namespace std;
+
+/**
+ * @class NameTable
+ * @brief Stores every name once and refers to it by a compact integer ID.
+ *
+ * The lookup table is keyed by views of the stored names, so a name is kept in memory only once, and
+ * lookups take a `string_view` without building a temporary string. The IDs of released names are
+ * handed out again, so the IDs stay dense and can index plain arrays.
+ */
+class NameTable{
+    private:
+        /**
+         * @brief The names, indexed by ID; a deque, so that the views in `ids` stay valid as it grows.
+         */
+        deque<string> names;
+
+        /**
+         * @brief The ID of every name in use.
+         */
+        unordered_map<string_view, int> ids;
+
+        /**
+         * @brief The released IDs, reused before new ones are created.
+         */
+        vector<int> free_ids;
+
+    public:
+        /**
+         * @brief Looks up a name, adding it if it is not in the table yet.
+         * @return The ID of the name.
+         */
+        int intern(string_view);
+
+        /**
+         * @brief Looks up a name.
+         * @return The ID of the name, or -1 if it is not in the table.
+         */
+        int find(string_view) const;
+
+        /**
+         * @brief Retrieves the name with an ID.
+         * @return The name.
+         */
+        const string& getName(int) const;
+
+        /**
+         * @brief Removes a name from the table and frees its ID for reuse.
+         */
+        void release(int);
+
+        /**
+         * @brief Retrieves the number of IDs handed out, released ones included.
+         * @return One more than the largest ID.
+         */
+        int size() const;
+
+        /**
+         * @brief Removes every name.
+         */
+        void clear();
+};
+
+#endif // NAMETABLE_H
@@ -18,9 +18,27 @@
  * - **Modular Design:** Components like `LightSource`, `Image`, `Lens`, `OpticalObject` are
  * designed as distinct classes for easy integration and extension.
  * - **Thin and Thick Lenses:** Supports different lens models for varied simulation needs.
+ * - **Mirrors and Plates:** Spherical and plane mirrors (in the unfolded system) and parallel plates take part in every calculation.
+ * - **Element Registry:** Element types are described once (parameters, factory, serializer and paraxial kernel) and new types can be registered at run time.
+ * - **Chromatic Evaluation:** Thick lenses can carry a dispersion model and systems can be evaluated for many wavelengths in one pass.
+ * - **Glass Catalogs:** Named materials are loaded from JSON or CSV catalogs and their refractive indices are cached per wavelength.
  * - **System Management:** The `OpticalSystem` class allows users to build, modify,
  * calculate, and save complex optical setups.
+ * - **Pooled Elements:** The elements of a system are allocated contiguously from a pool, optionally on top of a caller-supplied `std::pmr` resource (`ElementPool`).
  * - **Ray Tracing:** Capable of tracing representative rays through the system for visualization.
+ * - **Apertures and Vignetting:** Lenses can have a clear aperture and `ApertureStop` elements limit the rays; traced bundles record where each ray was blocked.
+ * - **Pupils and Field:** Entrance and exit pupils, chief and marginal rays, numerical aperture and field of view are computed paraxially and cached (`pupil_info`), and field sampling bundles are generated from them.
+ * - **Gaussian Beams:** Batches of paraxial Gaussian beams are propagated through the elements, giving the waist and Rayleigh range after each one (`beam_bundle`).
+ * - **Off-Axis Systems:** Elements can be decentered and tilted; bundles of skew rays are traced in 3D, with the on-axis formulas kept for centered systems (`ray_bundle`).
+ * - **Optimization:** The `Optimizer` class adjusts lens parameters to reach targets on the final image.
+ * - **Tolerancing:** The `ToleranceAnalysis` class estimates the spread of the final image under manufacturing tolerances.
+ * - **Synthetic Systems:** The `SystemGenerator` class builds reproducible systems of millions of lenses for scale testing.
+ * - **Instrumentation:** Per-phase timers and event counters that can be compiled out (`Instrumentation`).
+ * - **Tracing:** Per-thread timelines of simulation runs, written as Chrome trace-event JSON (`Trace`).
+ * - **Output Formats:** Results are written as text, JSON, CSV or a memory-mappable binary layout (`Report`), with fast number formatting (`OutputWriter`).
+ * - **Batch Processing:** Many system files are evaluated concurrently by a thread pool (`BatchRunner`).
+ * - **Watch Mode:** The command-line tool re-simulates a system whenever its file is saved, reusing the unchanged elements (`FileWatcher`).
+ * - **Simulation Server:** Systems stay resident and answer JSON commands over a Unix socket (`SimulationServer`).
  * - **Error Handling:** Robust error handling through custom exceptions (`OptiSimError`).
  *
  * @section getting_started_sec Getting Started
@@ -46,6 +64,26 @@
 #include "OpticalSystem.h"  ///< @brief Manages and simulates a collection of optical elements.
 #include "ThickLens.h"      ///< @brief Represents a thick lens with specified radii, thickness, and refractive index.
 #include "ThinLens.h"       ///< @brief Represents a thin lens with a single focal length.
+#include "ApertureStop.h"   ///< @brief Represents a diaphragm that limits the rays.
+#include "Mirror.h"         ///< @brief Represents a spherical or plane mirror.
+#include "ParallelPlate.h"  ///< @brief Represents a window with flat, parallel faces.
+#include "ElementRegistry.h" ///< @brief The element types, their parameters, serializers and kernels.
+#include "ElementPool.h"    ///< @brief Pooled memory for the elements of a system.
+#include "NameTable.h"      ///< @brief Interned element names with integer IDs.
+#include "DispersionModel.h" ///< @brief Wavelength-dependent refractive index (Cauchy, Sellmeier).
+#include "MaterialCatalog.h" ///< @brief Named materials with cached refractive indices.
+
+// Design tools
+#include "Optimizer.h"      ///< @brief Damped least squares optimization of system parameters.
+#include "ToleranceAnalysis.h" ///< @brief Monte Carlo analysis of manufacturing tolerances.
+#include "SystemGenerator.h" ///< @brief Reproducible synthetic systems for scale testing.
+#include "Instrumentation.h" ///< @brief Per-phase timers and event counters.
+#include "Trace.h"          ///< @brief Chrome trace-event timelines of simulation runs.
+#include "OutputWriter.h"   ///< @brief Buffered text output with fast number formatting.
+#include "Report.h"         ///< @brief Text reports of calculated systems.
+#include "BatchRunner.h"    ///< @brief Concurrent evaluation of many system files.
+#include "SimulationServer.h" ///< @brief Resident systems served over a Unix socket.
+#include "FileWatcher.h"    ///< @brief Notification of rewritten files.
 
 // Utility and versioning
 #include "OptiSimVersion.h" ///< @brief Contains version information for the OptiSim library.
@@ -12,6 +12,7 @@
 #include "Image.h"          // Required for the return type of Calculate
 #include "ImagingSubject.h" // Required for the parameter type of Calculate
 #include "LightSource.h"    // Potentially relevant for future derived classes, though not directly used here
+#include <cstddef>          // For size_t
 
 /**
  * @class OpticalObject
@@ -21,6 +22,11 @@
  * It provides a common position along the optical axis (x-coordinate) and
  * defines an abstract interface for calculating the image formed by the object.
  *
+ * An object can also be decentered, i.e. moved off the axis in y and z, and tilted about the y and z axes.
+ * Its own axis then passes through `(x, y, z)` in the direction `(cos a cos b, sin a cos b, sin b)`, where
+ * `a` is the tilt about z and `b` the tilt about y, and `Calculate` applies in the frame of that axis.
+ * A centered object (no decentering, no tilt) is handled by the faster on-axis formulas.
+ *
  * @note This is an abstract class, meaning it cannot be instantiated directly.
  * Derived classes must implement the pure virtual `Calculate` method.
  */
@@ -36,6 +42,41 @@ class OpticalObject{
          * @brief The x-coordinate representing the position of the optical object along the optical axis.
          */
         double x;
+
+        /**
+         * @brief The decentering of the object along the y axis.
+         */
+        double y;
+
+        /**
+         * @brief The decentering of the object along the z axis.
+         */
+        double z;
+
+        /**
+         * @brief The tilt of the object about the y axis, in degrees; positive values turn its axis towards +z.
+         */
+        double tilt_y;
+
+        /**
+         * @brief The tilt of the object about the z axis, in degrees; positive values turn its axis towards +y.
+         */
+        double tilt_z;
+
+        /**
+         * @brief The radius of the clear aperture, measured from the object's axis; infinite if the object does not limit the rays.
+         */
+        double aperture;
+
+        /**
+         * @brief Computes the axes of the object's frame in global coordinates.
+         */
+        void getAxes(double[3][3]) const;
+
+        /**
+         * @brief Traces rays through an ideal element given by its principal planes and focal length.
+         */
+        void TracePrincipalPlanes(double, double, double, double*, double*, double*, double*, double*, char*, size_t) const;
         
     public:
 
@@ -43,12 +84,74 @@ class OpticalObject{
          * @brief Retrieves the x-coordinate (position) of the optical object.
          * @return The current x-coordinate of the object.
          */
-        double getX();
+        double getX() const;
 
         /**
          * @brief Sets the x-coordinate (position) of the optical object.
+         * @details Virtual so that derived classes caching position-dependent quantities can invalidate them.
          */
-        void setX(double);
+        virtual void setX(double);
+
+        /**
+         * @brief Retrieves the decentering of the object along the y axis.
+         * @return The y-coordinate of the object's axis at its position.
+         */
+        double getY() const;
+
+        /**
+         * @brief Sets the decentering of the object along the y axis.
+         */
+        void setY(double);
+
+        /**
+         * @brief Retrieves the decentering of the object along the z axis.
+         * @return The z-coordinate of the object's axis at its position.
+         */
+        double getZ() const;
+
+        /**
+         * @brief Sets the decentering of the object along the z axis.
+         */
+        void setZ(double);
+
+        /**
+         * @brief Retrieves the tilt of the object about the y axis.
+         * @return The tilt in degrees.
+         */
+        double getTiltY() const;
+
+        /**
+         * @brief Sets the tilt of the object about the y axis.
+         */
+        void setTiltY(double);
+
+        /**
+         * @brief Retrieves the tilt of the object about the z axis.
+         * @return The tilt in degrees.
+         */
+        double getTiltZ() const;
+
+        /**
+         * @brief Sets the tilt of the object about the z axis.
+         */
+        void setTiltZ(double);
+
+        /**
+         * @brief Retrieves the radius of the clear aperture.
+         * @return The radius, or infinity if the object does not limit the rays.
+         */
+        double getAperture() const;
+
+        /**
+         * @brief Sets the radius of the clear aperture.
+         */
+        void setAperture(double);
+
+        /**
+         * @brief Tells whether the object sits on the optical axis.
+         * @return True if the object is neither decentered nor tilted.
+         */
+        bool isCentered() const;
 
         /**
          * @brief Pure virtual function to calculate the image formed by this optical object.
@@ -58,7 +161,35 @@ class OpticalObject{
          *
          * @return An `Image` object representing the calculated image.
          */
-        virtual Image Calculate(ImagingSubject) = 0;
+        virtual Image Calculate(const ImagingSubject&) = 0;
+
+        /**
+         * @brief Calculates the images formed by this optical object for many wavelengths at once.
+         *
+         * The arrays hold one lane per wavelength: on entry the position and height of the subject
+         * seen at that wavelength, on exit the position, height and real/virtual status of its image.
+         */
+        virtual void CalculateSpectrum(const double*, double*, double*, char*, size_t);
+
+        /**
+         * @brief Calculates the image of a point anywhere in space, taking decentering and tilt into account.
+         * @return An `Image` object with all three coordinates of the image point.
+         */
+        Image CalculateOffAxis(const ImagingSubject&);
+
+        /**
+         * @brief Traces a bundle of rays through this optical object.
+         *
+         * The arrays hold one lane per ray: on entry a point of the ray and its slopes dy/dx and dz/dx,
+         * on exit the point where the ray leaves the object and its new slopes. Rays that pass outside
+         * the clear aperture are flagged as vignetted.
+         */
+        virtual void TraceRays(double*, double*, double*, double*, double*, char*, size_t) = 0;
+
+        /**
+         * @brief Destroys the OpticalObject.
+         */
+        virtual ~OpticalObject();
 };
 
 #endif // OPTICALOBJECT_H
@@ -11,14 +11,23 @@
 
 #include "ThinLens.h"       // Include for ThinLens objects
 #include "ThickLens.h"      // Include for ThickLens objects
+#include "ApertureStop.h"   // Include for ApertureStop objects
+#include "Mirror.h"         // Include for Mirror objects
+#include "ParallelPlate.h"  // Include for ParallelPlate objects
 #include "Image.h"          // Include for Image objects
 #include "LightSource.h"    // Include for LightSource objects
+#include "OutputWriter.h"   // Include for buffered text output
+#include "ElementPool.h"    // Include for the memory of the elements
+#include "NameTable.h"      // Include for the interned element names
 
 #include <map>              // For storing named optical objects
 #include <vector>           // For sequences of images and element order
 #include <string>           // For names and file operations
 #include <fstream>          // For file I/O operations (e.g., save)
 #include <iostream>         // For console output (e.g., toString)
+#include <memory_resource>  // For caller-supplied memory resources
+#include <string_view>      // For the names in element views
+#include <iterator>         // For the iterator tags of element views
 
 using namespace std;
 
@@ -36,6 +45,232 @@ struct ray {
     vector<double> y;
 };
 
+/**
+ * @struct ray_bundle
+ * @brief A bundle of rays in three dimensions, stored as one array per coordinate.
+ *
+ * Ray `i` passes through the point `(x[i], y[i], z[i])` with the slopes `u[i]` (dy/dx) and `v[i]` (dz/dx).
+ * All five vectors have the same length. Keeping each coordinate contiguous lets every element trace
+ * the whole bundle in one vectorized loop. `vignetted` is filled in by the trace.
+ */
+struct ray_bundle {
+    /** @brief The x-coordinates of the rays. */
+    vector<double> x;
+    /** @brief The y-coordinates of the rays. */
+    vector<double> y;
+    /** @brief The z-coordinates of the rays. */
+    vector<double> z;
+    /** @brief The slopes dy/dx of the rays. */
+    vector<double> u;
+    /** @brief The slopes dz/dx of the rays. */
+    vector<double> v;
+    /** @brief The position in the optical order of the element that blocked each ray, or -1 if the ray passed every element. */
+    vector<int> vignetted;
+};
+
+/**
+ * @struct beam_bundle
+ * @brief A batch of paraxial Gaussian beams, stored as one array per quantity.
+ *
+ * Beam `j` enters the system with its waist at `waist_x[j]`, a waist radius (1/e² intensity) of `waist_w[j]` and
+ * the wavelength `wavelength[j]` in micrometres; the three input vectors have the same length. The outputs are filled
+ * in by `OpticalSystem::PropagateBeams`, one value per element and beam, element-major: the entry of beam `j` after
+ * the element at position `i` of the optical order is at index `i * beams + j`.
+ */
+struct beam_bundle {
+    /** @brief The positions of the input waists. */
+    vector<double> waist_x;
+    /** @brief The radii of the input waists. */
+    vector<double> waist_w;
+    /** @brief The wavelengths of the beams in micrometres. */
+    vector<double> wavelength;
+    /** @brief The positions of the waists of the beams leaving each element. */
+    vector<double> x;
+    /** @brief The radii of the waists of the beams leaving each element. */
+    vector<double> w;
+    /** @brief The Rayleigh ranges of the beams leaving each element. */
+    vector<double> rayleigh;
+    /** @brief The radii of the beams on the object-side principal plane of each element. */
+    vector<double> spot;
+};
+
+/**
+ * @struct pupil_info
+ * @brief The paraxial pupils and field of a centered system.
+ *
+ * The aperture stop is the element whose aperture limits the cone of rays from the axial object point the most;
+ * the entrance and exit pupils are its images through the elements before and after it. The marginal ray leaves
+ * the axial object point and grazes the edge of the stop, the chief ray leaves the edge of the field and passes
+ * through the center of the stop. Positions are x-coordinates; a pupil at infinity has infinite position and radius.
+ * Slopes are dy/dx, and angles are in degrees.
+ */
+struct pupil_info {
+    /** @brief The position in the optical order of the aperture stop. */
+    int aperture_stop;
+    /** @brief The position in the optical order of the field stop, or -1 if no other element has a finite aperture. */
+    int field_stop;
+    /** @brief The position of the entrance pupil. */
+    double entrance_x;
+    /** @brief The radius of the entrance pupil. */
+    double entrance_radius;
+    /** @brief The position of the exit pupil. */
+    double exit_x;
+    /** @brief The radius of the exit pupil. */
+    double exit_radius;
+    /** @brief The slope of the marginal ray at the object. */
+    double marginal_u;
+    /** @brief The slope of the chief ray at the object. */
+    double chief_u;
+    /** @brief The numerical aperture in object space (in air). */
+    double na_object;
+    /** @brief The numerical aperture in image space (in air). */
+    double na_image;
+    /** @brief The object height at the edge of the field: the size of the object, or less if the field stop cuts it. */
+    double field_height;
+    /** @brief The half field of view, the angle of the chief ray at the object. */
+    double field_angle;
+};
+
+/**
+ * @brief The kinds of optical objects a system can hold.
+ */
+enum element_type : int {
+    ELEMENT_THIN_LENS,  ///< A `ThinLens`.
+    ELEMENT_THICK_LENS, ///< A `ThickLens`.
+    ELEMENT_STOP,       ///< An `ApertureStop`.
+    ELEMENT_MIRROR,     ///< A `Mirror`.
+    ELEMENT_PLATE       ///< A `ParallelPlate`.
+};
+
+/**
+ * @struct element_info
+ * @brief A read-only description of one optical object, filled in without allocating memory.
+ *
+ * The name refers to the storage of the system and stays valid until the element is removed or renamed.
+ * Parameters that the type of the element does not have are NaN.
+ */
+struct element_info {
+    /** @brief The name of the element. */
+    string_view name;
+    /** @brief The type of the element. */
+    element_type type;
+    /** @brief The position of the element. */
+    double x;
+    /** @brief The focal length of the element; NaN for a stop or a plate. */
+    double f;
+    /** @brief The refractive index of a thick lens or a plate. */
+    double n;
+    /** @brief The thickness of a thick lens or a plate. */
+    double d;
+    /** @brief The radius of the left surface of a thick lens, or the radius of a mirror. */
+    double r_left;
+    /** @brief The radius of the right surface of a thick lens. */
+    double r_right;
+    /** @brief The decentering of the element along y. */
+    double y;
+    /** @brief The decentering of the element along z. */
+    double z;
+    /** @brief The tilt of the element about the y axis, in degrees. */
+    double tilt_y;
+    /** @brief The tilt of the element about the z axis, in degrees. */
+    double tilt_z;
+    /** @brief The radius of the clear aperture of the element; infinity if it is not limited. */
+    double aperture;
+};
+
+class OpticalSystem;
+
+/**
+ * @class ElementIterator
+ * @brief Walks the elements of an OpticalSystem in optical order, yielding an `element_info` for each.
+ */
+class ElementIterator{
+    private:
+        /**
+         * @brief The system being walked.
+         */
+        OpticalSystem* system;
+
+        /**
+         * @brief The position of the current element in the optical order.
+         */
+        size_t index;
+
+    public:
+        typedef input_iterator_tag iterator_category;
+        typedef element_info value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const element_info* pointer;
+        typedef element_info reference;
+
+        /**
+         * @brief Constructs an iterator at a position of a system.
+         */
+        ElementIterator(OpticalSystem*, size_t);
+
+        /**
+         * @brief Describes the current element.
+         * @return The description of the element.
+         */
+        element_info operator*() const;
+
+        /**
+         * @brief Moves to the next element.
+         * @return This iterator.
+         */
+        ElementIterator& operator++();
+
+        /**
+         * @brief Compares the positions of two iterators.
+         * @return True if the iterators are at the same position.
+         */
+        bool operator==(const ElementIterator&) const;
+
+        /**
+         * @brief Compares the positions of two iterators.
+         * @return True if the iterators are at different positions.
+         */
+        bool operator!=(const ElementIterator&) const;
+};
+
+/**
+ * @class ElementRange
+ * @brief A non-owning view of the elements of an OpticalSystem, usable in range-based for loops.
+ * @details The view does not copy anything; it reflects later changes of the system, and iterators
+ * into it are invalidated when elements are added or removed.
+ */
+class ElementRange{
+    private:
+        /**
+         * @brief The system being viewed.
+         */
+        OpticalSystem* system;
+
+    public:
+        /**
+         * @brief Constructs a view of a system.
+         */
+        ElementRange(OpticalSystem*);
+
+        /**
+         * @brief Retrieves an iterator at the first element.
+         * @return The iterator.
+         */
+        ElementIterator begin() const;
+
+        /**
+         * @brief Retrieves an iterator past the last element.
+         * @return The iterator.
+         */
+        ElementIterator end() const;
+
+        /**
+         * @brief Retrieves the number of elements.
+         * @return The number of elements.
+         */
+        size_t size() const;
+};
+
 /**
  * @class OpticalSystem
  * @brief Manages a collection of optical elements and simulates ray propagation.
@@ -53,23 +288,39 @@ class OpticalSystem{
          */
         LightSource *LS;
 
+        /**
+         * @brief The pool holding the LightSource and the optical objects of the system.
+         * @details Declared before the pointers into it are used and destroyed after the destructor has released them.
+         */
+        ElementPool pool;
+
         /**
          * @brief A sequence of Image objects, representing the image formed by each optical object in order.
          */
         vector<Image> imageSequence;
 
         /**
-         * @brief A map associating string names with pointers to OpticalObject instances.
-         * @details This map stores the optical objects (e.g., lenses) by a user-defined name.
-         * The `OpticalSystem` manages the memory of these objects.
+         * @brief The user-defined names of the optical objects, each stored once and referred to by an integer ID.
+         */
+        NameTable names;
+
+        /**
+         * @brief The optical objects (e.g., lenses), indexed by the ID of their name.
+         * @details Entries of released IDs are `nullptr`. The `OpticalSystem` manages the memory of these objects.
+         */
+    	vector<OpticalObject*> elements;
+
+        /**
+         * @brief The type ID of every optical object in the `ElementRegistry`, indexed like `elements`.
+         * @details The type is looked up once, when the object is added, so the type-specific work is dispatched by indexing the registry.
          */
-    	map<string, OpticalObject*> name_lens_map;
+    	vector<int> kinds;
 
         /**
-         * @brief A vector storing the names of optical objects in the order they appear in the system.
+         * @brief A vector storing the name IDs of optical objects in the order they appear in the system.
          * @details This vector dictates the sequence in which light interacts with the optical objects.
          */
-    	vector<string> order;
+    	vector<int> order;
 
         /**
          * @brief A map storing ray coordinate data, keyed by the name of the optical object.
@@ -78,46 +329,141 @@ class OpticalSystem{
          */
         map<string, ray> ray_coord;
 
+        /**
+         * @brief The absolute path of the glass catalog file named by the system file, written back by `save`.
+         * @details A relative path in the system file is resolved against the directory of the system file.
+         */
+        string glass_catalog;
+
+        /**
+         * @brief The rays still being traced by `TraceRays`, kept to reuse their storage.
+         */
+        ray_bundle trace_rays;
+
+        /**
+         * @brief The index in the caller's bundle of every ray in `trace_rays`.
+         */
+        vector<size_t> trace_index;
+
+        /**
+         * @brief The vignetting flags written by the element being traced.
+         */
+        vector<char> trace_blocked;
+
+        /**
+         * @brief The pupils computed by `getPupils`, valid while `pupils_valid` is set.
+         */
+        pupil_info pupils;
+
+        /**
+         * @brief Tells whether `pupils` describes the current state of the system; cleared by every modification.
+         */
+        bool pupils_valid;
+
+        /**
+         * @brief The height at the aperture stop of the paraxial ray leaving the object at unit height, parallel to the axis.
+         */
+        double stop_field;
+
+        /**
+         * @brief The height at the aperture stop of the paraxial ray leaving the axis at the object with unit slope.
+         */
+        double stop_axial;
+
         /**
          * @brief Calculates and stores the next ray coordinates after interaction with an optical object.
          */
-        void NextRayCoords(OpticalObject*, Image, string);
+        void NextRayCoords(OpticalObject*, const Image&, ray&);
+
+        /**
+         * @brief Tells whether the system needs the off-axis calculation.
+         * @return True if an element is decentered or tilted, or the light source is out of the meridional plane.
+         */
+        bool isOffAxis();
+
+        /**
+         * @brief Calculates the image sequence and the rays of a system with decentered or tilted elements.
+         * @return The final `Image`.
+         */
+        Image CalculateOffAxis(int);
+
+        /**
+         * @brief Computes the pupils and the field of the system into `pupils`.
+         */
+        void computePupils();
+
+        /**
+         * @brief Finds the position in the optical order for an object at a given x-coordinate.
+         * @return The index before which the object belongs.
+         */
+        size_t findSlot(double);
+
+        /**
+         * @brief Finds the position of an object in the optical order.
+         * @return The index of the object.
+         */
+        size_t indexOf(int);
+
+        /**
+         * @brief Reads the system from a JSON document.
+         */
+        void read(istream&, const string&, const string&);
     public:
         /**
-         * @brief Constructs a new, empty OpticalSystem.
+         * @brief Constructs a new, empty OpticalSystem whose elements are allocated from a memory resource.
          */
-		OpticalSystem();
+		explicit OpticalSystem(pmr::memory_resource* = pmr::get_default_resource());
 
         /**
          * @brief Constructs an OpticalSystem by loading its configuration from a json file.
          */
-    	OpticalSystem(string);
+    	OpticalSystem(const string&, pmr::memory_resource* = pmr::get_default_resource());
+
+        /**
+         * @brief Constructs an OpticalSystem by reading its configuration, in the json file format, from a stream.
+         */
+        OpticalSystem(istream&, pmr::memory_resource* = pmr::get_default_resource());
+
+        OpticalSystem(const OpticalSystem&) = delete;
+        OpticalSystem& operator=(const OpticalSystem&) = delete;
         
         /**
          * @brief Adds an OpticalObject to the system.
          */
-    	void add(OpticalObject&, string);
+    	void add(OpticalObject&, string_view);
 
         /**
          * @brief Adds a LightSource to the system.
          * @note If a LightSource already exists, it will be replaced.
          */
-    	void add(LightSource);
+    	void add(const LightSource&);
 		
         /**
          * @brief Removes an optical object from the system by its name.
          */
-		void remove(string);
+		void remove(string_view);
         
         /**
          * @brief Modifies a property of the existing LightSource.
          */
-    	void modifyLightSource(string, double);
+    	void modifyLightSource(string_view, double);
 
         /**
          * @brief Modifies a property of an existing OpticalObject by its name.
          */
-    	void modifyOpticalObject(string, string, double);
+    	void modifyOpticalObject(string_view, string_view, double);
+
+        /**
+         * @brief Reads a property of an existing OpticalObject by its name.
+         * @return The value of the property.
+         */
+    	double getParameter(string_view, string_view);
+
+        /**
+         * @brief Makes this system equal to another one, keeping the elements that did not change.
+         * @return The number of elements (light source included) that were added, removed or changed.
+         */
+        int update(OpticalSystem&);
         
         /**
          * @brief Prints a string representation of the optical system to an output stream.
@@ -125,16 +471,21 @@ class OpticalSystem{
          */
         void toString(ostream& os = cout);
 
+        /**
+         * @brief Appends a string representation of the optical system to an output writer.
+         */
+        void toString(OutputWriter&);
+
         /**
          * @brief Saves the current configuration of the optical system to a file.
          */
-    	void save(string);
+    	void save(const string&);
 
         /**
-         * @brief Retrieves the sequence of images formed by the optical objects.
-         * @return A vector of `Image` objects, ordered by their formation in the system.
+         * @brief Retrieves the sequence of images formed by the optical objects, without copying it.
+         * @return A vector of `Image` objects, ordered by their formation in the system, valid until the next calculation.
          */
-		vector<Image> getImageSequence();
+		const vector<Image>& getImageSequence();
 
         /**
          * @brief Calculates the final image formed by the entire optical system.
@@ -143,17 +494,70 @@ class OpticalSystem{
     	Image Calculate();
 
         /**
-         * @brief Retrieves the stored ray coordinates for visualization.
-         * @return A map where keys are object names and values are `ray` structs.
+         * @brief Calculates the final image formed by the entire optical system at many wavelengths.
+         * @return The final `Image` at each wavelength.
+         */
+        vector<Image> CalculateChromatic(const vector<double>&);
+
+        /**
+         * @brief Traces a bundle of rays through the elements of the system, in place.
          */
-        map<string, ray> getRays();
+        void TraceRays(ray_bundle&);
+
+        /**
+         * @brief Retrieves the paraxial pupils and field of the system, computed once per modification.
+         * @return The pupils, valid until the next modification of the system.
+         */
+        const pupil_info& getPupils();
+
+        /**
+         * @brief Samples the field and the aperture stop of the system with a bundle of rays leaving the object.
+         * @return The bundle, ready for `TraceRays`.
+         */
+        ray_bundle SampleField(int, int);
+
+        /**
+         * @brief Propagates a batch of paraxial Gaussian beams through the elements of the system, in place.
+         */
+        void PropagateBeams(beam_bundle&);
+
+        /**
+         * @brief Retrieves the stored ray coordinates for visualization, without copying them.
+         * @return A map where keys are ray names and values are `ray` structs, valid until the next calculation.
+         */
+        const map<string, ray>& getRays();
 
         /**
          * @brief Retrieves a map of all optical elements in the system.
-         * @return A map associating string names with pointers to OpticalObject instances.
+         * @return A map associating string names with pointers to copies of the OpticalObject instances, owned by the caller.
+         * @note Use `getElements` or `exportElements` to read the elements without copying them.
          */
         map<string, OpticalObject*> getSystemElements();
 
+        /**
+         * @brief Retrieves a view of the elements in optical order, without copying them.
+         * @return The view of the elements.
+         */
+        ElementRange getElements();
+
+        /**
+         * @brief Retrieves the number of optical elements in the system.
+         * @return The number of elements, the light source not included.
+         */
+        size_t getElementCount();
+
+        /**
+         * @brief Describes an element by its position in the optical order.
+         * @return The description of the element.
+         */
+        element_info getElement(size_t);
+
+        /**
+         * @brief Copies the types and parameters of all elements, in optical order, into caller-provided arrays.
+         * @return The number of elements written.
+         */
+        size_t exportElements(int*, double*, double*, double*, double*, double*, double*, size_t);
+
         /**
          * @brief Retrieves the LightSource currently set in the system.
          * @return The LightSource object.
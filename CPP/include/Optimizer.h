@@ -0,0 +1,214 @@
+/**
+* @file Optimizer.h
+* @brief Defines the Optimizer class, a damped least squares designer for optical systems.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "OpticalSystem.h"  // The system whose parameters are optimized
+
+#include <vector>           // For variables, targets and work buffers
+#include <string>           // For element and parameter names
+
+using namespace std;
+
+struct element_class;
+
+/**
+ * @struct optimization_result
+ * @brief Summarizes a finished optimization run.
+ */
+struct optimization_result {
+    /** @brief The number of Levenberg-Marquardt iterations performed. */
+    int iterations;
+    /** @brief The number of merit function evaluations (including rejected steps). */
+    int evaluations;
+    /** @brief True if the run stopped because a convergence criterion was met. */
+    bool converged;
+    /** @brief The merit value (half of the weighted sum of squared residuals) before the first step. */
+    double initial_merit;
+    /** @brief The merit value of the accepted solution. */
+    double final_merit;
+    /** @brief The wall-clock time spent in the iteration loop, in seconds. */
+    double elapsed_seconds;
+    /** @brief The throughput of the iteration loop. */
+    double iterations_per_second;
+};
+
+/**
+ * @class Optimizer
+ * @brief Adjusts selected lens parameters of an OpticalSystem to reach targets on the final image.
+ *
+ * The optimizer runs a Levenberg-Marquardt (damped least squares) iteration over a set of
+ * bounded free variables. Each variable is an element name and a parameter name, using the
+ * same parameter names as `OpticalSystem::modifyOpticalObject` (e.g. "x", "f", "n", "d", "r_left", "r_right").
+ * Targets are placed on the final image: its position ("x"), its size ("y") or the
+ * lateral magnification of the whole system ("magnification").
+ *
+ * The Jacobian is computed analytically by propagating the derivatives of the imaging equation
+ * through the principal planes of every element, given by the kernels of the `ElementRegistry`, along the element chain. The elements are copied once when `run()` starts and
+ * the copies, together with all work buffers, are reused by every iteration; the accepted
+ * solution is written back to the system through `modifyOpticalObject`.
+ */
+class Optimizer{
+    private:
+        /**
+         * @struct variable
+         * @brief A free parameter of the optimization.
+         */
+        struct variable {
+            /** @brief The name of the element that owns the parameter. */
+            string element;
+            /** @brief The name of the parameter ("x", or one in the schema of the element's type, e.g. "f", "n", "r_left"). */
+            string param;
+            /** @brief The lower bound of the parameter. */
+            double lower;
+            /** @brief The upper bound of the parameter. */
+            double upper;
+            /** @brief The index of the owning element in the working copy, resolved by `run()`. */
+            int index;
+            /** @brief The parameter resolved to a slot of the local derivative tables by `run()`. */
+            int slot;
+        };
+
+        /**
+         * @struct target
+         * @brief A merit function term on the final image.
+         */
+        struct target {
+            /** @brief The image quantity ("x", "y" or "magnification"). */
+            string quantity;
+            /** @brief The value the quantity should reach. */
+            double value;
+            /** @brief The weight of the residual in the merit function. */
+            double weight;
+        };
+
+        /**
+         * @brief The optimized system. The optimizer does not own it.
+         */
+        OpticalSystem* system;
+
+        /**
+         * @brief The free variables, in the order they were added.
+         */
+        vector<variable> variables;
+
+        /**
+         * @brief The merit function terms, in the order they were added.
+         */
+        vector<target> targets;
+
+        /**
+         * @brief The maximum number of iterations of a run.
+         */
+        int max_iterations;
+
+        /**
+         * @brief The relative tolerance used by the convergence criteria.
+         */
+        double tolerance;
+
+        /**
+         * @brief Working copies of the system elements in optical order.
+         */
+        vector<OpticalObject*> elements;
+
+        /**
+         * @brief The types of the working copies in the `ElementRegistry`.
+         */
+        vector<const element_class*> types;
+
+        /**
+         * @brief The position of the light source of the system.
+         */
+        double ls_x;
+
+        /**
+         * @brief The height of the light source of the system.
+         */
+        double ls_y;
+
+        /**
+         * @brief Derivatives of the current image position with respect to each variable.
+         */
+        vector<double> dx;
+
+        /**
+         * @brief Derivatives of the current image height with respect to each variable.
+         */
+        vector<double> dy;
+
+        /**
+         * @brief The weighted residuals of the last evaluation.
+         */
+        vector<double> residuals;
+
+        /**
+         * @brief The row-major Jacobian of the residuals of the last evaluation.
+         */
+        vector<double> jacobian;
+
+        /**
+         * @brief Applies the parameter values to the working copies.
+         */
+        bool apply(const vector<double>&);
+
+        /**
+         * @brief Evaluates the residuals and their Jacobian at the applied parameter values.
+         */
+        bool evaluate();
+
+        /**
+         * @brief Propagates the image and its derivatives through one element.
+         */
+        bool propagate(int, double&, double&);
+
+        /**
+         * @brief Releases the working copies of the elements.
+         */
+        void clear();
+
+    public:
+        /**
+         * @brief Constructs an Optimizer for the given system.
+         */
+        Optimizer(OpticalSystem&);
+
+        /**
+         * @brief Adds a bounded free variable.
+         */
+        void addVariable(string, string, double, double);
+
+        /**
+         * @brief Adds a target on the final image.
+         */
+        void addTarget(string, double, double weight = 1.0);
+
+        /**
+         * @brief Sets the maximum number of iterations.
+         */
+        void setMaxIterations(int);
+
+        /**
+         * @brief Sets the relative convergence tolerance.
+         */
+        void setTolerance(double);
+
+        /**
+         * @brief Runs the optimization and writes the solution back to the system.
+         * @return An `optimization_result` describing the run.
+         */
+        optimization_result run();
+
+        /**
+         * @brief Destroys the Optimizer object.
+         */
+        ~Optimizer();
+};
+
+#endif // OPTIMIZER_H
@@ -0,0 +1,175 @@
+/**
+* @file OutputWriter.h
+* @brief Defines the OutputWriter class, a buffered text writer with fast number formatting.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <iostream>         // For the destination stream
+#include <string>           // For text
+#include <vector>           // For the buffer
+#include <charconv>         // For std::chars_format
+#include <cstddef>          // For size_t
+
+using namespace std;
+
+/**
+ * @class OutputWriter
+ * @brief Formats text and numbers into a large buffer and writes it to a stream in big chunks.
+ *
+ * Numbers are formatted with `std::to_chars`, which does not consult the locale and does not allocate,
+ * instead of the formatting machinery of `ostream`. The text is identical to what the stream would produce
+ * in the classic locale: `operator<<` formats doubles with the precision and floating-point notation the
+ * stream had when the writer was created, and `writeFixed` and `writeText` replace `fixed`, `setprecision`,
+ * `setw`, `left` and `right`.
+ *
+ * The buffer is flushed to the stream when it is full and when the writer is destroyed. Each thread reuses
+ * one buffer for all its writers, so creating a writer does not allocate; a writer created while another
+ * one of the same thread is alive gets a buffer of its own.
+ */
+class OutputWriter{
+    private:
+        /**
+         * @brief The destination stream.
+         */
+        ostream& os;
+
+        /**
+         * @brief The buffer of this writer, either the shared buffer of the thread or its own.
+         */
+        vector<char>* buffer;
+
+        /**
+         * @brief The own buffer of a writer that could not use the shared buffer of the thread.
+         */
+        vector<char> own_buffer;
+
+        /**
+         * @brief The number of bytes waiting in the buffer.
+         */
+        size_t used;
+
+        /**
+         * @brief True if this writer uses the shared buffer of the thread.
+         */
+        bool shared;
+
+        /**
+         * @brief The precision used by `operator<<` for doubles.
+         */
+        int precision;
+
+        /**
+         * @brief The notation used by `operator<<` for doubles; `general` stands for the default (`%g`) notation.
+         */
+        chars_format format;
+
+        /**
+         * @brief The formatting flags of the stream, for the rare settings `to_chars` cannot reproduce.
+         */
+        ios_base::fmtflags flags;
+
+        /**
+         * @brief True if `operator<<` must format doubles with the stream (hexadecimal notation, `showpos`,
+         * `showpoint`, `uppercase` or a precision above 60).
+         */
+        bool stream_format;
+
+        /**
+         * @brief Makes room for a number of bytes, flushing the buffer if needed.
+         */
+        void reserve(size_t);
+
+        /**
+         * @brief Appends formatted characters padded to a width.
+         */
+        void append(const char*, size_t, int, bool);
+
+    public:
+        /**
+         * @brief Constructs an OutputWriter writing to a stream.
+         */
+        OutputWriter(ostream&, size_t capacity = 1 << 20);
+
+        /**
+         * @brief Flushes the buffer and destroys the OutputWriter.
+         */
+        ~OutputWriter();
+
+        OutputWriter(const OutputWriter&) = delete;
+        OutputWriter& operator=(const OutputWriter&) = delete;
+
+        /**
+         * @brief Appends text.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(const string&);
+
+        /**
+         * @brief Appends a C string.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(const char*);
+
+        /**
+         * @brief Appends a character.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(char);
+
+        /**
+         * @brief Appends a double in the notation and precision of the stream.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(double);
+
+        /**
+         * @brief Appends an integer.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(long long);
+
+        /**
+         * @brief Appends an integer.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(int);
+
+        /**
+         * @brief Appends an unsigned integer.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(size_t);
+
+        /**
+         * @brief Appends a boolean as 1 or 0.
+         * @return This writer.
+         */
+        OutputWriter& operator<<(bool);
+
+        /**
+         * @brief Appends a double in fixed notation, right-aligned to a width.
+         */
+        void writeFixed(double, int, int width = 0);
+
+        /**
+         * @brief Appends a double in the default (`%g`) notation with a given number of significant digits.
+         */
+        void writeGeneral(double, int, int width = 0);
+
+        /**
+         * @brief Appends text padded to a width.
+         */
+        void writeText(const string&, int, bool left = true);
+
+        /**
+         * @brief Writes the buffered bytes to the stream.
+         */
+        void flush();
+};
+
+#endif // OUTPUTWRITER_H
@@ -0,0 +1,84 @@
+/**
+* @file ParallelPlate.h
+* @brief Defines the ParallelPlate class, a window with flat, parallel faces.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef PARALLELPLATE_H
+#define PARALLELPLATE_H
+
+#include "OpticalObject.h"  // Inherits from the base OpticalObject class
+
+/**
+ * @class ParallelPlate
+ * @brief Represents a plate of glass with flat, parallel faces, such as a window or a filter.
+ *
+ * A plate has no optical power; paraxially it moves every image along the axis by `d (1 - 1/n)`,
+ * away from the light source. The position of the plate is the middle of its thickness.
+ */
+class ParallelPlate: public OpticalObject{
+    private:
+        /**
+         * @brief The refractive index of the plate.
+         */
+        double n;
+
+        /**
+         * @brief The thickness of the plate.
+         */
+        double d;
+
+    public:
+        /**
+         * @brief Constructs a new ParallelPlate object.
+         */
+        ParallelPlate(double, double, double);
+
+        /**
+         * @brief Calculates the image formed by this plate.
+         * @return An `Image` object representing the calculated image.
+         */
+        Image Calculate(const ImagingSubject&) override;
+
+        /**
+         * @brief Calculates the images formed by this plate for many wavelengths at once.
+         */
+        void CalculateSpectrum(const double*, double*, double*, char*, size_t) override;
+
+        /**
+         * @brief Traces a bundle of rays through this plate.
+         */
+        void TraceRays(double*, double*, double*, double*, double*, char*, size_t) override;
+
+        /**
+         * @brief Retrieves the refractive index of the plate.
+         * @return The refractive index.
+         */
+        double getN() const;
+
+        /**
+         * @brief Sets the refractive index of the plate.
+         */
+        void setN(double);
+
+        /**
+         * @brief Retrieves the thickness of the plate.
+         * @return The thickness.
+         */
+        double getD() const;
+
+        /**
+         * @brief Sets the thickness of the plate.
+         */
+        void setD(double);
+
+        /**
+         * @brief Retrieves the axial shift of the images formed by the plate.
+         * @return The shift `d (1 - 1/n)`.
+         */
+        double getShift() const;
+};
+
+#endif // PARALLELPLATE_H
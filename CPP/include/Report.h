@@ -0,0 +1,98 @@
+/**
+* @file Report.h
+* @brief Defines the Report class, which writes the calculation results of a system.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "OpticalSystem.h"  // The reported systems
+#include "OutputWriter.h"   // Fast formatting of the text output
+
+#include <iostream>         // For the output streams
+#include <string>           // For format names
+#include <nlohmann/json.hpp> // For the JSON form of images
+
+using namespace std;
+
+/**
+ * @brief The formats of the image list and the rays.
+ */
+enum report_format {
+    FORMAT_TEXT,        ///< The fixed-width text tables, after the system summary.
+    FORMAT_JSON,        ///< One JSON object, as written by `Report::writeJson`.
+    FORMAT_CSV,         ///< One CSV table of all images and ray points.
+    FORMAT_BINARY       ///< The little-endian binary layout described at `Report::writeBinary`.
+};
+
+/**
+ * @class Report
+ * @brief Writes the output of the `OptiSim` command-line tool: the system summary, the image list and the rays.
+ *
+ * The text output is shared by the single-system mode and the batch mode of the tool, so both produce the same text.
+ * It is formatted by an `OutputWriter`, so large image lists and ray tables are written in big chunks.
+ * The JSON output is the machine-readable counterpart used by the streaming mode.
+ */
+class Report{
+    public:
+        /**
+         * @brief Writes the image list of a calculated system as a text table.
+         */
+        static void writeImageList(OpticalSystem&, ostream&);
+
+        /**
+         * @brief Appends the image list of a calculated system as a text table to a writer.
+         */
+        static void writeImageList(OpticalSystem&, OutputWriter&);
+
+        /**
+         * @brief Writes the ray coordinates of a calculated system as a text table.
+         */
+        static void writeRays(OpticalSystem&, ostream&);
+
+        /**
+         * @brief Appends the ray coordinates of a calculated system as a text table to a writer.
+         */
+        static void writeRays(OpticalSystem&, OutputWriter&);
+
+        /**
+         * @brief Writes the results of a calculated system as CSV.
+         */
+        static void writeCsv(OpticalSystem&, ostream&, bool image_list = false, bool rays = false);
+
+        /**
+         * @brief Writes the results of a calculated system in the binary layout.
+         */
+        static void writeBinary(OpticalSystem&, ostream&, bool image_list = false, bool rays = false);
+
+        /**
+         * @brief Writes the summary of a calculated system, optionally followed by the image list and the rays.
+         */
+        static void write(OpticalSystem&, ostream&, bool image_list = false, bool rays = false, report_format format = FORMAT_TEXT);
+
+        /**
+         * @brief Looks up a format by its name.
+         * @return The format called "text", "json", "csv" or "bin".
+         */
+        static report_format parseFormat(const string&);
+
+        /**
+         * @brief Writes the final image of a calculated system, optionally with the image list and the rays, as one line of JSON.
+         */
+        static void writeJson(OpticalSystem&, ostream&, bool image_list = false, bool rays = false);
+
+        /**
+         * @brief Converts an image into the JSON object used by the JSON output and the simulation server.
+         */
+        static nlohmann::json imageJson(const Image&);
+
+        /**
+         * @brief Writes an error message as one line of JSON.
+         */
+        static void writeJsonError(const string&, ostream&);
+};
+
+#endif // REPORT_H
@@ -0,0 +1,91 @@
+/**
+* @file SimulationServer.h
+* @brief Defines the SimulationServer class, which keeps systems resident and serves commands over a Unix socket.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef SIMULATIONSERVER_H
+#define SIMULATIONSERVER_H
+
+#include "OpticalSystem.h"  // The resident systems
+
+#include <map>              // For the resident systems
+#include <memory>           // For std::unique_ptr
+#include <string>           // For commands and names
+#include <atomic>           // For stopping the event loop from other threads
+
+using namespace std;
+
+/**
+ * @class SimulationServer
+ * @brief Keeps optical systems in memory and answers newline-delimited JSON commands.
+ *
+ * Every request is one JSON object on one line, and is answered by one JSON object on one line. The command
+ * is named by `"cmd"`; the resident system it applies to is named by `"system"` (default: `"default"`), and
+ * is created on first use. An `"id"` in a request is copied into its response.
+ *
+ * - `load` (`file`): replaces the system with the contents of a system file.
+ * - `save` (`file`): writes the system to a system file.
+ * - `clear`: drops the system.
+ * - `add` (`type`: `object` or any type of the `ElementRegistry`, e.g. `thin`, `thick`, `stop`, `mirror` or `plate`, and the keys used by system files): adds an element.
+ * - `remove` (`name`): removes a lens.
+ * - `modify` (`name`, omitted for the object; `param`; `value`): changes one parameter of an element.
+ * - `calculate` (`images`: optional, true to list every image): answers the final `image` and the `images`.
+ * - `rays`: calculates the system and answers the coordinates of the two traced `rays`.
+ * - `list`: answers the names of the resident `systems`.
+ * - `shutdown`: stops the server after answering.
+ *
+ * Responses carry `"ok": true`, or `"ok": false` and the message of the error in `"error"`. Coordinates
+ * that are not finite, such as the height of an image at infinity, are answered as `null`.
+ *
+ * `serve` runs a single-threaded event loop over non-blocking sockets, so any number of clients can be
+ * connected at once and commands are applied one at a time, in the order they arrive.
+ */
+class SimulationServer{
+    private:
+        /**
+         * @brief The resident systems by name.
+         */
+        map<string, unique_ptr<OpticalSystem>> systems;
+
+        /**
+         * @brief True while the event loop should keep running.
+         */
+        atomic<bool> running;
+
+        /**
+         * @brief The write end of the pipe that wakes the event loop, or -1.
+         */
+        atomic<int> wake_fd;
+
+    public:
+        /**
+         * @brief Constructs a SimulationServer without systems.
+         */
+        SimulationServer();
+
+        /**
+         * @brief Loads a system file into a resident system.
+         */
+        void load(const string&, const string&);
+
+        /**
+         * @brief Executes one command.
+         * @return The response, a JSON object without the trailing newline.
+         */
+        string handleCommand(const string&);
+
+        /**
+         * @brief Listens on a Unix socket and answers commands until stopped.
+         */
+        void serve(const string&);
+
+        /**
+         * @brief Asks a running event loop to stop.
+         */
+        void stop();
+};
+
+#endif // SIMULATIONSERVER_H
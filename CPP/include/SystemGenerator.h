@@ -0,0 +1,108 @@
+/**
+* @file SystemGenerator.h
+* @brief Defines the SystemGenerator class, which builds large synthetic optical systems.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef SYSTEMGENERATOR_H
+#define SYSTEMGENERATOR_H
+
+#include "OpticalSystem.h"  // The generated systems
+
+#include <string>           // For file names
+#include <iostream>         // For streaming JSON output
+#include <cstdint>          // For the 64-bit seed
+
+using namespace std;
+
+/**
+ * @class SystemGenerator
+ * @brief Generates reproducible systems of many thin and thick lenses for scale testing.
+ *
+ * The object is placed at the origin with size 1, followed by lenses named `L0`, `L1`, ...
+ * Lens `i` is centred near `(i + 1) * spacing`, jittered by at most a quarter of the spacing, so neighbouring
+ * lenses are always at least half a spacing apart, well above the 0.001 mm minimum of `OpticalSystem::add`.
+ * Thin lenses are positive with focal lengths around a quarter of the spacing, which keeps every intermediate
+ * image finite however long the system is; thick lenses are biconvex, with refractive indices between
+ * 1.45 and 1.85 and thicknesses between 10% and 30% of the spacing, so neighbouring lenses never overlap.
+ *
+ * The parameters of every lens are drawn from a counter-based random stream keyed by the seed and the
+ * lens index, so a system is fully determined by the seed and its settings, the first N lenses of a longer
+ * system equal a system of N lenses, and the in-memory and JSON outputs describe exactly the same system.
+ */
+class SystemGenerator{
+    private:
+        /**
+         * @brief The seed of the random lens parameters.
+         */
+        uint64_t seed;
+
+        /**
+         * @brief The nominal distance between neighbouring lenses, in mm.
+         */
+        double spacing;
+
+        /**
+         * @brief The probability that a lens is thick.
+         */
+        double thick_fraction;
+
+        /**
+         * @brief The parameters of one generated lens.
+         */
+        struct lens_parameters {
+            bool thick;
+            double x;
+            double f;
+            double n;
+            double d;
+            double r_left;
+            double r_right;
+        };
+
+        /**
+         * @brief Draws the parameters of a lens.
+         * @return The parameters of the lens with the given index.
+         */
+        lens_parameters lens(long long);
+
+    public:
+        /**
+         * @brief Constructs a SystemGenerator with a spacing of 10 mm and equally many thin and thick lenses.
+         */
+        SystemGenerator(uint64_t seed = 1);
+
+        /**
+         * @brief Sets the seed of the random lens parameters.
+         */
+        void setSeed(uint64_t);
+
+        /**
+         * @brief Sets the nominal distance between neighbouring lenses.
+         */
+        void setSpacing(double);
+
+        /**
+         * @brief Sets the probability that a lens is thick.
+         */
+        void setThickFraction(double);
+
+        /**
+         * @brief Adds the object and the given number of lenses to a system.
+         */
+        void generate(OpticalSystem&, long long);
+
+        /**
+         * @brief Writes a system with the given number of lenses as JSON, without building it in memory.
+         */
+        void write(ostream&, long long);
+
+        /**
+         * @brief Writes a system with the given number of lenses to a JSON file.
+         */
+        void write(const string&, long long);
+};
+
+#endif // SYSTEMGENERATOR_H
@@ -10,6 +10,10 @@
 #define THICKLENS_H
 
 #include "Lens.h" // Inherits from the base Lens class
+#include "DispersionModel.h" // Wavelength dependence of the refractive index
+
+#include <memory>   // For std::shared_ptr
+#include <vector>   // For per-wavelength results
 
 /**
  * @class ThickLens
@@ -48,6 +52,33 @@ class ThickLens: public Lens{
          */
         double d;
 
+        /**
+         * @brief The dispersion model of the lens material, or `nullptr` for a non-dispersive lens.
+         * @details Models are immutable and may be shared by many lenses.
+         */
+        shared_ptr<const DispersionModel> dispersion;
+
+        /**
+         * @brief The ID of the lens material in the global `MaterialCatalog`, or -1 if the lens does not use a named material.
+         */
+        int material;
+
+        /**
+         * @brief The cached position of the left principal plane (H1).
+         */
+        double h_left;
+
+        /**
+         * @brief The cached position of the right principal plane (H2).
+         */
+        double h_right;
+
+        /**
+         * @brief True if `h_left` and `h_right` match the current parameters of the lens.
+         * @details Cleared by every setter; the planes are recomputed by the next `Calculate` call.
+         */
+        bool planes_valid;
+
         /**
          * @brief Computes the effective focal length of the thick lens.
          * @return The calculated effective focal length of the thick lens.
@@ -65,6 +96,16 @@ class ThickLens: public Lens{
          * @return The distance of the right principal plane from the right vertex.
          */
         double computeHRight();
+
+        /**
+         * @brief Computes the effective focal lengths for an array of refractive indices.
+         */
+        void computeFocalLengths(const double*, double*, size_t);
+
+        /**
+         * @brief Recomputes the cached principal planes.
+         */
+        void updatePlanes();
     
     public:
         /**
@@ -76,10 +117,10 @@ class ThickLens: public Lens{
          * @brief Retrieves the refractive index of the lens.
          * @return The refractive index (n) of the lens material.
          */
-        double getN();
+        double getN() const;
 
         /**
-         * @brief Sets the refractive index of the lens.
+         * @brief Sets the refractive index of the lens, making it non-dispersive.
          */
         void setN(double);
 
@@ -87,7 +128,7 @@ class ThickLens: public Lens{
          * @brief Retrieves the radius of curvature of the left lens surface.
          * @return The radius of curvature (r_left) of the left surface.
          */
-        double getR_Left();
+        double getR_Left() const;
 
         /**
          * @brief Sets the radius of curvature of the left lens surface.
@@ -98,7 +139,7 @@ class ThickLens: public Lens{
          * @brief Retrieves the radius of curvature of the right lens surface.
          * @return The radius of curvature (r_right) of the right surface.
          */
-        double getR_Right();
+        double getR_Right() const;
 
         /**
          * @brief Sets the radius of curvature of the right lens surface.
@@ -109,18 +150,61 @@ class ThickLens: public Lens{
          * @brief Retrieves the axial thickness of the lens.
          * @return The axial thickness (d) of the lens.
          */
-        double getD();
+        double getD() const;
 
         /**
          * @brief Sets the axial thickness of the lens.
          */
         void setD(double);
 
+        /**
+         * @brief Sets the position of the lens center and invalidates the cached principal planes.
+         */
+        void setX(double) override;
+
+        /**
+         * @brief Sets the dispersion model of the lens material.
+         */
+        void setDispersion(shared_ptr<const DispersionModel>);
+
+        /**
+         * @brief Retrieves the dispersion model of the lens material.
+         * @return The dispersion model, or `nullptr` if the lens is not dispersive.
+         */
+        shared_ptr<const DispersionModel> getDispersion() const;
+
+        /**
+         * @brief Sets the lens material to a material of the global `MaterialCatalog`.
+         */
+        void setMaterial(int);
+
+        /**
+         * @brief Retrieves the lens material.
+         * @return The ID of the material in the global `MaterialCatalog`, or -1 if the lens does not use a named material.
+         */
+        int getMaterial() const;
+
+        /**
+         * @brief Computes the effective focal length at each of the given wavelengths.
+         * @return One focal length per wavelength.
+         */
+        vector<double> getFocalLengths(const vector<double>&);
+
         /**
          * @brief Calculates the image formed by this thick lens.
          * @return An `Image` object representing the calculated image.
          */
-        Image Calculate(ImagingSubject) override;
+        Image Calculate(const ImagingSubject&) override;
+
+        /**
+         * @brief Calculates the images formed by this thick lens for many wavelengths at once.
+         */
+        void CalculateSpectrum(const double*, double*, double*, char*, size_t) override;
+
+        /**
+         * @brief Traces a bundle of rays through this thick lens.
+         */
+        void TraceRays(double*, double*, double*, double*, double*, char*, size_t) override;
 };
 
 #endif // THICKLENS_H
\ No newline at end of file
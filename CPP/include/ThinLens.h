@@ -32,7 +32,17 @@ class ThinLens: public Lens{
          * @brief Calculates the image formed by this thin lens.
          * @return An `Image` object representing the calculated image.
          */
-        Image Calculate(ImagingSubject) override;
+        Image Calculate(const ImagingSubject&) override;
+
+        /**
+         * @brief Calculates the images formed by this thin lens for many wavelengths at once.
+         */
+        void CalculateSpectrum(const double*, double*, double*, char*, size_t) override;
+
+        /**
+         * @brief Traces a bundle of rays through this thin lens.
+         */
+        void TraceRays(double*, double*, double*, double*, double*, char*, size_t) override;
 
         /**
          * @brief Sets the focal length of the thin lens.
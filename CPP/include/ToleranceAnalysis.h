@@ -0,0 +1,158 @@
+/**
+* @file ToleranceAnalysis.h
+* @brief Defines the ToleranceAnalysis class, a Monte Carlo engine for manufacturing tolerances.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#ifndef TOLERANCEANALYSIS_H
+#define TOLERANCEANALYSIS_H
+
+#include "OpticalSystem.h"  // The nominal system that is perturbed
+
+#include <vector>           // For tolerances and histograms
+#include <string>           // For element, parameter and distribution names
+#include <cstdint>          // For the 64-bit seed
+
+using namespace std;
+
+/**
+ * @struct tolerance_statistics
+ * @brief Streamed statistics of one image quantity over all successful trials.
+ */
+struct tolerance_statistics {
+    /** @brief The number of samples. */
+    long long count;
+    /** @brief The mean of the samples. */
+    double mean;
+    /** @brief The standard deviation of the samples. */
+    double stddev;
+    /** @brief The smallest sample. */
+    double min;
+    /** @brief The largest sample. */
+    double max;
+    /** @brief The lower edge of the histogram. */
+    double lower;
+    /** @brief The upper edge of the histogram. */
+    double upper;
+    /** @brief The number of samples in each equally wide histogram bin between `lower` and `upper`. */
+    vector<long long> histogram;
+    /** @brief The number of samples below `lower`. */
+    long long underflow;
+    /** @brief The number of samples above `upper`. */
+    long long overflow;
+
+    /**
+     * @brief Estimates a percentile from the histogram.
+     * @return The estimated value below which `p` percent of the samples lie.
+     */
+    double percentile(double p) const;
+};
+
+/**
+ * @struct tolerance_result
+ * @brief Summarizes a tolerance analysis run.
+ */
+struct tolerance_result {
+    /** @brief The number of trials requested. */
+    long long trials;
+    /** @brief The number of trials that produced an invalid system or an image at infinity. */
+    long long failed;
+    /** @brief The statistics of the final image position. */
+    tolerance_statistics position;
+    /** @brief The statistics of the final image size. */
+    tolerance_statistics size;
+    /** @brief The wall-clock time of the run, in seconds. */
+    double elapsed_seconds;
+    /** @brief The throughput of the run. */
+    double trials_per_second;
+};
+
+/**
+ * @class ToleranceAnalysis
+ * @brief Estimates how manufacturing tolerances affect the final image of an OpticalSystem.
+ *
+ * Every trial perturbs the toleranced parameters of a copy of the system's elements, using a
+ * normal or uniform distribution centered on the nominal value, and images the light source
+ * through it. Trials are evaluated in fixed-size blocks spread over a pool of threads. Each block
+ * draws from its own random stream, derived from the seed and the block index, and the block
+ * summaries are merged in block order, so the result for a fixed seed does not depend on the
+ * number of threads. Only the statistics are kept, never the individual samples.
+ */
+class ToleranceAnalysis{
+    private:
+        /**
+         * @struct tolerance
+         * @brief A perturbed parameter.
+         */
+        struct tolerance {
+            /** @brief The name of the element that owns the parameter. */
+            string element;
+            /** @brief The name of the parameter ("x", or one in the schema of the element's type, e.g. "f", "n", "r_left"). */
+            string param;
+            /** @brief True for a normal distribution, false for a uniform one. */
+            bool normal;
+            /** @brief The standard deviation (normal) or half-width (uniform) of the perturbation. */
+            double width;
+        };
+
+        /**
+         * @brief The nominal system. The analysis does not own it.
+         */
+        OpticalSystem* system;
+
+        /**
+         * @brief The perturbed parameters, in the order they were added.
+         */
+        vector<tolerance> tolerances;
+
+        /**
+         * @brief The seed of the random streams.
+         */
+        uint64_t seed;
+
+        /**
+         * @brief The number of worker threads.
+         */
+        int threads;
+
+        /**
+         * @brief The number of histogram bins of each statistic.
+         */
+        int bins;
+
+    public:
+        /**
+         * @brief Constructs a ToleranceAnalysis for the given nominal system.
+         */
+        ToleranceAnalysis(OpticalSystem&);
+
+        /**
+         * @brief Adds a toleranced parameter.
+         */
+        void addTolerance(string, string, string, double);
+
+        /**
+         * @brief Sets the seed of the random streams.
+         */
+        void setSeed(uint64_t);
+
+        /**
+         * @brief Sets the number of worker threads.
+         */
+        void setThreads(int);
+
+        /**
+         * @brief Sets the number of histogram bins.
+         */
+        void setBins(int);
+
+        /**
+         * @brief Runs the given number of trials.
+         * @return A `tolerance_result` with the statistics of the final image.
+         */
+        tolerance_result run(long long);
+};
+
+#endif // TOLERANCEANALYSIS_H
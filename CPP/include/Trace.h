@@ -0,0 +1,121 @@
+/**
+* @file Trace.h
+* @brief Defines the Trace class, a timeline recorder that writes Chrome trace-event JSON.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*
+* Traces can be opened in `chrome://tracing` or in the Perfetto UI (https://ui.perfetto.dev).
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Instrumentation.h" // For OPTISIM_INSTRUMENTATION and the timed phases
+
+#include <chrono>           // For the event timestamps
+#include <string>           // For file names
+#include <cstddef>          // For size_t
+
+using namespace std;
+
+/**
+ * @class Trace
+ * @brief Records timed spans of every thread and writes them as a Chrome trace.
+ *
+ * Each thread records into its own fixed-size ring buffer, which only that thread writes, so recording takes
+ * no locks; once a buffer is full the oldest spans are overwritten. A span is stored as one complete ("X")
+ * event holding both its begin and end time. Tracing is off by default and can be switched at runtime; while
+ * it is off a span costs a single relaxed atomic load.
+ *
+ * Besides explicit `OPTISIM_TRACE_SCOPE` spans, every phase timed by the instrumentation layer (parsing,
+ * insertion, evaluation, saving, output) appears in the trace under the name of its phase.
+ */
+class Trace{
+    public:
+        /**
+         * @brief Switches recording on or off.
+         */
+        static void enable(bool);
+
+        /**
+         * @brief Tells whether spans are being recorded.
+         * @return True if tracing is on.
+         */
+        static bool isEnabled();
+
+        /**
+         * @brief Sets the number of spans each thread buffer holds.
+         */
+        static void setCapacity(size_t);
+
+        /**
+         * @brief Records a finished span of the calling thread.
+         */
+        static void record(const char*, chrono::steady_clock::time_point, chrono::steady_clock::time_point);
+
+        /**
+         * @brief Retrieves the number of spans currently held by all buffers.
+         * @return The number of spans that `write` would output.
+         */
+        static long long getEventCount();
+
+        /**
+         * @brief Discards all recorded spans.
+         */
+        static void clear();
+
+        /**
+         * @brief Writes the recorded spans as Chrome trace-event JSON.
+         */
+        static void write(const string&);
+
+        /**
+         * @brief Switches recording on and writes the trace to the given file when the process exits.
+         */
+        static void writeAtExit(const string&);
+};
+
+/**
+ * @class ScopedTrace
+ * @brief Records the scope it lives in as one span, if tracing was on when the scope was entered.
+ */
+class ScopedTrace{
+    private:
+        /**
+         * @brief The name of the span; must outlive the trace, e.g. a string literal.
+         */
+        const char* name;
+
+        /**
+         * @brief True if tracing was on when the scope was entered.
+         */
+        bool active;
+
+        /**
+         * @brief The time the scope was entered.
+         */
+        chrono::steady_clock::time_point start;
+
+    public:
+        /**
+         * @brief Starts a span.
+         */
+        explicit ScopedTrace(const char*);
+
+        /**
+         * @brief Ends the span and records it.
+         */
+        ~ScopedTrace();
+};
+
+#if OPTISIM_INSTRUMENTATION
+/**
+ * @brief Records the rest of the enclosing scope as a span with the given (literal) name.
+ */
+#define OPTISIM_TRACE_SCOPE(name) ScopedTrace OPTISIM_CONCAT(optisim_trace_, __LINE__)(name)
+#else
+#define OPTISIM_TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,44 @@
+/**
+* @file ApertureStop.cpp
+* @brief Implementation of the ApertureStop class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "ApertureStop.h"
+#include <limits>           // For std::numeric_limits
+
+using namespace std;
+
+/**
+ * @param x The position of the stop on the optical axis.
+ * @param aperture The radius of the opening.
+ * @throws OptiSimError If the radius is not positive.
+ */
+ApertureStop::ApertureStop(double x, double aperture):OpticalObject(x){
+    setAperture(aperture);
+}
+
+/**
+ * @details A stop does not deflect the light, so the image coincides with the subject. As for a lens without power,
+ * it counts as real if it lies behind the stop.
+ * @param is The subject.
+ */
+Image ApertureStop::Calculate(const ImagingSubject& is){
+    return Image(is.getX(), is.getY(), is.getX() > x);
+}
+
+/**
+ * @details The rays are carried to the plane of the stop without changing their slopes.
+ * @param x The x-coordinates of the rays.
+ * @param y The y-coordinates of the rays.
+ * @param z The z-coordinates of the rays.
+ * @param u The slopes dy/dx of the rays.
+ * @param v The slopes dz/dx of the rays.
+ * @param vignetted Set to 1 for every ray outside the opening, 0 for the others.
+ * @param count The number of rays.
+ */
+void ApertureStop::TraceRays(double* x, double* y, double* z, double* u, double* v, char* vignetted, size_t count){
+    TracePrincipalPlanes(0, 0, numeric_limits<double>::infinity(), x, y, z, u, v, vignetted, count);
+}
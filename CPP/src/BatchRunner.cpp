@@ -0,0 +1,272 @@
+/**
+* @file BatchRunner.cpp
+* @brief Implements the BatchRunner class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "BatchRunner.h"
+#include <fstream>           // For the manifest and the report files
+#include <sstream>           // For buffering aggregated reports
+#include <filesystem>        // For directories and globs
+#include <algorithm>         // For std::sort
+#include <thread>            // For the worker threads
+#include <mutex>             // For ordering the aggregated output
+#include <atomic>            // For handing out inputs to the workers
+#include <chrono>            // For timing the run
+#include <set>               // For unique report names
+#include "OpticalSystem.h"   // The processed systems
+#include "Report.h"          // The report of each system
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+
+/**
+ * @brief Matches a file name against a pattern with the wildcards `*` (any run of characters) and `?` (one character).
+ */
+static bool wildcard_match(const string& pattern, const string& name){
+    size_t p = 0, n = 0, star = string::npos, resume = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = n;
+        } else if (star != string::npos) {
+            p = star + 1;
+            n = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') p++;
+    return p == pattern.size();
+}
+
+/**
+ * @details Creates a runner without inputs that uses one thread per hardware thread and writes plain reports.
+ */
+BatchRunner::BatchRunner(){
+    threads = max(1u, thread::hardware_concurrency());
+    image_list = false;
+    rays = false;
+    format = FORMAT_TEXT;
+}
+
+/**
+ * @param file_name The path of the system file.
+ */
+void BatchRunner::addInput(const string& file_name){
+    inputs.push_back(file_name);
+}
+
+/**
+ * @details The files are added in lexicographic order; subdirectories are not searched.
+ * @param directory The path of the directory.
+ * @throws OptiSimError If the directory does not exist.
+ */
+void BatchRunner::addDirectory(const string& directory){
+    addGlob((filesystem::path(directory) / "*.json").string());
+}
+
+/**
+ * @details The wildcards `*` and `?` may only appear in the file name part of the pattern, e.g. `systems/run_*.json`.
+ * Matching files are added in lexicographic order.
+ * @param pattern The glob pattern.
+ * @throws OptiSimError If the directory part of the pattern does not exist.
+ */
+void BatchRunner::addGlob(const string& pattern){
+    filesystem::path path(pattern);
+    filesystem::path directory = path.parent_path().empty() ? filesystem::path(".") : path.parent_path();
+    string name_pattern = path.filename().string();
+    if (!filesystem::is_directory(directory)) throw OptiSimError("ERROR: \tNo such directory: " + directory.string());
+
+    vector<string> matches;
+    for (const auto& entry : filesystem::directory_iterator(directory)) {
+        if (entry.is_regular_file() && wildcard_match(name_pattern, entry.path().filename().string())) {
+            matches.push_back(entry.path().string());
+        }
+    }
+    sort(matches.begin(), matches.end());
+    inputs.insert(inputs.end(), matches.begin(), matches.end());
+}
+
+/**
+ * @details The manifest lists one system file per line; relative paths are relative to the directory of the
+ * manifest. Empty lines and lines starting with `#` are ignored.
+ * @param file_name The path of the manifest file.
+ * @throws OptiSimError If the manifest cannot be opened.
+ */
+void BatchRunner::addManifest(const string& file_name){
+    ifstream file(file_name);
+    if (!file.is_open()) throw OptiSimError("ERROR: \t Failed to open file: " + file_name);
+    filesystem::path base = filesystem::path(file_name).parent_path();
+
+    string line;
+    while (getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        size_t last = line.find_last_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#') continue;
+        filesystem::path input(line.substr(first, last - first + 1));
+        inputs.push_back(input.is_relative() ? (base / input).string() : input.string());
+    }
+}
+
+/**
+ * @details This method returns a copy of the collected inputs.
+ */
+vector<string> BatchRunner::getInputs(){
+    return inputs;
+}
+
+/**
+ * @param threads The number of worker threads.
+ * @throws OptiSimError If `threads` is not positive.
+ */
+void BatchRunner::setThreads(int threads){
+    if (threads <= 0) throw OptiSimError("ERROR: \tThe number of threads must be a positive number.");
+    this->threads = threads;
+}
+
+/**
+ * @details Each report is named after its input, with the extension of the format (`.txt`, `.json`, `.csv` or `.bin`); inputs with the same name get
+ * the input index appended. The directory is created if needed. Replaces an aggregated output.
+ * @param directory The path of the output directory.
+ */
+void BatchRunner::setOutputDirectory(const string& directory){
+    output_directory = directory;
+    aggregate_file = "";
+}
+
+/**
+ * @details Every report is preceded by a line naming its input. Replaces an output directory.
+ * @param file_name The path of the aggregated output file.
+ */
+void BatchRunner::setAggregateOutput(const string& file_name){
+    aggregate_file = file_name;
+    output_directory = "";
+}
+
+/**
+ * @param image_list True to append the image list.
+ */
+void BatchRunner::setImageList(bool image_list){
+    this->image_list = image_list;
+}
+
+/**
+ * @param rays True to append the ray coordinates.
+ */
+void BatchRunner::setRays(bool rays){
+    this->rays = rays;
+}
+
+/**
+ * @details The aggregated output is text only; the other formats need an output directory.
+ * @param format The format of the reports.
+ */
+void BatchRunner::setFormat(report_format format){
+    this->format = format;
+}
+
+/**
+ * @details Each worker thread repeatedly takes the next input, loads it, calculates it and writes its report.
+ * In aggregated mode a finished report is buffered until all earlier inputs have been written, so the
+ * output is in input order and only the reports completed out of order are held in memory.
+ * @throws OptiSimError If no output was chosen, if the aggregated output is combined with a format other than text,
+ * or if the output directory or file cannot be created.
+ */
+batch_result BatchRunner::run(){
+    if (output_directory.empty() && aggregate_file.empty()) throw OptiSimError("ERROR: \tChoose an output directory or an aggregated output file.");
+    if (!aggregate_file.empty() && format != FORMAT_TEXT)
+        throw OptiSimError("ERROR: \tThe aggregated output is text only; choose an output directory for other formats.");
+
+    // name the reports before starting, so equal input names are resolved deterministically
+    vector<string> report_files;
+    const char* extension = format == FORMAT_JSON ? ".json" : format == FORMAT_CSV ? ".csv" : format == FORMAT_BINARY ? ".bin" : ".txt";
+    if (!output_directory.empty()) {
+        filesystem::create_directories(output_directory);
+        set<string> used;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            string stem = filesystem::path(inputs[i]).stem().string();
+            if (!used.insert(stem).second) stem += "_" + to_string(i);
+            used.insert(stem);
+            report_files.push_back((filesystem::path(output_directory) / (stem + extension)).string());
+        }
+    }
+    ofstream aggregate;
+    if (!aggregate_file.empty()) {
+        aggregate.open(aggregate_file);
+        if (!aggregate.is_open()) throw OptiSimError("ERROR: \tFailed to open file for writing: " + aggregate_file);
+    }
+
+    size_t count = inputs.size();
+    vector<string> errors(count);
+    vector<string> pending(count);
+    vector<char> finished(count, 0);
+    size_t next_to_write = 0;
+    mutex output_mutex;
+    atomic<size_t> next_input(0);
+    atomic<long long> elements(0);
+
+    auto worker = [&](){
+        size_t i;
+        while ((i = next_input.fetch_add(1)) < count) {
+            string report;
+            try {
+                OpticalSystem system(inputs[i]);
+                system.Calculate();
+                elements += system.getImageSequence().size();
+                if (!report_files.empty()) {
+                    ofstream file(report_files[i], format == FORMAT_BINARY ? ios::out | ios::binary : ios::out);
+                    if (!file.is_open()) throw OptiSimError("ERROR: \tFailed to open file for writing: " + report_files[i]);
+                    Report::write(system, file, image_list, rays, format);
+                } else {
+                    stringstream ss;
+                    ss << "#    INPUT: " << inputs[i] << "\n";
+                    Report::write(system, ss, image_list, rays);
+                    report = ss.str();
+                }
+            } catch (exception& e) {
+                errors[i] = e.what();
+                report = "#    INPUT: " + inputs[i] + "\n" + errors[i] + "\n";
+            }
+
+            if (aggregate.is_open()) {
+                lock_guard<mutex> lock(output_mutex);
+                pending[i] = move(report);
+                finished[i] = 1;
+                while (next_to_write < count && finished[next_to_write]) {
+                    aggregate << pending[next_to_write];
+                    string().swap(pending[next_to_write]);
+                    next_to_write++;
+                }
+            }
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    int worker_count = (int)min<size_t>(threads, max<size_t>(count, 1));
+    vector<thread> pool;
+    for (int t = 1; t < worker_count; t++) pool.emplace_back(worker);
+    worker();
+    for (thread& t : pool) t.join();
+    if (aggregate.is_open()) aggregate.close();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    batch_result result;
+    result.inputs = count;
+    result.failed = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (errors[i].empty()) continue;
+        result.failed++;
+        result.errors.push_back(inputs[i] + ": " + errors[i]);
+    }
+    result.elements = elements;
+    result.elapsed_seconds = elapsed;
+    result.systems_per_second = elapsed > 0 ? count / elapsed : 0;
+    result.elements_per_second = elapsed > 0 ? result.elements / elapsed : 0;
+    return result;
+}
@@ -0,0 +1,98 @@
+/**
+* @file DispersionModel.cpp
+* @brief Implements the DispersionModel class with the Cauchy and Sellmeier formulas.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "DispersionModel.h"
+#include <cmath>             // For std::sqrt
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+
+/**
+ * @param model The model name, "cauchy" or "sellmeier".
+ * @param b The Cauchy coefficients $A_0, A_1, \dots$ or the Sellmeier coefficients $B_i$.
+ * @param c The Sellmeier coefficients $C_i$ in square micrometres; must be empty for the Cauchy model.
+ * @throws OptiSimError If the model is unknown, if no coefficients are given, or if the Sellmeier lists differ in length.
+ */
+DispersionModel::DispersionModel(string model, vector<double> b, vector<double> c){
+    if(model == "sellmeier") sellmeier = true;
+    else if(model == "cauchy") sellmeier = false;
+    else throw OptiSimError("ERROR: \tInvalid dispersion model: " + model);
+    if(b.size() == 0) throw OptiSimError("ERROR: \tThe dispersion model needs at least one coefficient.");
+    if(sellmeier && b.size() != c.size()) throw OptiSimError("ERROR: \tThe Sellmeier model needs the same number of B and C coefficients.");
+    if(!sellmeier && c.size() != 0) throw OptiSimError("ERROR: \tThe Cauchy model does not use C coefficients.");
+    this->b = b;
+    this->c = c;
+}
+
+/**
+ * @details This method returns the name that was passed to the constructor.
+ */
+string DispersionModel::getModel() const{
+    return sellmeier ? "sellmeier" : "cauchy";
+}
+
+/**
+ * @details This method returns a copy of the first coefficient list.
+ */
+vector<double> DispersionModel::getB() const{
+    return b;
+}
+
+/**
+ * @details This method returns a copy of the second coefficient list.
+ */
+vector<double> DispersionModel::getC() const{
+    return c;
+}
+
+/**
+ * @param wavelength The wavelength in micrometres.
+ * @throws OptiSimError If the wavelength is not positive.
+ */
+double DispersionModel::getIndex(double wavelength) const{
+    double n;
+    getIndices(&wavelength, &n, 1);
+    return n;
+}
+
+/**
+ * @details The coefficient loop is the outer loop and the wavelength loop the inner one, so every
+ * coefficient is applied to the whole array in a single, branch-free pass.
+ * @param wavelengths The wavelengths in micrometres.
+ * @param n The output array, receiving one refractive index per wavelength.
+ * @param count The number of wavelengths.
+ * @throws OptiSimError If a wavelength is not positive.
+ */
+void DispersionModel::getIndices(const double* wavelengths, double* n, size_t count) const{
+    for(size_t i = 0; i < count; i++){
+        if(!(wavelengths[i] > 0)) throw OptiSimError("ERROR: \tThe wavelength must be a positive number.");
+    }
+
+    if(sellmeier){
+        for(size_t i = 0; i < count; i++) n[i] = 1.0;
+        for(size_t k = 0; k < b.size(); k++){
+            double bk = b[k];
+            double ck = c[k];
+            for(size_t i = 0; i < count; i++){
+                double l2 = wavelengths[i] * wavelengths[i];
+                n[i] += bk * l2 / (l2 - ck);
+            }
+        }
+        for(size_t i = 0; i < count; i++) n[i] = sqrt(n[i]);
+    } else {
+        // Horner scheme in 1/lambda^2
+        for(size_t i = 0; i < count; i++) n[i] = b.back();
+        for(size_t k = b.size() - 1; k-- > 0;){
+            double bk = b[k];
+            for(size_t i = 0; i < count; i++){
+                double inv = 1.0 / (wavelengths[i] * wavelengths[i]);
+                n[i] = n[i] * inv + bk;
+            }
+        }
+    }
+}
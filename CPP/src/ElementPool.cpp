@@ -0,0 +1,56 @@
+/**
+* @file ElementPool.cpp
+* @brief Implements the ElementPool class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "ElementPool.h"
+
+using namespace std;
+
+/**
+ * @details The pool requests chunks for up to 256 objects of a size at a time from the upstream resource.
+ * @param upstream The resource to draw the chunks from; it must outlive the pool.
+ */
+ElementPool::ElementPool(pmr::memory_resource* upstream) : pool(pmr::pool_options{256, 0}, upstream){
+    live = 0;
+}
+
+/**
+ * @details The slot starts with a header holding its size, which `deallocate` needs to give it back;
+ * the object follows the header at the largest fundamental alignment.
+ * @param size The size of the object in bytes.
+ * @return The address of the object within the slot.
+ */
+void* ElementPool::allocate(size_t size){
+    size_t slot_size = header_size + size;
+    char* slot = static_cast<char*>(pool.allocate(slot_size, header_size));
+    *reinterpret_cast<size_t*>(slot) = slot_size;
+    live++;
+    return slot + header_size;
+}
+
+/**
+ * @param object The address returned by `allocate`.
+ */
+void ElementPool::deallocate(void* object){
+    char* slot = static_cast<char*>(object) - header_size;
+    pool.deallocate(slot, *reinterpret_cast<size_t*>(slot), header_size);
+    live--;
+}
+
+/**
+ * @details This method returns the number of objects created and not yet destroyed.
+ */
+size_t ElementPool::size(){
+    return live;
+}
+
+/**
+ * @details This method returns the resource passed to the constructor.
+ */
+pmr::memory_resource* ElementPool::getUpstream(){
+    return pool.upstream_resource();
+}
@@ -0,0 +1,591 @@
+/**
+* @file ElementRegistry.cpp
+* @brief Implements the ElementRegistry class and the built-in element types.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "ElementRegistry.h"
+#include <cmath>             // For std::isfinite, std::isnan
+#include <limits>            // For the NaN of required parameters
+#include "ThinLens.h"        // The built-in element types
+#include "ThickLens.h"
+#include "ApertureStop.h"
+#include "Mirror.h"
+#include "ParallelPlate.h"
+#include "OpticalSystem.h"   // For element_info and element_type
+#include "MaterialCatalog.h" // Materials of thick lenses
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+using json = nlohmann::json;
+
+static const double REQUIRED = numeric_limits<double>::quiet_NaN();
+static const double INF = numeric_limits<double>::infinity();
+
+
+// JSON helpers ---------------------------------------------------------------
+/**
+ * @brief Reads a dispersion model from its JSON description.
+ * @details The Cauchy model is written as `{"model": "cauchy", "coefficients": [A0, A1, ...]}` and the
+ * Sellmeier model as `{"model": "sellmeier", "B": [B1, B2, ...], "C": [C1, C2, ...]}`.
+ * @param data The JSON object describing the model.
+ * @return The dispersion model.
+ * @throws OptiSimError If the description is incomplete or invalid.
+ */
+static shared_ptr<const DispersionModel> readDispersion(const json& data){
+    string model = data.value("model", "");
+    if (model == "sellmeier") {
+        if (!data.contains("B") || !data.contains("C")) throw OptiSimError("ERROR: \tThe Sellmeier model needs the B and C coefficients.");
+        return make_shared<DispersionModel>(model, data["B"].get<vector<double>>(), data["C"].get<vector<double>>());
+    }
+    if (!data.contains("coefficients")) throw OptiSimError("ERROR: \tInvalid dispersion model: " + model);
+    return make_shared<DispersionModel>(model, data["coefficients"].get<vector<double>>());
+}
+
+/**
+ * @brief Tells whether two dispersion models describe the same material.
+ * @details Models read from a system file are new objects on every read, so they are compared by content.
+ */
+static bool same_dispersion(shared_ptr<const DispersionModel> a, shared_ptr<const DispersionModel> b){
+    if (a == b) return true;
+    if (!a || !b) return false;
+    return a->getModel() == b->getModel() && a->getB() == b->getB() && a->getC() == b->getC();
+}
+
+/**
+ * @details The object is in the format read by `readDispersion`.
+ * @param model The dispersion model.
+ * @return The JSON object describing the model.
+ */
+json ElementRegistry::writeDispersion(const DispersionModel& model){
+    if (model.getModel() == "sellmeier") return {{"model", "sellmeier"}, {"B", model.getB()}, {"C", model.getC()}};
+    return {{"model", "cauchy"}, {"coefficients", model.getB()}};
+}
+
+/**
+ * @brief Reads the optional decentering, tilt and aperture of an element.
+ * @details The keys are `decenter_y`, `decenter_z`, `tilt_y` and `tilt_z` (in degrees); missing keys mean 0.
+ * The radius of the clear aperture is read from `aperture`; without it the element does not limit the rays.
+ * @param data The JSON object describing the element.
+ * @param element The element to place.
+ * @throws OptiSimError If a tilt is out of range or the aperture is not positive.
+ */
+static void readPlacement(const json& data, OpticalObject& element){
+    element.setY(data.value("decenter_y", 0.0));
+    element.setZ(data.value("decenter_z", 0.0));
+    element.setTiltY(data.value("tilt_y", 0.0));
+    element.setTiltZ(data.value("tilt_z", 0.0));
+    if (data.contains("aperture")) element.setAperture(data.at("aperture"));
+}
+
+/**
+ * @brief Writes the decentering, tilt and aperture of an element, in the format read by `readPlacement`.
+ * @details Only the non-zero values and a finite aperture are written, so files of centered, unlimited systems do not change.
+ * @param element The element.
+ * @param data The JSON object describing the element.
+ */
+static void writePlacement(const OpticalObject& element, json& data){
+    if (element.getY() != 0) data["decenter_y"] = element.getY();
+    if (element.getZ() != 0) data["decenter_z"] = element.getZ();
+    if (element.getTiltY() != 0) data["tilt_y"] = element.getTiltY();
+    if (element.getTiltZ() != 0) data["tilt_z"] = element.getTiltZ();
+    if (isfinite(element.getAperture())) data["aperture"] = element.getAperture();
+}
+
+/**
+ * @brief Appends the aperture of an element to the system summary if it is limited, and its decentering and tilt if it is not centered.
+ */
+static void printPlacement(OutputWriter& os, const OpticalObject& element){
+    if (isfinite(element.getAperture())) os << ", Aperture: " << element.getAperture();
+    if (element.isCentered()) return;
+    os << ", Decenter: (" << element.getY() << ", " << element.getZ() << ")"
+       << ", Tilt: (" << element.getTiltY() << ", " << element.getTiltZ() << ")";
+}
+
+/**
+ * @brief Tells whether two elements have the same decentering, tilt and aperture.
+ */
+static bool same_placement(const OpticalObject& a, const OpticalObject& b){
+    return a.getY() == b.getY() && a.getZ() == b.getZ() && a.getTiltY() == b.getTiltY() && a.getTiltZ() == b.getTiltZ() &&
+           a.getAperture() == b.getAperture();
+}
+
+
+// Thin lenses ----------------------------------------------------------------
+/**
+ * @brief Creates a thin lens from its focal length.
+ */
+static unique_ptr<OpticalObject> create_thin(double x, const double* values){
+    return make_unique<ThinLens>(x, values[0]);
+}
+
+/**
+ * @brief The principal planes of a thin lens, which coincide with the lens.
+ */
+static principal_planes kernel_thin(const OpticalObject& element, double* df, double*, double*){
+    if (df) df[0] = 1;
+    return {static_cast<const ThinLens&>(element).getF(), element.getX(), element.getX()};
+}
+
+/**
+ * @brief Appends the parameters of a thin lens to the system summary.
+ */
+static void print_thin(OutputWriter& os, const OpticalObject& element){
+    os << ",  Position: " << element.getX()
+       << ", Focal Length: " << static_cast<const ThinLens&>(element).getF();
+}
+
+/**
+ * @brief Fills in the parameters of a thin lens in its description.
+ */
+static void describe_thin(const OpticalObject& element, element_info& info){
+    info.f = static_cast<const ThinLens&>(element).getF();
+}
+
+
+// Thick lenses ---------------------------------------------------------------
+/**
+ * @brief Creates a thick lens from its refractive index, thickness and radii.
+ */
+static unique_ptr<OpticalObject> create_thick(double x, const double* values){
+    return make_unique<ThickLens>(x, values[0], values[1], values[2], values[3]);
+}
+
+/**
+ * @brief Reads a thick lens from its JSON description.
+ * @details The material is looked up in the global catalog; a `dispersion` entry describes a model of its own.
+ * The refractive index of a lens with a material or a dispersion is the index of the model at the reference
+ * wavelength, so such a lens must not have a `refractive_index` as well.
+ * @throws OptiSimError If the lens has a `refractive_index` next to a material or a dispersion.
+ */
+static unique_ptr<OpticalObject> load_thick(const json& lens){
+    int material = -1;
+    shared_ptr<const DispersionModel> dispersion = nullptr;
+    if (lens.contains("material")) {
+        material = MaterialCatalog::global().getId(lens.at("material"));
+        dispersion = MaterialCatalog::global().getModel(material);
+    } else if (lens.contains("dispersion")) dispersion = readDispersion(lens.at("dispersion"));
+
+    if (dispersion && lens.contains("refractive_index"))
+        throw OptiSimError("ERROR: \tA thick lens with a material or a dispersion cannot have a refractive index as well.");
+    double n = dispersion ? dispersion->getIndex(OPTISIM_REFERENCE_WAVELENGTH) : (double)lens.at("refractive_index");
+    unique_ptr<ThickLens> thickl = make_unique<ThickLens>(lens.at("position"),
+                                                          n,
+                                                          lens.at("thickness"),
+                                                          lens.at("radius_left"),
+                                                          lens.at("radius_right"));
+    if (material >= 0) thickl->setMaterial(material);
+    else thickl->setDispersion(dispersion);
+    return thickl;
+}
+
+/**
+ * @brief Writes the material or the dispersion of a thick lens, in the format read by `load_thick`.
+ * @details The refractive index written from the schema is removed again for a dispersive lens.
+ */
+static void save_thick(const OpticalObject& element, json& lens){
+    const ThickLens& thick = static_cast<const ThickLens&>(element);
+    if (thick.getMaterial() >= 0) lens["material"] = MaterialCatalog::global().getName(thick.getMaterial());
+    else if (thick.getDispersion()) lens["dispersion"] = ElementRegistry::writeDispersion(*thick.getDispersion());
+    if (thick.getDispersion()) lens.erase("refractive_index");
+}
+
+/**
+ * @brief The principal planes of a thick lens and their derivatives.
+ * @details The planes follow from the lensmaker's equation used by `ThickLens`, with $u = 1/R_{left}$, $v = 1/R_{right}$
+ * and $g = (n - 1)/n$: $H_{left} = x - d/2 - f g d v$ and $H_{right} = x + d/2 - f g d u$. The derivatives are taken
+ * with respect to `n`, `d`, `r_left` and `r_right`, in schema order.
+ */
+static principal_planes kernel_thick(const OpticalObject& element, double* df, double* dh_left, double* dh_right){
+    const ThickLens& thick = static_cast<const ThickLens&>(element);
+    double n = thick.getN();
+    double d = thick.getD();
+    double u = isinf(thick.getR_Left()) ? 0.0 : 1.0 / thick.getR_Left();
+    double v = isinf(thick.getR_Right()) ? 0.0 : 1.0 / thick.getR_Right();
+    double g = (n - 1) / n;
+    double f = thick.getF();
+    principal_planes planes = {f, thick.getX() - d/2 - f * g * d * v, thick.getX() + d/2 - f * g * d * u};
+    if (!df) return planes;
+
+    // derivatives of the optical power P = 1/f
+    double dP_dn = (u - v) + d * u * v * (n*n - 1) / (n*n);
+    double dP_dd = (n - 1) * g * u * v;
+    double dP_du = (n - 1) * (1 + g * d * v);
+    double dP_dv = (n - 1) * (-1 + g * d * u);
+
+    df[0] = -f * f * dP_dn;
+    df[1] = -f * f * dP_dd;
+    df[2] = -f * f * dP_du * (-u * u);
+    df[3] = -f * f * dP_dv * (-v * v);
+
+    dh_left[0] = -df[0] * g * d * v - f * d * v / (n*n);
+    dh_right[0] = -df[0] * g * d * u - f * d * u / (n*n);
+    dh_left[1] = -0.5 - df[1] * g * d * v - f * g * v;
+    dh_right[1] = 0.5 - df[1] * g * d * u - f * g * u;
+    dh_left[2] = -df[2] * g * d * v;
+    dh_right[2] = -df[2] * g * d * u + f * g * d * u * u;
+    dh_left[3] = -df[3] * g * d * v + f * g * d * v * v;
+    dh_right[3] = -df[3] * g * d * u;
+    return planes;
+}
+
+/**
+ * @brief Appends the parameters of a thick lens to the system summary.
+ */
+static void print_thick(OutputWriter& os, const OpticalObject& element){
+    const ThickLens& thick = static_cast<const ThickLens&>(element);
+    os << ", Position: " << thick.getX()
+       << ", n: " << thick.getN()
+       << ", Thickness: " << thick.getD()
+       << ", Radius_left: " << thick.getR_Left()
+       << ", Radius_right: " << thick.getR_Right()
+       << ", Focal Length: " << thick.getF();
+    if (thick.getMaterial() >= 0) os << ", Material: " << MaterialCatalog::global().getName(thick.getMaterial());
+    else if (thick.getDispersion()) os << ", Dispersion: " << thick.getDispersion()->getModel();
+}
+
+/**
+ * @brief Tells whether two thick lenses have the same material.
+ */
+static bool same_thick(const OpticalObject& a, const OpticalObject& b){
+    const ThickLens& ours = static_cast<const ThickLens&>(a);
+    const ThickLens& theirs = static_cast<const ThickLens&>(b);
+    return ours.getMaterial() == theirs.getMaterial() && same_dispersion(ours.getDispersion(), theirs.getDispersion());
+}
+
+/**
+ * @brief Fills in the parameters of a thick lens in its description.
+ */
+static void describe_thick(const OpticalObject& element, element_info& info){
+    const ThickLens& thick = static_cast<const ThickLens&>(element);
+    info.f = thick.getF();
+    info.n = thick.getN();
+    info.d = thick.getD();
+    info.r_left = thick.getR_Left();
+    info.r_right = thick.getR_Right();
+}
+
+
+// Aperture stops -------------------------------------------------------------
+/**
+ * @brief Creates an aperture stop from its aperture.
+ */
+static unique_ptr<OpticalObject> create_stop(double x, const double* values){
+    return make_unique<ApertureStop>(x, values[0]);
+}
+
+/**
+ * @brief The principal planes of an aperture stop, which has no optical power.
+ */
+static principal_planes kernel_stop(const OpticalObject& element, double*, double*, double*){
+    return {INF, element.getX(), element.getX()};
+}
+
+/**
+ * @brief Appends the position of an aperture stop to the system summary; its aperture is printed with the placement.
+ */
+static void print_stop(OutputWriter& os, const OpticalObject& element){
+    os << ", Position: " << element.getX();
+}
+
+
+// Mirrors --------------------------------------------------------------------
+/**
+ * @brief Creates a mirror from its radius.
+ */
+static unique_ptr<OpticalObject> create_mirror(double x, const double* values){
+    return make_unique<Mirror>(x, values[0]);
+}
+
+/**
+ * @brief The principal planes of a mirror in the unfolded system, which coincide with the mirror.
+ */
+static principal_planes kernel_mirror(const OpticalObject& element, double* df, double*, double*){
+    if (df) df[0] = isinf(static_cast<const Mirror&>(element).getR()) ? 0.0 : -0.5;
+    return {static_cast<const Mirror&>(element).getF(), element.getX(), element.getX()};
+}
+
+/**
+ * @brief Appends the parameters of a mirror to the system summary.
+ */
+static void print_mirror(OutputWriter& os, const OpticalObject& element){
+    const Mirror& mirror = static_cast<const Mirror&>(element);
+    os << ", Position: " << mirror.getX()
+       << ", Radius: " << mirror.getR()
+       << ", Focal Length: " << mirror.getF();
+}
+
+/**
+ * @brief Fills in the parameters of a mirror in its description; the radius is stored as `r_left`.
+ */
+static void describe_mirror(const OpticalObject& element, element_info& info){
+    const Mirror& mirror = static_cast<const Mirror&>(element);
+    info.f = mirror.getF();
+    info.r_left = mirror.getR();
+}
+
+
+// Parallel plates ------------------------------------------------------------
+/**
+ * @brief Creates a parallel plate from its refractive index and thickness.
+ */
+static unique_ptr<OpticalObject> create_plate(double x, const double* values){
+    return make_unique<ParallelPlate>(x, values[0], values[1]);
+}
+
+/**
+ * @brief The principal planes of a parallel plate, half its shift in front of and behind its middle.
+ */
+static principal_planes kernel_plate(const OpticalObject& element, double*, double* dh_left, double* dh_right){
+    const ParallelPlate& plate = static_cast<const ParallelPlate&>(element);
+    double shift = plate.getShift();
+    if (dh_left) {
+        // the shift d (1 - 1/n) with respect to n and d
+        double dshift[2] = {plate.getD() / (plate.getN() * plate.getN()), 1 - 1 / plate.getN()};
+        for (int k = 0; k < 2; k++) {
+            dh_left[k] = -dshift[k] / 2;
+            dh_right[k] = dshift[k] / 2;
+        }
+    }
+    return {INF, plate.getX() - shift/2, plate.getX() + shift/2};
+}
+
+/**
+ * @brief Appends the parameters of a parallel plate to the system summary.
+ */
+static void print_plate(OutputWriter& os, const OpticalObject& element){
+    const ParallelPlate& plate = static_cast<const ParallelPlate&>(element);
+    os << ", Position: " << plate.getX()
+       << ", n: " << plate.getN()
+       << ", Thickness: " << plate.getD();
+}
+
+/**
+ * @brief Fills in the parameters of a parallel plate in its description.
+ */
+static void describe_plate(const OpticalObject& element, element_info& info){
+    const ParallelPlate& plate = static_cast<const ParallelPlate&>(element);
+    info.n = plate.getN();
+    info.d = plate.getD();
+}
+
+
+// Registry -------------------------------------------------------------------
+/**
+ * @param name The name of the parameter.
+ */
+int element_class::param(string_view name) const{
+    for (int k = 0; k < params.size(); k++) {
+        if (params[k].name == name) return k;
+    }
+    return -1;
+}
+
+/**
+ * @details The built-in types are registered in the order of `element_type`, so their IDs are its values.
+ */
+ElementRegistry::ElementRegistry() : count(0){
+    add({ELEMENT_THIN_LENS, "thin", "Thin Lens", &typeid(ThinLens),
+         {{"f", "focal_length", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ThinLens&>(e).getF(); },
+           [](OpticalObject& e, double v){ static_cast<ThinLens&>(e).setF(v); }}},
+         create_thin, copy_element<ThinLens>, clone_element<ThinLens>, kernel_thin,
+         nullptr, nullptr, print_thin, nullptr, describe_thin});
+    add({ELEMENT_THICK_LENS, "thick", "Thick Lens", &typeid(ThickLens),
+         {{"n", "refractive_index", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ThickLens&>(e).getN(); },
+           [](OpticalObject& e, double v){ static_cast<ThickLens&>(e).setN(v); }},
+          {"d", "thickness", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ThickLens&>(e).getD(); },
+           [](OpticalObject& e, double v){ static_cast<ThickLens&>(e).setD(v); }},
+          {"r_left", "radius_left", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ThickLens&>(e).getR_Left(); },
+           [](OpticalObject& e, double v){ static_cast<ThickLens&>(e).setR_Left(v); }},
+          {"r_right", "radius_right", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ThickLens&>(e).getR_Right(); },
+           [](OpticalObject& e, double v){ static_cast<ThickLens&>(e).setR_Right(v); }},
+          {"f", "", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ThickLens&>(e).getF(); }, nullptr}},
+         create_thick, copy_element<ThickLens>, clone_element<ThickLens>, kernel_thick,
+         load_thick, save_thick, print_thick, same_thick, describe_thick});
+    add({ELEMENT_STOP, "stop", "Aperture Stop", &typeid(ApertureStop),
+         {{"aperture", "aperture", REQUIRED,
+           [](const OpticalObject& e){ return e.getAperture(); },
+           [](OpticalObject& e, double v){ e.setAperture(v); }}},
+         create_stop, copy_element<ApertureStop>, clone_element<ApertureStop>, kernel_stop,
+         nullptr, nullptr, print_stop, nullptr, nullptr});
+    add({ELEMENT_MIRROR, "mirror", "Mirror", &typeid(Mirror),
+         {{"r", "radius", INF,
+           [](const OpticalObject& e){ return static_cast<const Mirror&>(e).getR(); },
+           [](OpticalObject& e, double v){ static_cast<Mirror&>(e).setR(v); }},
+          {"f", "", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const Mirror&>(e).getF(); }, nullptr}},
+         create_mirror, copy_element<Mirror>, clone_element<Mirror>, kernel_mirror,
+         nullptr, nullptr, print_mirror, nullptr, describe_mirror});
+    add({ELEMENT_PLATE, "plate", "Parallel Plate", &typeid(ParallelPlate),
+         {{"n", "refractive_index", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ParallelPlate&>(e).getN(); },
+           [](OpticalObject& e, double v){ static_cast<ParallelPlate&>(e).setN(v); }},
+          {"d", "thickness", REQUIRED,
+           [](const OpticalObject& e){ return static_cast<const ParallelPlate&>(e).getD(); },
+           [](OpticalObject& e, double v){ static_cast<ParallelPlate&>(e).setD(v); }}},
+         create_plate, copy_element<ParallelPlate>, clone_element<ParallelPlate>, kernel_plate,
+         nullptr, nullptr, print_plate, nullptr, describe_plate});
+}
+
+/**
+ * @details The global registry is created, with the built-in types, on first use.
+ */
+ElementRegistry& ElementRegistry::global(){
+    static ElementRegistry registry;
+    return registry;
+}
+
+/**
+ * @details The `id` of the class is ignored and replaced by the next free type ID.
+ * @param type The class of the new type.
+ * @return The type ID of the new type.
+ * @throws OptiSimError If the name or the C++ class is already registered, if a required entry is missing,
+ * if the schema has more than `ELEMENT_MAX_PARAMS` parameters, or if the registry is full.
+ */
+int ElementRegistry::add(element_class type){
+    if (type.name.empty() || !type.cls) throw OptiSimError("ERROR: \tAn element type needs a name and a class.");
+    if (!type.create || !type.copy || !type.clone || !type.kernel)
+        throw OptiSimError("ERROR: \tThe element type " + type.name + " needs a factory, copy and clone functions and a kernel.");
+    if (type.params.size() > ELEMENT_MAX_PARAMS) throw OptiSimError("ERROR: \tThe element type " + type.name + " has too many parameters.");
+    for (const element_param& param : type.params) {
+        if (param.name.empty() || !param.get) throw OptiSimError("ERROR: \tInvalid parameter of the element type " + type.name);
+        if (param.set && param.key.empty()) throw OptiSimError("ERROR: \tThe parameter " + param.name + " needs a key in system files.");
+    }
+
+    lock_guard<mutex> lock(registration);
+    int id = count.load(memory_order_relaxed);
+    for (int i = 0; i < id; i++) {
+        if (classes[i]->name == type.name || *classes[i]->cls == *type.cls)
+            throw OptiSimError("ERROR: \tThe element type " + type.name + " is already registered.");
+    }
+    if (id == ELEMENT_MAX_TYPES) throw OptiSimError("ERROR: \tToo many element types.");
+    type.id = id;
+    classes[id] = make_unique<const element_class>(move(type));
+    count.store(id + 1, memory_order_release);
+    return id;
+}
+
+/**
+ * @param id The type ID.
+ * @throws OptiSimError If the ID is not valid.
+ */
+const element_class& ElementRegistry::get(int id) const{
+    if (id < 0 || id >= count.load(memory_order_acquire)) throw OptiSimError("ERROR: \tInvalid element type ID: " + to_string(id));
+    return *classes[id];
+}
+
+/**
+ * @details The type is found by the dynamic class of the element, scanning the few registered classes.
+ * @param element The element.
+ * @throws OptiSimError If the class of the element is not registered.
+ */
+const element_class& ElementRegistry::of(const OpticalObject& element) const{
+    const type_info& cls = typeid(element);
+    int n = count.load(memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        if (*classes[i]->cls == cls) return *classes[i];
+    }
+    throw OptiSimError("ERROR: \tUnsupported optical object type: " + string(cls.name()));
+}
+
+/**
+ * @param name The value of the `type` key in system files.
+ */
+const element_class* ElementRegistry::find(const string& name) const{
+    int n = count.load(memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        if (classes[i]->name == name) return classes[i].get();
+    }
+    return nullptr;
+}
+
+/**
+ * @details This method returns the number of registered types, the built-in ones included.
+ */
+int ElementRegistry::size() const{
+    return count.load(memory_order_acquire);
+}
+
+/**
+ * @details The element is created by the `load` hook of the type if it has one. Otherwise the settable parameters are
+ * read from their keys, with the fallback of an optional parameter for a missing key, and passed to `create`.
+ * The decentering, tilt and aperture are read last.
+ * @param type The type of the element.
+ * @param data The JSON object describing the element.
+ * @return The new element.
+ * @throws OptiSimError If a parameter is out of range.
+ * @throws nlohmann::json::exception If a required key is missing or has the wrong type.
+ */
+unique_ptr<OpticalObject> ElementRegistry::read(const element_class& type, const json& data){
+    unique_ptr<OpticalObject> element;
+    if (type.load) element = type.load(data);
+    else {
+        double values[ELEMENT_MAX_PARAMS];
+        for (size_t k = 0; k < type.params.size(); k++) {
+            const element_param& param = type.params[k];
+            if (!param.set) values[k] = REQUIRED;
+            else if (isnan(param.fallback) || data.contains(param.key)) values[k] = data.at(param.key);
+            else values[k] = param.fallback;
+        }
+        element = type.create(data.at("position"), values);
+    }
+    readPlacement(data, *element);
+    return element;
+}
+
+/**
+ * @details Read-only parameters are not written, nor optional ones equal to their fallback, so e.g. a plane mirror has no radius.
+ * The name of the element is left to the caller.
+ * @param type The type of the element.
+ * @param element The element.
+ * @param data The JSON object describing the element.
+ */
+void ElementRegistry::write(const element_class& type, const OpticalObject& element, json& data){
+    data["type"] = type.name;
+    data["position"] = element.getX();
+    for (const element_param& param : type.params) {
+        if (!param.set) continue;
+        double value = param.get(element);
+        if (!isnan(param.fallback) && value == param.fallback) continue;
+        data[param.key] = value;
+    }
+    if (type.save) type.save(element, data);
+    writePlacement(element, data);
+}
+
+/**
+ * @details Without a `print` hook the position and every parameter of the schema are printed by name.
+ * @param type The type of the element.
+ * @param os The writer of the summary.
+ * @param element The element.
+ */
+void ElementRegistry::print(const element_class& type, OutputWriter& os, const OpticalObject& element){
+    if (type.print) type.print(os, element);
+    else {
+        os << ", Position: " << element.getX();
+        for (const element_param& param : type.params) os << ", " << param.name << ": " << param.get(element);
+    }
+    printPlacement(os, element);
+}
+
+/**
+ * @details Both elements must be of the given type. Read-only parameters follow from the others and are not compared.
+ * @param type The type of the elements.
+ * @param a The first element.
+ * @param b The second element.
+ */
+bool ElementRegistry::same(const element_class& type, const OpticalObject& a, const OpticalObject& b){
+    if (a.getX() != b.getX() || !same_placement(a, b)) return false;
+    for (const element_param& param : type.params) {
+        if (param.set && param.get(a) != param.get(b)) return false;
+    }
+    return !type.same || type.same(a, b);
+}
@@ -0,0 +1,87 @@
+/**
+* @file FileWatcher.cpp
+* @brief Implements the FileWatcher class on top of inotify.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "FileWatcher.h"
+#include <chrono>            // For the timeout
+#include <cstring>           // For std::strerror
+#include <cerrno>            // For errno
+#include <filesystem>        // For splitting the path
+#include <poll.h>            // For waiting with a timeout
+#include <unistd.h>          // For read, close
+#include <sys/inotify.h>     // For the file events
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+
+/**
+ * @brief The time during which further events are merged into the change being reported, in milliseconds.
+ */
+static const int settle_ms = 20;
+
+/**
+ * @param path The path of the file; the file itself does not need to exist yet.
+ * @throws OptiSimError If the directory of the file cannot be watched.
+ */
+FileWatcher::FileWatcher(const string& path){
+    filesystem::path file(path);
+    string directory = file.parent_path().empty() ? "." : file.parent_path().string();
+    file_name = file.filename().string();
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) throw OptiSimError("ERROR: \tinotify is not available: " + string(strerror(errno)));
+    if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        string reason = strerror(errno);
+        close(fd);
+        throw OptiSimError("ERROR: \tFailed to watch " + directory + ": " + reason);
+    }
+}
+
+/**
+ * @details Closing the descriptor removes the watch.
+ */
+FileWatcher::~FileWatcher(){
+    close(fd);
+}
+
+/**
+ * @details Events of other files in the directory are skipped. After the first event of the file, events arriving
+ * within a short settling time are merged into it, so a save that writes the file several times is one change.
+ * @param timeout_ms The longest time to wait in milliseconds, or -1 to wait indefinitely.
+ * @throws OptiSimError If the events cannot be read.
+ */
+bool FileWatcher::wait(int timeout_ms){
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout_ms);
+    bool changed = false;
+    alignas(inotify_event) char buffer[16384];
+    while (true) {
+        int wait_ms = timeout_ms;
+        if (changed) wait_ms = settle_ms;
+        else if (timeout_ms >= 0) {
+            wait_ms = (int)chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+            if (wait_ms < 0) return false;
+        }
+
+        pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, wait_ms);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) throw OptiSimError("ERROR: \tFailed to wait for file events: " + string(strerror(errno)));
+        if (ready == 0) {
+            if (changed) return true;
+            if (timeout_ms >= 0) return false;
+            continue;
+        }
+
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + n; p += sizeof(inotify_event) + ((inotify_event*)p)->len) {
+                inotify_event* event = (inotify_event*)p;
+                if (event->len > 0 && file_name == event->name) changed = true;
+            }
+        }
+    }
+}
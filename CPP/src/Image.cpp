@@ -13,15 +13,16 @@
  * @param x A double value for the x-coordinate (passed to ImagingSubject).
  * @param y A double value for the y-coordinate (passed to ImagingSubject).
  * @param real A boolean indicating whether the image is real (true) or virtual (false).
+ * @param z A double value for the z-coordinate (passed to ImagingSubject).
  */
-Image::Image(double x, double y, bool real):ImagingSubject(x, y){
+Image::Image(double x, double y, bool real, double z):ImagingSubject(x, y, z){
     this->real = real;
 }
 
 /**
  * @details This is a simple getter method that returns the current value of the `real` member.
  */
-bool Image::getReal(){
+bool Image::getReal() const{
     return real;
 }
 
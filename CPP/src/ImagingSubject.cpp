@@ -9,26 +9,28 @@
 #include "ImagingSubject.h"
 
 /**
- * @details This protected constructor initializes the x and y coordinates of the imaging subject.
+ * @details This protected constructor initializes the x, y and z coordinates of the imaging subject.
  * @param x The initial x-coordinate.
  * @param y The initial y-coordinate.
+ * @param z The initial z-coordinate.
  */
-ImagingSubject::ImagingSubject(double x, double y){
+ImagingSubject::ImagingSubject(double x, double y, double z){
     this->x = x;
     this->y = y;
+    this->z = z;
 }
 
 /**
  * @details This method returns the current x-coordinate of the imaging subject.
  */
-double ImagingSubject::getX(){
+double ImagingSubject::getX() const{
     return this->x;
 }
 
 /**
  * @details This method returns the current y-coordinate of the imaging subject.
  */
-double ImagingSubject::getY(){
+double ImagingSubject::getY() const{
     return this->y;
 }
 
@@ -46,4 +48,19 @@ void ImagingSubject::setX(double x){
  */
 void ImagingSubject::setY(double y){
     this->y = y;
+}
+
+/**
+ * @details This method returns the current z-coordinate of the imaging subject.
+ */
+double ImagingSubject::getZ() const{
+    return this->z;
+}
+
+/**
+ * @details This method updates the z-coordinate of the imaging subject.
+ * @param z The new z-coordinate value.
+ */
+void ImagingSubject::setZ(double z){
+    this->z = z;
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+/**
+* @file Instrumentation.cpp
+* @brief Implements the Instrumentation and ScopedTimer classes.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "Instrumentation.h"
+#include <atomic>            // For lock-free updates
+#include "OutputWriter.h"    // For formatting the report
+#include "Trace.h"           // Timed phases also appear in the timeline
+
+using namespace std;
+
+/**
+ * @brief The number of timed calls of every phase.
+ */
+static atomic<long long> phase_calls[PHASE_COUNT];
+
+/**
+ * @brief The total time of every phase in nanoseconds.
+ */
+static atomic<long long> phase_nanoseconds[PHASE_COUNT];
+
+/**
+ * @brief The longest call of every phase in nanoseconds.
+ */
+static atomic<long long> phase_max_nanoseconds[PHASE_COUNT];
+
+/**
+ * @brief The value of every counter.
+ */
+static atomic<long long> counters[COUNTER_COUNT];
+
+/**
+ * @param phase The phase.
+ * @param nanoseconds The duration of the call in nanoseconds.
+ */
+void Instrumentation::addTime(stats_phase phase, long long nanoseconds){
+    phase_calls[phase].fetch_add(1, memory_order_relaxed);
+    phase_nanoseconds[phase].fetch_add(nanoseconds, memory_order_relaxed);
+    long long longest = phase_max_nanoseconds[phase].load(memory_order_relaxed);
+    while (nanoseconds > longest && !phase_max_nanoseconds[phase].compare_exchange_weak(longest, nanoseconds, memory_order_relaxed));
+}
+
+/**
+ * @param counter The counter.
+ * @param n The amount to add.
+ */
+void Instrumentation::count(stats_counter counter, long long n){
+    counters[counter].fetch_add(n, memory_order_relaxed);
+}
+
+/**
+ * @param phase The phase.
+ */
+long long Instrumentation::getCalls(stats_phase phase){
+    return phase_calls[phase].load(memory_order_relaxed);
+}
+
+/**
+ * @param phase The phase.
+ */
+double Instrumentation::getSeconds(stats_phase phase){
+    return phase_nanoseconds[phase].load(memory_order_relaxed) * 1e-9;
+}
+
+/**
+ * @param phase The phase.
+ */
+double Instrumentation::getMaxSeconds(stats_phase phase){
+    return phase_max_nanoseconds[phase].load(memory_order_relaxed) * 1e-9;
+}
+
+/**
+ * @param counter The counter.
+ */
+long long Instrumentation::getCount(stats_counter counter){
+    return counters[counter].load(memory_order_relaxed);
+}
+
+/**
+ * @param phase The phase.
+ */
+const char* Instrumentation::getName(stats_phase phase){
+    static const char* names[PHASE_COUNT] = {"parse", "add", "calculate", "save", "output"};
+    return names[phase];
+}
+
+/**
+ * @param counter The counter.
+ */
+const char* Instrumentation::getName(stats_counter counter){
+    static const char* names[COUNTER_COUNT] = {"element_evaluations", "allocations", "exceptions"};
+    return names[counter];
+}
+
+/**
+ * @details The answer reflects how the library itself was compiled, not the code including this header.
+ */
+bool Instrumentation::isEnabled(){
+    return OPTISIM_INSTRUMENTATION != 0;
+}
+
+/**
+ * @details Updates running concurrently with the reset may be lost.
+ */
+void Instrumentation::reset(){
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        phase_calls[i] = 0;
+        phase_nanoseconds[i] = 0;
+        phase_max_nanoseconds[i] = 0;
+    }
+    for (int i = 0; i < COUNTER_COUNT; i++) counters[i] = 0;
+}
+
+/**
+ * @details The timers are inclusive: a phase nested in another (e.g. `add` while parsing a system file) is
+ * counted in both. The table is formatted by an `OutputWriter` and written to the stream in one piece.
+ * @param os The output stream to which the table will be written. Defaults to `std::cout`.
+ */
+void Instrumentation::report(ostream& os){
+    OutputWriter out(os);
+    out << "\n-------------------------------------------------------------------------------\n";
+    out << "#    STATISTICS";
+    if (!isEnabled()) out << " (instrumentation compiled out)";
+    out << "\n-------------------------------------------------------------------------------\n";
+    out.writeText("Phase", 22);
+    out.writeText("Calls", 12, false);
+    out.writeText("Total [ms]", 15, false);
+    out.writeText("Mean [us]", 15, false);
+    out.writeText("Max [us]", 15, false);
+    out << "\n";
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        stats_phase phase = (stats_phase)i;
+        long long calls = getCalls(phase);
+        out.writeText(getName(phase), 22);
+        out.writeText(to_string(calls), 12, false);
+        out.writeFixed(getSeconds(phase) * 1e3, 3, 15);
+        out.writeFixed(calls ? getSeconds(phase) * 1e6 / calls : 0.0, 3, 15);
+        out.writeFixed(getMaxSeconds(phase) * 1e6, 3, 15);
+        out << "\n";
+    }
+    out << "\n";
+    out.writeText("Counter", 22);
+    out.writeText("Value", 12, false);
+    out << "\n";
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        out.writeText(getName((stats_counter)i), 22);
+        out.writeText(to_string(getCount((stats_counter)i)), 12, false);
+        out << "\n";
+    }
+    out << "-------------------------------------------------------------------------------\n";
+}
+
+/**
+ * @param phase The phase to time.
+ */
+ScopedTimer::ScopedTimer(stats_phase phase){
+    this->phase = phase;
+    this->start = chrono::steady_clock::now();
+}
+
+/**
+ * @details Records the elapsed time with `Instrumentation::addTime`, and as a span named after the phase if tracing is on.
+ */
+ScopedTimer::~ScopedTimer(){
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    Instrumentation::addTime(phase, chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+    if (Trace::isEnabled()) Trace::record(Instrumentation::getName(phase), start, end);
+}
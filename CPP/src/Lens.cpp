@@ -8,6 +8,8 @@
 
 #include "Lens.h"
 #include <iostream>
+#include <cmath>            // For std::isinf, std::abs
+#include <limits>           // For std::numeric_limits
 #include "OptiSimError.h"
 
 using namespace std;
@@ -27,6 +29,84 @@ Lens::Lens(double x, double f):OpticalObject(x){
 /**
  * @details This method returns the focal length of the lens.
  */
-double Lens::getF(){
+double Lens::getF() const{
     return f;
-}
\ No newline at end of file
+}
+
+/**
+ * @details This method implements the thin lens formula to determine the image's
+ * position, size, and whether it is real or virtual. The object distance `d_is`
+ * is calculated relative to the lens's own position (`x`). Thin lenses and spherical mirrors image this way.
+ *
+ * @param is The `ImagingSubject` (object) to be imaged. This includes
+ * its x-coordinate and y-coordinate (height/size).
+ */
+Image Lens::CalculateThin(const ImagingSubject& is) const{
+    double d_is = x - is.getX();
+    double y_is = is.getY();
+
+    double d_im;
+    double y_im;
+    bool is_real;
+
+    if (isinf(d_is)) {
+        d_im = f;
+        y_im = 0.0;
+        is_real = (f > 0);
+    } else {
+        double denominator = d_is - f;
+
+        if (abs(denominator) < numeric_limits<double>::epsilon()) {
+            y_im = numeric_limits<double>::infinity();
+            if (f > 0) {
+                d_im = numeric_limits<double>::infinity();
+                is_real = true;
+            } else {
+                d_im = -numeric_limits<double>::infinity();
+                is_real = false;
+            }
+        } else {
+            d_im = (f * d_is) / denominator;
+            y_im = -d_im / d_is * y_is;
+            is_real = d_im > 0;
+        }
+    }
+
+    return Image(x + d_im, y_im, is_real);
+}
+
+/**
+ * @details Every lane uses the same focal length. The lanes are processed in one loop that computes the regular
+ * image first and then substitutes the special cases of `CalculateThin` (subject at infinity, subject in the
+ * focal plane), which keeps the loop body free of early exits.
+ * @param x The subject positions on entry, the image positions on exit.
+ * @param y The subject heights on entry, the image heights on exit.
+ * @param real The real (1) or virtual (0) status of each image on exit.
+ * @param count The number of wavelengths.
+ */
+void Lens::CalculateThinSpectrum(double* x, double* y, char* real, size_t count) const{
+    const double position = this->x;
+    const double inf = numeric_limits<double>::infinity();
+
+    for(size_t i = 0; i < count; i++){
+        double d_is = position - x[i];
+        double denominator = d_is - f;
+        double d_im = (f * d_is) / denominator;
+        double y_im = -d_im / d_is * y[i];
+        bool is_real = d_im > 0;
+
+        if (abs(d_is) == inf) {
+            d_im = f;
+            y_im = 0.0;
+            is_real = (f > 0);
+        } else if (abs(denominator) < numeric_limits<double>::epsilon()) {
+            y_im = inf;
+            d_im = f > 0 ? inf : -inf;
+            is_real = f > 0;
+        }
+
+        x[i] = position + d_im;
+        y[i] = y_im;
+        real[i] = is_real;
+    }
+}
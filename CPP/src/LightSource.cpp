@@ -9,8 +9,9 @@
 #include "LightSource.h"
 
 /**
- * @details This constructor initializes the x and y coordinates of the light source by passing them to the base `ImagingSubject` constructor.
+ * @details This constructor initializes the x, y and z coordinates of the light source by passing them to the base `ImagingSubject` constructor.
  * @param x The x-coordinate of the light source.
  * @param y The y-coordinate of the light source.
+ * @param z The z-coordinate of the light source.
  */
-LightSource::LightSource(double x, double y):ImagingSubject(x, y){};
\ No newline at end of file
+LightSource::LightSource(double x, double y, double z):ImagingSubject(x, y, z){};
\ No newline at end of file
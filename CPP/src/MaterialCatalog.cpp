@@ -0,0 +1,272 @@
+/**
+* @file MaterialCatalog.cpp
+* @brief Implements the MaterialCatalog class, its file loaders and its index cache.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "MaterialCatalog.h"
+#include <fstream>           // For reading catalog files
+#include <sstream>           // For splitting CSV lines
+#include <cstring>           // For std::memcpy
+#include <filesystem>        // For normalizing file names
+#include <mutex>             // For std::unique_lock
+#include <nlohmann/json.hpp> // Assumes nlohmann/json library is installed
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * @brief Returns the bit pattern of a wavelength, used as the cache key.
+ */
+static uint64_t wavelength_key(double wavelength){
+    uint64_t key;
+    memcpy(&key, &wavelength, sizeof(key));
+    return key;
+}
+
+/**
+ * @details Creates a catalog without materials.
+ */
+MaterialCatalog::MaterialCatalog(){
+    evaluations = 0;
+}
+
+/**
+ * @details The global catalog is created on first use. `OpticalSystem` loads the catalog files named in
+ * system files into it, and `ThickLens::setMaterial` resolves material IDs against it.
+ */
+MaterialCatalog& MaterialCatalog::global(){
+    static MaterialCatalog catalog;
+    return catalog;
+}
+
+/**
+ * @details The format is chosen by the file extension: `.csv` files are read as CSV, anything else as JSON.
+ * A file that was already loaded into this catalog is skipped, so many systems can name the same catalog
+ * without parsing it again.
+ * @param file_name The path of the catalog file.
+ * @throws OptiSimError If the file cannot be opened or contains an invalid material.
+ */
+void MaterialCatalog::load(const string& file_name){
+    string key = filesystem::weakly_canonical(filesystem::path(file_name)).string();
+    {
+        shared_lock<shared_mutex> lock(mutex);
+        if(loaded_files.count(key)) return;
+    }
+
+    if(filesystem::path(file_name).extension() == ".csv") loadCsv(file_name);
+    else loadJson(file_name);
+
+    unique_lock<shared_mutex> lock(mutex);
+    loaded_files.insert(key);
+}
+
+/**
+ * @param file_name The path of the JSON catalog file.
+ * @throws OptiSimError If the file cannot be opened or parsed, or if a material is invalid.
+ */
+void MaterialCatalog::loadJson(const string& file_name){
+    ifstream file(file_name);
+    if (!file.is_open()) throw OptiSimError("ERROR: \t Failed to open file: " + file_name);
+
+    json data;
+    try {
+        file >> data;
+    } catch (json::parse_error& e) {
+        throw OptiSimError("ERROR: \tJSON parse error: " + string(e.what()));
+    }
+
+    for (const auto& material : data["materials"]) {
+        string model = material.value("model", "");
+        if (model == "sellmeier") {
+            if (!material.contains("B") || !material.contains("C")) throw OptiSimError("ERROR: \tThe Sellmeier model needs the B and C coefficients.");
+            add(material["name"], make_shared<DispersionModel>(model, material["B"].get<vector<double>>(), material["C"].get<vector<double>>()));
+        } else {
+            if (!material.contains("coefficients")) throw OptiSimError("ERROR: \tInvalid dispersion model: " + model);
+            add(material["name"], make_shared<DispersionModel>(model, material["coefficients"].get<vector<double>>()));
+        }
+    }
+}
+
+/**
+ * @details Empty lines, lines starting with `#` and a header line whose second column is `model` are ignored.
+ * @param file_name The path of the CSV catalog file.
+ * @throws OptiSimError If the file cannot be opened or a line is invalid.
+ */
+void MaterialCatalog::loadCsv(const string& file_name){
+    ifstream file(file_name);
+    if (!file.is_open()) throw OptiSimError("ERROR: \t Failed to open file: " + file_name);
+
+    string line;
+    int line_number = 0;
+    while (getline(file, line)) {
+        line_number++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        vector<string> fields;
+        stringstream stream(line);
+        string field;
+        while (getline(stream, field, ',')) {
+            size_t first = field.find_first_not_of(" \t");
+            size_t last = field.find_last_not_of(" \t");
+            fields.push_back(first == string::npos ? "" : field.substr(first, last - first + 1));
+        }
+        if (fields.size() >= 2 && fields[1] == "model") continue;
+        if (fields.size() < 3) throw OptiSimError("ERROR: \tInvalid catalog line " + to_string(line_number) + " in " + file_name);
+
+        vector<double> coefficients;
+        try {
+            for (int i = 2; i < fields.size(); i++) coefficients.push_back(stod(fields[i]));
+        } catch (exception&) {
+            throw OptiSimError("ERROR: \tInvalid number on catalog line " + to_string(line_number) + " in " + file_name);
+        }
+
+        if (fields[1] == "sellmeier") {
+            if (coefficients.size() % 2 != 0) throw OptiSimError("ERROR: \tThe Sellmeier model needs the same number of B and C coefficients.");
+            size_t half = coefficients.size() / 2;
+            add(fields[0], make_shared<DispersionModel>(fields[1],
+                                                        vector<double>(coefficients.begin(), coefficients.begin() + half),
+                                                        vector<double>(coefficients.begin() + half, coefficients.end())));
+        } else {
+            add(fields[0], make_shared<DispersionModel>(fields[1], coefficients));
+        }
+    }
+}
+
+/**
+ * @details A new name is interned with the next free ID. A material never changes once it is added, because lenses
+ * made of it keep the refractive index and focal length it gave them: adding a name that already exists with the
+ * same model (e.g. from a second catalog file) keeps its ID, and adding it with a different model is an error.
+ * @param name The name of the material.
+ * @param model The dispersion model of the material.
+ * @return The ID of the material.
+ * @throws OptiSimError If the model is `nullptr`, or if the name already exists with a different model.
+ */
+int MaterialCatalog::add(const string& name, shared_ptr<const DispersionModel> model){
+    if (!model) throw OptiSimError("ERROR: \tThe material " + name + " has no dispersion model.");
+    unique_lock<shared_mutex> lock(mutex);
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        const DispersionModel& existing = *models[it->second];
+        if (existing.getModel() != model->getModel() || existing.getB() != model->getB() || existing.getC() != model->getC())
+            throw OptiSimError("ERROR: \tThe material " + name + " is already defined with a different dispersion model.");
+        return it->second;
+    }
+    int id = names.size();
+    names.push_back(name);
+    models.push_back(model);
+    cache.emplace_back();
+    ids[name] = id;
+    return id;
+}
+
+/**
+ * @param name The name of the material.
+ * @throws OptiSimError If there is no material with this name.
+ */
+int MaterialCatalog::getId(const string& name) const{
+    shared_lock<shared_mutex> lock(mutex);
+    auto it = ids.find(name);
+    if (it == ids.end()) throw OptiSimError("ERROR: \tUnknown material: " + name);
+    return it->second;
+}
+
+/**
+ * @param id The ID of the material.
+ * @throws OptiSimError If the ID is not valid.
+ */
+string MaterialCatalog::getName(int id) const{
+    shared_lock<shared_mutex> lock(mutex);
+    if (id < 0 || id >= names.size()) throw OptiSimError("ERROR: \tInvalid material ID: " + to_string(id));
+    return names[id];
+}
+
+/**
+ * @param id The ID of the material.
+ * @throws OptiSimError If the ID is not valid.
+ */
+shared_ptr<const DispersionModel> MaterialCatalog::getModel(int id) const{
+    shared_lock<shared_mutex> lock(mutex);
+    if (id < 0 || id >= models.size()) throw OptiSimError("ERROR: \tInvalid material ID: " + to_string(id));
+    return models[id];
+}
+
+/**
+ * @details This method returns the number of interned materials.
+ */
+int MaterialCatalog::size() const{
+    shared_lock<shared_mutex> lock(mutex);
+    return names.size();
+}
+
+/**
+ * @param id The ID of the material.
+ * @param wavelength The wavelength in micrometres.
+ * @throws OptiSimError If the ID is not valid or the wavelength is not positive.
+ */
+double MaterialCatalog::getIndex(int id, double wavelength){
+    double n;
+    getIndices(id, &wavelength, &n, 1);
+    return n;
+}
+
+/**
+ * @details The cached wavelengths are answered under a shared lock. The remaining ones are evaluated in
+ * one batch by the material's dispersion model, each distinct wavelength once, and then stored in the cache.
+ * @param id The ID of the material.
+ * @param wavelengths The wavelengths in micrometres.
+ * @param n The output array, receiving one refractive index per wavelength.
+ * @param count The number of wavelengths.
+ * @throws OptiSimError If the ID is not valid or a wavelength is not positive.
+ */
+void MaterialCatalog::getIndices(int id, const double* wavelengths, double* n, size_t count){
+    vector<size_t> misses;
+    shared_ptr<const DispersionModel> model;
+    {
+        shared_lock<shared_mutex> lock(mutex);
+        if (id < 0 || id >= models.size()) throw OptiSimError("ERROR: \tInvalid material ID: " + to_string(id));
+        model = models[id];
+        const unordered_map<uint64_t, double>& indices = cache[id];
+        for (size_t i = 0; i < count; i++) {
+            auto it = indices.find(wavelength_key(wavelengths[i]));
+            if (it != indices.end()) n[i] = it->second;
+            else misses.push_back(i);
+        }
+    }
+    if (misses.empty()) return;
+
+    // evaluate each distinct missing wavelength once
+    unordered_map<uint64_t, size_t> first;
+    vector<double> missing;
+    for (size_t i : misses) {
+        if (first.emplace(wavelength_key(wavelengths[i]), missing.size()).second) missing.push_back(wavelengths[i]);
+    }
+    vector<double> computed(missing.size());
+    model->getIndices(missing.data(), computed.data(), missing.size());
+    for (size_t i : misses) n[i] = computed[first[wavelength_key(wavelengths[i])]];
+
+    unique_lock<shared_mutex> lock(mutex);
+    for (size_t j = 0; j < missing.size(); j++) {
+        if (cache[id].emplace(wavelength_key(missing[j]), computed[j]).second) evaluations++;
+    }
+}
+
+/**
+ * @details This method returns the number of refractive indices that were computed and stored in the cache.
+ */
+long long MaterialCatalog::getEvaluations() const{
+    shared_lock<shared_mutex> lock(mutex);
+    return evaluations;
+}
+
+/**
+ * @details The materials stay interned; only the cached indices are dropped.
+ */
+void MaterialCatalog::clearCache(){
+    unique_lock<shared_mutex> lock(mutex);
+    for (auto& indices : cache) indices.clear();
+}
@@ -0,0 +1,82 @@
+/**
+* @file Mirror.cpp
+* @brief Implementation of the Mirror class for modeling spherical and plane mirrors.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "Mirror.h"
+#include <cmath>            // For std::isinf, std::abs
+#include "OptiSimError.h"   // Custom exception class
+
+using namespace std;
+
+/**
+ * @param x The position of the mirror vertex on the optical axis.
+ * @param r The radius of curvature, negative for a concave mirror; infinity for a plane mirror.
+ * @throws OptiSimError If the radius is zero.
+ */
+Mirror::Mirror(double x, double r):Lens(x, numeric_limits<double>::infinity()){
+    setR(r);
+}
+
+/**
+ * @details A plane mirror images every subject onto itself, as seen in the unfolded system. A spherical mirror
+ * uses the thin lens formula of `Lens::CalculateThin` with its focal length, so a subject in front of a concave
+ * mirror gives a real image in front of it, which the unfolded system places behind the mirror.
+ * @param is The subject to be imaged by the mirror.
+ */
+Image Mirror::Calculate(const ImagingSubject& is){
+    if (isinf(f)) return Image(is.getX(), is.getY(), is.getX() > x);
+    return CalculateThin(is);
+}
+
+/**
+ * @details Reflection does not depend on the wavelength, so every lane uses the same focal length; a spherical
+ * mirror images the lanes with `Lens::CalculateThinSpectrum`.
+ * @param x The subject positions on entry, the image positions on exit.
+ * @param y The subject heights on entry, the image heights on exit.
+ * @param real The real (1) or virtual (0) status of each image on exit.
+ * @param count The number of wavelengths.
+ */
+void Mirror::CalculateSpectrum(const double* /* wavelengths */, double* x, double* y, char* real, size_t count){
+    if (isinf(f)) {
+        for(size_t i = 0; i < count; i++) real[i] = x[i] > this->x;
+        return;
+    }
+    CalculateThinSpectrum(x, y, real, count);
+}
+
+/**
+ * @details In the unfolded system a mirror deflects the rays where they cross its vertex plane, like a thin lens;
+ * a plane mirror passes them on unchanged.
+ * @param x The x-coordinates of the rays.
+ * @param y The y-coordinates of the rays.
+ * @param z The z-coordinates of the rays.
+ * @param u The slopes dy/dx of the rays.
+ * @param v The slopes dz/dx of the rays.
+ * @param vignetted Set to 1 for every ray outside the aperture, 0 for the others.
+ * @param count The number of rays.
+ */
+void Mirror::TraceRays(double* x, double* y, double* z, double* u, double* v, char* vignetted, size_t count){
+    TracePrincipalPlanes(0, 0, f, x, y, z, u, v, vignetted, count);
+}
+
+/**
+ * @details This method returns the radius of curvature, which is infinite for a plane mirror.
+ */
+double Mirror::getR() const{
+    return r;
+}
+
+/**
+ * @details The focal length follows as `-r/2`, or infinity for a plane mirror.
+ * @param r The new radius of curvature.
+ * @throws OptiSimError If the radius is zero.
+ */
+void Mirror::setR(double r){
+    if (r == 0) throw OptiSimError("ERROR: \tThe radius of a mirror cannot be zero.");
+    this->r = r;
+    this->f = isinf(r) ? numeric_limits<double>::infinity() : -r / 2;
+}
@@ -0,0 +1,79 @@
+/**
+* @file NameTable.cpp
+* @brief Implements the NameTable class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "NameTable.h"
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+
+/**
+ * @details A new name takes the most recently released ID, or the next unused one if none was released.
+ * @param name The name to look up.
+ */
+int NameTable::intern(string_view name){
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+
+    int id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+        names[id] = name;
+    } else {
+        id = names.size();
+        names.emplace_back(name);
+    }
+    ids.emplace(names[id], id);
+    return id;
+}
+
+/**
+ * @param name The name to look up.
+ */
+int NameTable::find(string_view name) const{
+    auto it = ids.find(name);
+    return it == ids.end() ? -1 : it->second;
+}
+
+/**
+ * @param id The ID of the name.
+ * @throws OptiSimError If the ID is not in use.
+ */
+const string& NameTable::getName(int id) const{
+    if (id < 0 || id >= (int)names.size()) throw OptiSimError("ERROR: \tInvalid name ID: " + to_string(id));
+    return names[id];
+}
+
+/**
+ * @details The stored name is emptied; the ID is reused by the next new name.
+ * @param id The ID of the name.
+ * @throws OptiSimError If the ID is not in use.
+ */
+void NameTable::release(int id){
+    if (id < 0 || id >= (int)names.size() || find(names[id]) != id) throw OptiSimError("ERROR: \tInvalid name ID: " + to_string(id));
+    ids.erase(names[id]);
+    names[id].clear();
+    names[id].shrink_to_fit();
+    free_ids.push_back(id);
+}
+
+/**
+ * @details This method returns the number of IDs handed out, including the released ones.
+ */
+int NameTable::size() const{
+    return names.size();
+}
+
+/**
+ * @details Every name and ID is dropped; the next name gets the ID 0.
+ */
+void NameTable::clear(){
+    ids.clear();
+    names.clear();
+    free_ids.clear();
+}
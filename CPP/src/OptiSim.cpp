@@ -12,6 +12,8 @@
 #include <iostream>  // For standard input/output operations (cout, cerr)
 #include <vector>    // For using std::vector
 #include <iomanip>   // For formatting output (setw, setprecision)
+#include <sstream>   // For reading the systems of a stream line by line
+#include <chrono>    // For the latency of the watch cycles
 #include "OptiSim.h" // Main header for the OptiSim library components
 
 using namespace std;
@@ -42,10 +44,18 @@ void help(){
          << setw(22) << "--input=<json-file>"
          << "Specify the file from which to read the system." << endl;
 
+    cout << setw(18) << ""
+         << setw(22) << "--format=<format>"
+         << "Write the image list and the rays as text (default), json, csv or bin." << endl;
+
     cout << setw(18) << "-il"
          << setw(22) << "--imagelist"
          << "Expands the output with the image list." << endl;
 
+    cout << setw(18) << ""
+         << setw(22) << "--jsonl"
+         << "Read one system per line from stdin and write one JSON result per line to stdout." << endl;
+
     cout << setw(18) << "-o=<file>"
          << setw(22) << "--output=<file>"
          << "Specify the file in which to save the output." << endl;
@@ -58,9 +68,87 @@ void help(){
          << setw(22) << "--rays"
          << "Expands the output with the ray coordinates." << endl;
 
+    cout << setw(18) << "-s"
+         << setw(22) << "--stats"
+         << "Print the time spent in each phase and the event counters." << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--serve=<socket>"
+         << "Keep the system resident and answer JSON commands on a Unix socket." << endl;
+
+    cout << setw(18) << "-t=<json-file>"
+         << setw(22) << "--trace=<json-file>"
+         << "Record a timeline of the run and save it as a Chrome trace." << endl;
+
     cout << setw(18) << "-v"
          << setw(22) << "--version"
          << "Print version info." << endl;
+
+    cout << setw(18) << "-w"
+         << setw(22) << "--watch"
+         << "Recalculate and rewrite the output whenever the input file is saved." << endl;
+
+    cout << "\n\e[1mUsage\e[0m: OptiSim generate [OPTIONS]\n"
+         << "Writes a reproducible synthetic system of many thin and thick lenses.\n" << endl;
+
+    cout << setw(18) << "-n=<count>"
+         << setw(22) << "--count=<count>"
+         << "Number of lenses (default: 1000)." << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--seed=<seed>"
+         << "Seed of the random lens parameters (default: 1)." << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--spacing=<mm>"
+         << "Nominal distance between lenses (default: 10)." << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--thick=<fraction>"
+         << "Fraction of thick lenses (default: 0.5)." << endl;
+
+    cout << setw(18) << "-o=<json-file>"
+         << setw(22) << "--output=<json-file>"
+         << "Specify the file in which to save the system (default: generated.json)." << endl;
+
+    cout << "\n\e[1mUsage\e[0m: OptiSim batch [OPTIONS] [<json-file>...]\n"
+         << "Evaluates many systems concurrently and prints the throughput. Inputs can be combined.\n" << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--dir=<directory>"
+         << "Add every .json file of a directory." << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--glob=<pattern>"
+         << "Add every file matching a pattern, e.g. \"runs/sys_*.json\"." << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--manifest=<file>"
+         << "Add the files listed in a manifest, one per line." << endl;
+
+    cout << setw(18) << "-j=<threads>"
+         << setw(22) << "--jobs=<threads>"
+         << "Number of worker threads (default: all hardware threads)." << endl;
+
+    cout << setw(18) << "-d=<directory>"
+         << setw(22) << "--outdir=<directory>"
+         << "Write one report per input into a directory, named after the input." << endl;
+
+    cout << setw(18) << "-o=<file>"
+         << setw(22) << "--output=<file>"
+         << "Write all reports, in input order, into one file (default: output.txt)." << endl;
+
+    cout << setw(18) << "-il"
+         << setw(22) << "--imagelist"
+         << "Expands the reports with the image list." << endl;
+
+    cout << setw(18) << "-r"
+         << setw(22) << "--rays"
+         << "Expands the reports with the ray coordinates." << endl;
+
+    cout << setw(18) << ""
+         << setw(22) << "--format=<format>"
+         << "Write the reports as text (default), or as json, csv or bin with --outdir." << endl;
 }
 
 /**
@@ -92,6 +180,149 @@ command_path split(string S) {
     return return_box;
 }
 
+/**
+ * @brief Runs the `generate` subcommand, which writes a synthetic system to a JSON file.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments; `argv[1]` is "generate".
+ * @throws OptiSimError If an option is unknown or has an invalid value.
+ */
+void generate(int argc, char* argv[]){
+    long long count = 1000;
+    string output_file = "./generated.json";
+    SystemGenerator generator;
+    for (int i = 2; i < argc; ++i){
+        command_path splitted = split(argv[i]);
+        try {
+            if (splitted.command == "-n" || splitted.command == "--count") count = stoll(splitted.file);
+            else if (splitted.command == "--seed") generator.setSeed(stoull(splitted.file));
+            else if (splitted.command == "--spacing") generator.setSpacing(stod(splitted.file));
+            else if (splitted.command == "--thick") generator.setThickFraction(stod(splitted.file));
+            else if ((splitted.command == "-o" || splitted.command == "--output") && splitted.file != "") output_file = splitted.file;
+            else throw OptiSimError("Check help for correct usage:  OptiSim --help");
+        } catch (logic_error&) {
+            throw OptiSimError("ERROR: \tInvalid value: " + string(argv[i]));
+        }
+    }
+    generator.write(output_file, count);
+}
+
+/**
+ * @brief Runs the streaming mode, which reads one system per line from the standard input and writes one JSON result per line.
+ *
+ * Each line holds a system in the format of the system files. Its result is written, and flushed, before the next
+ * line is read, so the memory use depends on the largest system and not on the length of the stream. A line that
+ * cannot be loaded or calculated is answered by `{"error": "..."}`; empty lines are skipped.
+ *
+ * @param image_list True to add the image list to the results.
+ * @param rays True to add the ray coordinates to the results.
+ */
+void stream(bool image_list, bool rays){
+    string line;
+    istringstream line_stream;
+    while (getline(cin, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        try {
+            line_stream.clear();
+            line_stream.str(line);
+            OpticalSystem system(line_stream);
+            system.Calculate();
+            Report::writeJson(system, cout, image_list, rays);
+        } catch (exception& e) {
+            Report::writeJsonError(e.what(), cout);
+        }
+        cout.flush();
+    }
+}
+
+/**
+ * @brief Runs the watch mode, which recalculates a system file every time it is saved.
+ *
+ * The file is read once at the start and again after each change reported by a `FileWatcher`. The new system is
+ * merged into the resident one with `OpticalSystem::update`, so only the elements that changed are rebuilt, then
+ * it is calculated and the output file is rewritten. Every cycle prints its latency; a cycle that fails prints the
+ * error and the watch goes on with the next change. The watch runs until the process is interrupted.
+ *
+ * @param input_file The system file to watch.
+ * @param output_file The file to rewrite after every change.
+ * @param image_list True to add the image list to the output.
+ * @param rays True to add the ray coordinates to the output.
+ * @param format The format of the output.
+ * @param print True to print the system to the console after every change.
+ * @throws OptiSimError If the directory of the input file cannot be watched.
+ */
+void watch(const string& input_file, const string& output_file, bool image_list, bool rays, report_format format, bool print){
+    typedef chrono::steady_clock clock;
+    auto ms = [](clock::time_point from, clock::time_point to){ return chrono::duration<double, milli>(to - from).count(); };
+
+    FileWatcher watcher(input_file);
+    OpticalSystem resident;
+    cout << "Watching " << input_file << endl;
+    do {
+        try {
+            clock::time_point start = clock::now();
+            OpticalSystem parsed(input_file);
+            clock::time_point parse_end = clock::now();
+            int changed = resident.update(parsed);
+            clock::time_point update_end = clock::now();
+            resident.Calculate();
+            clock::time_point calculate_end = clock::now();
+            ofstream outputFile(output_file, format == FORMAT_BINARY ? ios::out | ios::binary : ios::out);
+            Report::write(resident, outputFile, image_list, rays, format);
+            outputFile.close();
+            clock::time_point end = clock::now();
+
+            if (print) resident.toString();
+            cout << fixed << setprecision(3)
+                 << "Updated " << output_file << ": " << changed << " changed element(s), "
+                 << "parse " << ms(start, parse_end) << " ms, update " << ms(parse_end, update_end) << " ms, "
+                 << "calculate " << ms(update_end, calculate_end) << " ms, output " << ms(calculate_end, end) << " ms, "
+                 << "total " << ms(start, end) << " ms" << endl;
+        } catch (exception& e) {
+            cout << e.what() << endl;
+        }
+    } while (watcher.wait());
+}
+
+/**
+ * @brief Runs the `batch` subcommand, which evaluates many system files and prints the throughput.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments; `argv[1]` is "batch".
+ * @throws OptiSimError If an option is unknown or has an invalid value, or if an input directory does not exist.
+ */
+void batch(int argc, char* argv[]){
+    BatchRunner runner;
+    runner.setAggregateOutput("./output.txt");
+    for (int i = 2; i < argc; ++i){
+        command_path splitted = split(argv[i]);
+        try {
+            if (string(argv[i]) == "-il" || string(argv[i]) == "--imagelist") runner.setImageList(true);
+            else if (string(argv[i]) == "-r" || string(argv[i]) == "--rays") runner.setRays(true);
+            else if (splitted.command == "--format") runner.setFormat(Report::parseFormat(splitted.file));
+            else if (splitted.command == "--dir" && splitted.file != "") runner.addDirectory(splitted.file);
+            else if (splitted.command == "--glob" && splitted.file != "") runner.addGlob(splitted.file);
+            else if (splitted.command == "--manifest" && splitted.file != "") runner.addManifest(splitted.file);
+            else if (splitted.command == "-j" || splitted.command == "--jobs") runner.setThreads(stoi(splitted.file));
+            else if ((splitted.command == "-d" || splitted.command == "--outdir") && splitted.file != "") runner.setOutputDirectory(splitted.file);
+            else if ((splitted.command == "-o" || splitted.command == "--output") && splitted.file != "") runner.setAggregateOutput(splitted.file);
+            else if (argv[i][0] != '-') runner.addInput(argv[i]);
+            else throw OptiSimError("Check help for correct usage:  OptiSim --help");
+        } catch (logic_error&) {
+            throw OptiSimError("ERROR: \tInvalid value: " + string(argv[i]));
+        }
+    }
+    if (runner.getInputs().empty()) throw OptiSimError("ERROR: \tNo input systems were given.");
+
+    batch_result result = runner.run();
+    for (const string& error : result.errors) cout << error << "\n";
+    cout << fixed << setprecision(3)
+         << "Processed " << result.inputs << " systems (" << result.failed << " failed, "
+         << result.elements << " elements) in " << result.elapsed_seconds << " s\n"
+         << setprecision(1) << "Throughput: " << result.systems_per_second << " systems/s, "
+         << result.elements_per_second << " elements/s" << endl;
+}
+
 /**
  * @brief The main entry point of the OptiSim application.
  *
@@ -110,6 +341,11 @@ int main(int argc, char* argv[]){
         bool should_I_calc = true;
         bool should_I_print_il = false;
         bool should_I_print_rays = false;
+        bool should_I_print_stats = false;
+        string serve_socket = "";
+        bool should_I_stream = false;
+        bool should_I_watch = false;
+        report_format output_format = FORMAT_TEXT;
     	if (argc < 2) {
     		throw OptiSimError("\033[1mDescription\033[0m: By default, this tool reads an "
                         "optical system from a file called \"input.json\" and "
@@ -119,6 +355,16 @@ int main(int argc, char* argv[]){
                         );
 	    }
 
+        if (string(argv[1]) == "generate") {
+            generate(argc, argv);
+            return 0;
+        }
+
+        if (string(argv[1]) == "batch") {
+            batch(argc, argv);
+            return 0;
+        }
+
 	    for (int i = 1; i < argc; ++i){
             command_path splitted = split(argv[i]);
             if (string(argv[i]) == "-h" || string(argv[i]) == "--help"){
@@ -136,9 +382,18 @@ int main(int argc, char* argv[]){
             } else if (string(argv[i]) == "-r" || string(argv[i]) == "--rays"){
                 should_I_print_rays = true;
 
+            } else if (string(argv[i]) == "-s" || string(argv[i]) == "--stats"){
+                should_I_print_stats = true;
+
             } else if (string(argv[i]) == "-il" || string(argv[i]) == "--imagelist"){
                 should_I_print_il = true;
 
+            } else if (string(argv[i]) == "--jsonl"){
+                should_I_stream = true;
+
+            } else if (string(argv[i]) == "-w" || string(argv[i]) == "--watch"){
+                should_I_watch = true;
+
             } else if (splitted.command == "-i" || splitted.command == "--input"){
                 if (splitted.file == "") throw OptiSimError("Check help for correct usage:  OptiSim --help");
                 input_file = splitted.file;
@@ -146,65 +401,49 @@ int main(int argc, char* argv[]){
             } else if (splitted.command == "-o" || splitted.command == "--output"){
                 if (splitted.file == "") throw OptiSimError("Check help for correct usage:  OptiSim --help");
                 output_file = splitted.file;
+
+            } else if (splitted.command == "--format"){
+                output_format = Report::parseFormat(splitted.file);
+
+            } else if (splitted.command == "--serve"){
+                if (splitted.file == "") throw OptiSimError("Check help for correct usage:  OptiSim --help");
+                serve_socket = splitted.file;
+
+            } else if (splitted.command == "-t" || splitted.command == "--trace"){
+                if (splitted.file == "") throw OptiSimError("Check help for correct usage:  OptiSim --help");
+                Trace::writeAtExit(splitted.file);
             }
 	    }
-        if (should_I_calc) {
+        if (serve_socket != "") {
+            // keep the input system resident, if there is one, and serve until shut down
+            SimulationServer server;
+            if (ifstream(input_file).good()) server.load("default", input_file);
+            cout << "Serving on " << serve_socket << endl;
+            server.serve(serve_socket);
+
+        } else if (should_I_stream) {
+            stream(should_I_print_il, should_I_print_rays);
+
+        } else if (should_I_watch) {
+            watch(input_file, output_file, should_I_print_il, should_I_print_rays, output_format, should_I_print);
+
+        } else if (should_I_calc) {
             // instantiate an Optical System object using a .json file
             OpticalSystem my_system(input_file);
             
             // calculate the system's imaging and print the system into the console
             Image final_image = my_system.Calculate();
 
-            // save the output information into a file
-            ofstream outputFile(output_file);
-            my_system.toString(outputFile);
+            // save the output information into a file, expanded with the image list and the rays if requested
+            ofstream outputFile(output_file, output_format == FORMAT_BINARY ? ios::out | ios::binary : ios::out);
+            Report::write(my_system, outputFile, should_I_print_il, should_I_print_rays, output_format);
 
             // print the optical system parameters and result on the console
             if (should_I_print) my_system.toString();
-
-            // expands the output file with the image list
-            if (should_I_print_il) {
-                vector<Image> imageSequence = my_system.getImageSequence();
-                vector<Image>::iterator it;
-                outputFile << "#\tImages"
-                << "\n-------------------------------------------------------------------------------\n";
-                outputFile << left
-                           << setw(15) << "X coordinate"
-                           << setw(15) << "Y coordinate"
-                           << "Is real?" << "\n\n";
-
-                for (it = imageSequence.begin(); it < imageSequence.end(); ++it) {
-                    outputFile << right << fixed << setprecision(6)
-                               << setw(12) << (*it).getX()
-                               << setw(15) << (*it).getY()
-                               << setw(10) << setprecision(1) << (*it).getReal()
-                               << "\n";
-                }
-                outputFile << "\n-------------------------------------------------------------------------------\n";
-            }
-            if (should_I_print_rays){
-                map<string, ray> rays = my_system.getRays();
-                outputFile << "#\tRays"
-                << "\n-------------------------------------------------------------------------------\n";
-                outputFile << right
-                           << setw(16) << "Ray 1"
-                           << setw(30) << "Ray 2"<< "\n\n";
-                outputFile << left
-                           << setw(15) << "X coordinate"
-                           << setw(15) << "Y coordinate"
-                           << setw(15) << "X coordinate"
-                           << setw(15) << "Y coordinate"<< "\n\n";
-                for (int i =0; i<rays["ray_1"].x.size(); i++){
-                    outputFile << right << fixed << setprecision(6)
-                               << setw(12) << rays["ray_1"].x[i]
-                               << setw(15) << rays["ray_1"].y[i]
-                               << setw(15) << rays["ray_2"].x[i]
-                               << setw(15) << rays["ray_2"].y[i]
-                               << "\n";
-                }
-                outputFile << "\n-------------------------------------------------------------------------------\n";
-            }
         }
+
+        // print the timings and counters of the run
+        if (should_I_print_stats) Instrumentation::report();
     	
     }catch(exception& e) // Catch any standard exception or custom OptiSimError
     {
@@ -0,0 +1,130 @@
+/**
+* @file OptiSimClient.cpp
+* @brief A command-line client for the OptiSim simulation server.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*
+* Connects to a server started with `OptiSim --serve=<socket>`, sends every line of the standard input as a
+* request and prints every response. With `--bench=<count>` it instead sends `count` calculate commands one
+* after another and prints the request latency.
+*
+* Usage: `OptiSimClient <socket> [--system=<name>] [--bench=<count>]`
+*/
+
+#include <iostream>     // For standard input/output operations
+#include <iomanip>      // For formatting output (setprecision)
+#include <string>       // For requests and responses
+#include <vector>       // For the latencies
+#include <algorithm>    // For std::sort
+#include <chrono>       // For timing requests
+#include <cstring>      // For std::strerror
+#include <cerrno>       // For errno
+#include <unistd.h>     // For read, write, close
+#include <sys/socket.h> // For the connection
+#include <sys/un.h>     // For Unix socket addresses
+#include <nlohmann/json.hpp> // Assumes nlohmann/json library is installed
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * @brief Sends a whole request line.
+ * @return False if the connection was lost.
+ */
+bool send_line(int fd, const string& line){
+    string data = line + "\n";
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+/**
+ * @brief Receives one response line.
+ * @param fd The connected socket.
+ * @param buffer The bytes received after the previous line; updated.
+ * @param line Receives the response, without the newline.
+ * @return False if the connection was closed before a complete line arrived.
+ */
+bool receive_line(int fd, string& buffer, string& line){
+    size_t end;
+    char chunk[65536];
+    while ((end = buffer.find('\n')) == string::npos) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0) return false;
+        buffer.append(chunk, n);
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+/**
+ * @brief Main function of the client.
+ * @return 0 on success, 1 on invalid arguments or a lost connection.
+ */
+int main(int argc, char* argv[]){
+    if (argc < 2) {
+        cerr << "Usage: OptiSimClient <socket> [--system=<name>] [--bench=<count>]\n";
+        return 1;
+    }
+    string socket_path = argv[1];
+    string system = "default";
+    long long bench = 0;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--system=", 0) == 0) system = arg.substr(9);
+        else if (arg.rfind("--bench=", 0) == 0) bench = atoll(arg.c_str() + 8);
+        else {
+            cerr << "ERROR: \tInvalid argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) < 0) {
+        cerr << "ERROR: \tFailed to connect to " << socket_path << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    string buffer, response;
+    if (bench > 0) {
+        string request = json{{"cmd", "calculate"}, {"system", system}}.dump();
+        vector<double> latencies;
+        for (long long i = 0; i < bench; i++) {
+            auto start = chrono::steady_clock::now();
+            if (!send_line(fd, request) || !receive_line(fd, buffer, response)) {
+                cerr << "ERROR: \tThe connection was closed.\n";
+                return 1;
+            }
+            latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+        }
+        sort(latencies.begin(), latencies.end());
+        double total = 0;
+        for (double latency : latencies) total += latency;
+        cout << fixed << setprecision(1) << "Requests: " << bench << "\n"
+             << "Mean latency: " << total / bench << " us\n"
+             << "Median latency: " << latencies[latencies.size() / 2] << " us\n"
+             << "99th percentile: " << latencies[latencies.size() * 99 / 100] << " us\n"
+             << "Last response: " << response << endl;
+    } else {
+        string line;
+        while (getline(cin, line)) {
+            if (line.empty()) continue;
+            if (!send_line(fd, line) || !receive_line(fd, buffer, response)) {
+                cerr << "ERROR: \tThe connection was closed.\n";
+                return 1;
+            }
+            cout << response << endl;
+        }
+    }
+    close(fd);
+    return 0;
+}
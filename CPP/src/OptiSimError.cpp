@@ -6,13 +6,17 @@
 * @date 2025-06-09
 */
 #include "OptiSimError.h"
+#include "Instrumentation.h" // Counts the exceptions
 
 /**
  * @details This constructor initializes the exception with a specific error message.
- * The provided string `msg` is copied into the `message` member variable.
+ * The provided string `msg` is copied into the `message` member variable, and the exception is counted
+ * by the `exceptions` counter of the instrumentation layer.
  * @param msg A constant reference to a string containing the detailed error message.
  */
-OptiSimError::OptiSimError(const string& msg):message(msg){}
+OptiSimError::OptiSimError(const string& msg):message(msg){
+    OPTISIM_COUNT(COUNTER_EXCEPTIONS, 1);
+}
 
 /**
  * @details This method overrides the `std::exception::what()` method to provide a C-style string
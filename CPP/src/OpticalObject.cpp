@@ -7,6 +7,10 @@
 */
 
 #include "OpticalObject.h"
+#include <cmath>            // For std::cos, std::sin
+#include <limits>           // For the unlimited aperture
+#include "OptiSimError.h"   // Custom exception class
+
 using namespace std;
 
 /**
@@ -15,12 +19,17 @@ using namespace std;
  */
 OpticalObject::OpticalObject(double x){
     this->x = x;
+    this->y = 0;
+    this->z = 0;
+    this->tilt_y = 0;
+    this->tilt_z = 0;
+    this->aperture = numeric_limits<double>::infinity();
 }
 
 /**
  * @details This method returns the current x-coordinate (position) of the optical object.
  */
-double OpticalObject::getX(){
+double OpticalObject::getX() const{
     return x; 
 }
 
@@ -31,3 +40,226 @@ double OpticalObject::getX(){
 void OpticalObject::setX(double x){
     this->x = x;
 }
+
+/**
+ * @details This method returns the distance of the object's axis from the optical axis along y.
+ */
+double OpticalObject::getY() const{
+    return y;
+}
+
+/**
+ * @param y The new decentering along the y axis.
+ */
+void OpticalObject::setY(double y){
+    this->y = y;
+}
+
+/**
+ * @details This method returns the distance of the object's axis from the optical axis along z.
+ */
+double OpticalObject::getZ() const{
+    return z;
+}
+
+/**
+ * @param z The new decentering along the z axis.
+ */
+void OpticalObject::setZ(double z){
+    this->z = z;
+}
+
+/**
+ * @details This method returns the tilt of the object about the y axis in degrees.
+ */
+double OpticalObject::getTiltY() const{
+    return tilt_y;
+}
+
+/**
+ * @param tilt_y The new tilt in degrees.
+ * @throws OptiSimError If the tilt is not strictly between -90 and 90 degrees.
+ */
+void OpticalObject::setTiltY(double tilt_y){
+    if (!(abs(tilt_y) < 90)) throw OptiSimError("ERROR: \tThe tilt must be between -90 and 90 degrees.");
+    this->tilt_y = tilt_y;
+}
+
+/**
+ * @details This method returns the tilt of the object about the z axis in degrees.
+ */
+double OpticalObject::getTiltZ() const{
+    return tilt_z;
+}
+
+/**
+ * @param tilt_z The new tilt in degrees.
+ * @throws OptiSimError If the tilt is not strictly between -90 and 90 degrees.
+ */
+void OpticalObject::setTiltZ(double tilt_z){
+    if (!(abs(tilt_z) < 90)) throw OptiSimError("ERROR: \tThe tilt must be between -90 and 90 degrees.");
+    this->tilt_z = tilt_z;
+}
+
+/**
+ * @details This method returns the radius of the clear aperture, which is infinite unless it was set.
+ */
+double OpticalObject::getAperture() const{
+    return aperture;
+}
+
+/**
+ * @param aperture The new radius; infinity removes the limit.
+ * @throws OptiSimError If the radius is not positive.
+ */
+void OpticalObject::setAperture(double aperture){
+    if (!(aperture > 0)) throw OptiSimError("ERROR: \tThe aperture radius must be a positive number.");
+    this->aperture = aperture;
+}
+
+/**
+ * @details Centered objects are calculated with the on-axis formulas; the others need the off-axis ones.
+ */
+bool OpticalObject::isCentered() const{
+    return y == 0 && z == 0 && tilt_y == 0 && tilt_z == 0;
+}
+
+/**
+ * @details The rows of the matrix are the unit vectors of the object's frame: its axis, its local y axis
+ * (perpendicular to the axis, in the plane of the global x and y axes) and its local z axis.
+ * A point `p` has the local coordinates `axes * (p - (x, y, z))`.
+ * @param axes The output matrix.
+ */
+void OpticalObject::getAxes(double axes[3][3]) const{
+    const double degree = acos(-1.0) / 180;
+    double ca = cos(tilt_z * degree), sa = sin(tilt_z * degree);
+    double cb = cos(tilt_y * degree), sb = sin(tilt_y * degree);
+    axes[0][0] = ca * cb;  axes[0][1] = sa * cb;  axes[0][2] = sb;
+    axes[1][0] = -sa;      axes[1][1] = ca;       axes[1][2] = 0;
+    axes[2][0] = -ca * sb; axes[2][1] = -sa * sb; axes[2][2] = cb;
+}
+
+/**
+ * @details This is the ray tracing kernel shared by the lenses, which all act as an ideal thin lens placed between
+ * their principal planes: a ray is carried to the first principal plane, deflected by the power of the element,
+ * and leaves the second principal plane at the same height. The planes are given relative to the position `x`
+ * along the object's own axis. A ray is vignetted if its height above the axis at the first principal plane
+ * exceeds the aperture radius; it is traced like the others, and the caller decides what to do with it.
+ *
+ * A centered object uses a short loop in global coordinates. Otherwise each ray is first expressed in the
+ * object's frame and transformed back afterwards. Both loops are branch-free passes over the arrays, so
+ * the compiler can vectorize them.
+ * @param h_in The position of the first principal plane, relative to `x`.
+ * @param h_out The position of the second principal plane, relative to `x`.
+ * @param f The focal length; infinite for an element without power.
+ * @param px The x-coordinates of the rays.
+ * @param py The y-coordinates of the rays.
+ * @param pz The z-coordinates of the rays.
+ * @param u The slopes dy/dx of the rays.
+ * @param v The slopes dz/dx of the rays.
+ * @param vignetted Set to 1 for every ray outside the aperture, 0 for the others.
+ * @param count The number of rays.
+ */
+void OpticalObject::TracePrincipalPlanes(double h_in, double h_out, double f, double* px, double* py, double* pz,
+                                         double* u, double* v, char* vignetted, size_t count) const{
+    const double power = 1.0 / f;
+    const double limit = aperture * aperture;
+
+    if (isCentered()) {
+        const double x_in = x + h_in;
+        const double x_out = x + h_out;
+        for (size_t i = 0; i < count; i++) {
+            double y_h = py[i] + (x_in - px[i]) * u[i];
+            double z_h = pz[i] + (x_in - px[i]) * v[i];
+            px[i] = x_out;
+            py[i] = y_h;
+            pz[i] = z_h;
+            u[i] -= y_h * power;
+            v[i] -= z_h * power;
+            vignetted[i] = y_h * y_h + z_h * z_h > limit;
+        }
+        return;
+    }
+
+    double a[3][3];
+    getAxes(a);
+    // the matrix is copied to scalars so the loop body only works on registers
+    const double a00 = a[0][0], a01 = a[0][1], a02 = a[0][2];
+    const double a10 = a[1][0], a11 = a[1][1], a12 = a[1][2];
+    const double a20 = a[2][0], a21 = a[2][1], a22 = a[2][2];
+    const double cx = x, cy = y, cz = z;
+    for (size_t i = 0; i < count; i++) {
+        // the point and the direction in the object's frame
+        double qx = px[i] - cx, qy = py[i] - cy, qz = pz[i] - cz;
+        double lx = a00 * qx + a01 * qy + a02 * qz;
+        double ly = a10 * qx + a11 * qy + a12 * qz;
+        double lz = a20 * qx + a21 * qy + a22 * qz;
+        double inv = 1.0 / (a00 + a01 * u[i] + a02 * v[i]);
+        double du = (a10 + a11 * u[i] + a12 * v[i]) * inv;
+        double dv = (a20 + a21 * u[i] + a22 * v[i]) * inv;
+
+        // through the principal planes
+        double y_h = ly + (h_in - lx) * du;
+        double z_h = lz + (h_in - lx) * dv;
+        du -= y_h * power;
+        dv -= z_h * power;
+        vignetted[i] = y_h * y_h + z_h * z_h > limit;
+
+        // back to global coordinates
+        double gx = 1.0 / (a00 + a10 * du + a20 * dv);
+        px[i] = cx + a00 * h_out + a10 * y_h + a20 * z_h;
+        py[i] = cy + a01 * h_out + a11 * y_h + a21 * z_h;
+        pz[i] = cz + a02 * h_out + a12 * y_h + a22 * z_h;
+        u[i] = (a01 + a11 * du + a21 * dv) * gx;
+        v[i] = (a02 + a12 * du + a22 * dv) * gx;
+    }
+}
+
+/**
+ * @details The default implementation is for elements that do not depend on the wavelength: it calls
+ * `Calculate` once per lane, ignoring the wavelengths. Derived classes override it with a loop over the arrays.
+ * @param x The subject positions on entry, the image positions on exit.
+ * @param y The subject heights on entry, the image heights on exit.
+ * @param real The real (1) or virtual (0) status of each image on exit.
+ * @param count The number of wavelengths.
+ */
+void OpticalObject::CalculateSpectrum(const double* /* wavelengths */, double* x, double* y, char* real, size_t count){
+    for(size_t i = 0; i < count; i++){
+        Image img = Calculate(LightSource(x[i], y[i]));
+        x[i] = img.getX();
+        y[i] = img.getY();
+        real[i] = img.getReal();
+    }
+}
+
+/**
+ * @details The subject is expressed in the object's frame, imaged there by `Calculate` and transformed back.
+ * The image heights along both local axes follow from the lateral magnification, which `Calculate` gives for a
+ * unit subject height, because an ideal element images every point of a plane with the same magnification.
+ * For a centered object this gives the same image as `Calculate`, with the z-coordinate scaled like y.
+ * @param is The subject to image.
+ * @return The image, with its z-coordinate set.
+ */
+Image OpticalObject::CalculateOffAxis(const ImagingSubject& is){
+    double a[3][3];
+    getAxes(a);
+    double qx = is.getX() - x, qy = is.getY() - y, qz = is.getZ() - z;
+    double lx = a[0][0] * qx + a[0][1] * qy + a[0][2] * qz;
+    double ly = a[1][0] * qx + a[1][1] * qy + a[1][2] * qz;
+    double lz = a[2][0] * qx + a[2][1] * qy + a[2][2] * qz;
+
+    Image unit = Calculate(LightSource(x + lx, 1));
+    double ix = unit.getX() - x;
+    double iy = unit.getY() * ly;
+    double iz = unit.getY() * lz;
+
+    return Image(x + a[0][0] * ix + a[1][0] * iy + a[2][0] * iz,
+                 y + a[0][1] * ix + a[1][1] * iy + a[2][1] * iz,
+                 unit.getReal(),
+                 z + a[0][2] * ix + a[1][2] * iy + a[2][2] * iz);
+}
+
+/**
+ * @details The destructor is virtual so that the `OpticalSystem` can delete elements through base class pointers.
+ */
+OpticalObject::~OpticalObject(){}
\ No newline at end of file
@@ -10,9 +10,15 @@
 #include <iostream>
 #include <fstream>
 #include <nlohmann/json.hpp> // Assumes nlohmann/json library is installed
-#include <typeinfo>          // For dynamic_cast type checking
 #include <cmath>             // For abs()
+#include <limits>            // For the NaN of missing parameters
+#include <filesystem>        // For resolving the glass catalog path
 #include "OptiSimError.h"    // Custom exception class
+#include "MaterialCatalog.h" // Shared table of named materials
+#include "ElementRegistry.h" // The type-specific work on the elements
+#include "Instrumentation.h" // Per-phase timers and counters
+#include "Trace.h"           // Timeline spans
+#include "OutputWriter.h"    // Fast formatting of the summary
 
 
 using namespace std;
@@ -22,119 +28,182 @@ using json = nlohmann::json;
 // Constructors ---------------------------------------------------------------
 /**
  * @details This default constructor initializes the LightSource pointer to `nullptr`, indicating no light source is currently part of the system.
+ * @param resource The resource from which the element pool draws its memory; it must outlive the system.
  */
-OpticalSystem::OpticalSystem(){
+OpticalSystem::OpticalSystem(pmr::memory_resource* resource) : pool(resource){
 	LS = nullptr;
+	pupils_valid = false;
 };
 
 /**
  * @details This constructor loads the optical system configuration from a specified JSON file.
  * It reads the light source and various lens types (thin or thick) and adds them to the system.
  * @param file_name The path to the JSON configuration file.
- * @throws OptiSimError If the file cannot be opened, or if there's a JSON parsing error.
+ * @param resource The resource from which the element pool draws its memory; it must outlive the system.
+ * @throws OptiSimError If the file cannot be opened, if there's a JSON parsing error, or if a required entry is missing or has the wrong type.
  */
-OpticalSystem::OpticalSystem(string file_name){
-	// Read datafrom .json file
-    ifstream file(file_name);
-    
-    if (!file.is_open()) throw OptiSimError("ERROR: \t Failed to open file: "+file_name);
+OpticalSystem::OpticalSystem(const string& file_name, pmr::memory_resource* resource) : pool(resource){
+	OPTISIM_TRACE_SCOPE("load");
+	LS = nullptr;
+	pupils_valid = false;
+	ifstream file(file_name);
+	if (!file.is_open()) throw OptiSimError("ERROR: \t Failed to open file: "+file_name);
+	read(file, file_name, filesystem::path(file_name).parent_path().string());
+};
+
+/**
+ * @details This constructor reads one JSON document, in the format of the system files, from a stream and
+ * leaves the stream positioned after it, so consecutive systems can be read from the same stream.
+ * A relative glass catalog path is resolved against the working directory.
+ * @param is The input stream.
+ * @param resource The resource from which the element pool draws its memory; it must outlive the system.
+ * @throws OptiSimError If there's a JSON parsing error, or if a required entry is missing or has the wrong type.
+ */
+OpticalSystem::OpticalSystem(istream& is, pmr::memory_resource* resource) : pool(resource){
+	OPTISIM_TRACE_SCOPE("load");
+	LS = nullptr;
+	pupils_valid = false;
+	read(is, "<stream>", "");
+};
 
+/**
+ * @details The elements are added as they are read; if reading fails, the elements added so far are released.
+ * @param is The input stream holding the JSON document.
+ * @param source The name of the input, used in error messages.
+ * @param directory The directory against which a relative glass catalog path is resolved.
+ * @throws OptiSimError If there's a JSON parsing error, or if a required entry is missing or has the wrong type.
+ */
+void OpticalSystem::read(istream& is, const string& source, const string& directory){
+	// Read data from the json document
     json data;
-    try {
-        file >> data;
-    } catch (json::parse_error& e) {
-		throw OptiSimError("ERROR: \tJSON parse error: " + string(e.what()));
+    {
+        OPTISIM_TIME_SCOPE(PHASE_PARSE);
+        try {
+            is >> data;
+        } catch (json::parse_error& e) {
+            throw OptiSimError("ERROR: \tJSON parse error: " + string(e.what()));
+        }
     }
 
-    // Extract information
-    // Object info
-    LightSource light_source_readout(data["object"]["position"],
-    								 data["object"]["size"]);
-    add(light_source_readout);
+    try {
+        // Extract information
+        // Glass catalog, resolved relative to the directory of the system
+        if (data.contains("glass_catalog")) {
+            filesystem::path catalog_path(data["glass_catalog"].get<string>());
+            if (catalog_path.is_relative()) catalog_path = filesystem::path(directory) / catalog_path;
+            glass_catalog = filesystem::absolute(catalog_path).lexically_normal().string();
+            MaterialCatalog::global().load(glass_catalog);
+        }
+
+        // Object info
+        LightSource light_source_readout(data["object"]["position"],
+        								 data["object"]["size"],
+        								 data["object"].value("size_z", 0.0));
+        add(light_source_readout);
     
     
-    for (const auto& lens : data["lenses"]) {
-        string type = lens.value("type", "thin");
-        
-
-        if (type == "thin") {
-            ThinLens thinl = ThinLens(lens["position"], lens["focal_length"]);
-            add(thinl, lens["name"]);
-
-        } else if (type == "thick") {
-            ThickLens thickl = ThickLens(lens["position"],
-							  lens["refractive_index"],
-							  lens["thickness"],
-							  lens["radius_left"],
-							  lens["radius_right"]);
-            add(thickl, lens["name"]);
+        for (const auto& lens : data["lenses"]) {
+            const element_class* type = ElementRegistry::global().find(lens.value("type", "thin"));
+            if (type) add(*ElementRegistry::read(*type, lens), lens.at("name").get_ref<const string&>());
         }
-    }   
-};
+    } catch (exception& e) {
+        // the destructor does not run when a constructor throws, so release the elements added so far
+        for (int id : order) pool.destroy(elements[id]);
+        elements.clear();
+        names.clear();
+        order.clear();
+        pool.destroy(LS);
+        LS = nullptr;
+
+        // a missing or mistyped entry
+        if (dynamic_cast<json::exception*>(&e)) throw OptiSimError("ERROR: \tInvalid system file " + source + ": " + string(e.what()));
+        throw;
+    }
+}
 
 // Adding methods -------------------------------------------------------------
 
 /**
  * @details This method adds an `OpticalObject` (like a `ThinLens` or `ThickLens`) to the system,
  * managing its memory and ensuring it's added in the correct optical order based on its x-position.
+ * The insertion point is found by binary search over the ordered elements.
  * It also performs checks for duplicate names and minimum distances between objects.
+ * The name is interned, so the system keeps a single copy of it.
  * @param OO_object A reference to the `OpticalObject` to be added.
  * @param OO_name A unique string identifier for the optical object.
  * @throws OptiSimError If the chosen name is already taken, or if the object is too close to an existing light source or another optical object.
  */
-void OpticalSystem::add(OpticalObject& OO_object, string OO_name){
-	if(name_lens_map.find(OO_name) != name_lens_map.end()) throw OptiSimError("ERROR: \tThe key is taken, please chose another.");
-	if(LS != nullptr){
-		if(abs(OO_object.getX() - LS->getX()) < 0.001)throw OptiSimError("ERROR: \tThe Light Source and the Optical Object are too close together. The minimum distance must be at least 0.001 mm");
-	}
-	ThinLens* ptr_thin = dynamic_cast<ThinLens*>(&OO_object);
-	ThickLens* ptr_thick = dynamic_cast<ThickLens*>(&OO_object);
+void OpticalSystem::add(OpticalObject& OO_object, string_view OO_name){
+	OPTISIM_TIME_SCOPE(PHASE_ADD);
+	pupils_valid = false;
+	if(names.find(OO_name) >= 0) throw OptiSimError("ERROR: \tThe key is taken, please chose another.");
+	size_t index = findSlot(OO_object.getX());
 
-	if (ptr_thin) {
-    	name_lens_map[OO_name] = new ThinLens(ptr_thin->getX(),ptr_thin->getF());
+	const element_class& type = ElementRegistry::global().of(OO_object);
+	OpticalObject* element = type.copy(pool, OO_object);
+	OPTISIM_COUNT(COUNTER_ALLOCATIONS, 1);
 
-	} else if (ptr_thick) {
-	    name_lens_map[OO_name] = new ThickLens(ptr_thick->getX(),
-	    									   ptr_thick->getN(),
-	    									   ptr_thick->getD(),
-	    									   ptr_thick->getR_Left(),
-	    									   ptr_thick->getR_Right());
+	int id = names.intern(OO_name);
+	if (id >= elements.size()) {
+		elements.resize(id + 1, nullptr);
+		kinds.resize(id + 1, -1);
 	}
+	elements[id] = element;
+	kinds[id] = type.id;
+	order.insert(order.begin() + index, id);
+}
 
-	int size = order.size();
-
-	if (size == 0){
-		order.push_back(OO_name);
-		return;
+/**
+ * @details The first object to the right of `x` is found by binary search over the ordered elements.
+ * @param x The x-coordinate of the object to place.
+ * @return The index in `order` before which the object is to be inserted.
+ * @throws OptiSimError If the position is too close to the light source or to one of its neighbours.
+ */
+size_t OpticalSystem::findSlot(double x){
+	if(LS != nullptr){
+		if(abs(x - LS->getX()) < 0.001)throw OptiSimError("ERROR: \tThe Light Source and the Optical Object are too close together. The minimum distance must be at least 0.001 mm");
 	}
-	
-	int index = size;
-	
-	for(int i=0; i<size; i++){
-		if (name_lens_map[order[i]]->getX() > OO_object.getX()){
-			index = i;
-			break;
-		}
+
+	// binary search for the first object to the right of the new one
+	size_t index = 0;
+	size_t upper = order.size();
+	while (index < upper) {
+		size_t middle = index + (upper - index) / 2;
+		if (elements[order[middle]]->getX() > x) upper = middle;
+		else index = middle + 1;
 	}
 
 	if(index > 0){
-		if(abs(name_lens_map[order[index-1]]->getX() - OO_object.getX()) < 0.001){
-			delete name_lens_map[OO_name];
-			name_lens_map.erase(OO_name);
+		if(abs(elements[order[index-1]]->getX() - x) < 0.001)
 			throw OptiSimError("ERROR: \tLenses are too close together. The minimum distance must be at least 0.001 mm");
-		}
-			
 	}
 	if (index < order.size()) {
-		if (abs(name_lens_map[order[index]]->getX() - OO_object.getX()) < 0.001){
-			delete name_lens_map[OO_name];
-			name_lens_map.erase(OO_name);
+		if (abs(elements[order[index]]->getX() - x) < 0.001)
 			throw OptiSimError("ERROR: \tLenses are too close together. The minimum distance must be at least 0.001 mm");
-		}
-			
 	}
+	return index;
+}
 
-	order.insert(order.begin() + index, OO_name);
+/**
+ * @details The elements are sorted by position, so the object is found by binary search on its x-coordinate.
+ * @param id The name ID of an object of the system.
+ * @return The index of the object in `order`.
+ */
+size_t OpticalSystem::indexOf(int id){
+	double x = elements[id]->getX();
+	size_t index = 0;
+	size_t upper = order.size();
+	while (index < upper) {
+		size_t middle = index + (upper - index) / 2;
+		if (elements[order[middle]]->getX() > x) upper = middle;
+		else index = middle + 1;
+	}
+	if (index > 0 && order[index - 1] == id) return index - 1;
+	// not reached while the order is sorted; kept as a fallback
+	for (size_t i = 0; i < order.size(); i++) {
+		if (order[i] == id) return i;
+	}
+	return order.size();
 }
 
 /**
@@ -143,15 +212,18 @@ void OpticalSystem::add(OpticalObject& OO_object, string OO_name){
  * @param ls The `LightSource` object to be added.
  * @throws OptiSimError If the `LightSource` is too close to an existing optical object.
  */
-void OpticalSystem::add(LightSource ls){
+void OpticalSystem::add(const LightSource& ls){
+	pupils_valid = false;
 	int size = order.size();
 	if(size != 0){
 		for(int i = 0; i < size; i++){
-			if(abs(name_lens_map[order[i]]->getX() - ls.getX()) < 0.001) throw OptiSimError("ERROR: \tThe Light Source and the " + order[i] + 
+			if(abs(elements[order[i]]->getX() - ls.getX()) < 0.001) throw OptiSimError("ERROR: \tThe Light Source and the " + names.getName(order[i]) + 
 			"are too close together. The minimum distance must be at least 0.001 mm");
 		}
 	}
-	LS = new LightSource(ls.getX(), ls.getY());
+	pool.destroy(LS);
+	LS = pool.create<LightSource>(ls.getX(), ls.getY(), ls.getZ());
+	OPTISIM_COUNT(COUNTER_ALLOCATIONS, 1);
 }
 
 
@@ -163,87 +235,191 @@ void OpticalSystem::add(LightSource ls){
  * @param val The new double value for the specified property.
  * @throws OptiSimError If no `LightSource` is present in the system, if `param` is an invalid property name, or if the new position is too close to an existing optical object.
  */
-void OpticalSystem::modifyLightSource(string param, double val){
+void OpticalSystem::modifyLightSource(string_view param, double val){
+	pupils_valid = false;
 	if(LS == nullptr) throw OptiSimError("ERROR: \tYou have to add a Light Source to the system before you can modify it");
 	if(param == "x"){
 		int size = order.size();
 		if(size != 0){
 			for(int i = 0; i < size; i++){
-				if(abs(name_lens_map[order[i]]->getX() - val) < 0.001) throw OptiSimError("ERROR: \tThe Light Source and the " + order[i] + 
+				if(abs(elements[order[i]]->getX() - val) < 0.001) throw OptiSimError("ERROR: \tThe Light Source and the " + names.getName(order[i]) + 
 				"are too close together. The minimum distance must be at least 0.001 mm");
 			}
 		}
 		LS->setX(val);
 	}
 	else if(param == "y") LS->setY(val);
-	else throw OptiSimError("ERROR: \tInvalid parameter: " + param);
+	else if(param == "z") LS->setZ(val);
+	else throw OptiSimError("ERROR: \tInvalid parameter: " + string(param));
 }
 
 /**
- * @details This method modifies a specific property of an existing optical object (e.g., position, focal length, refractive index).
- * It dynamically casts the object to its specific type to call the correct setter method and handles re-insertion into the `order` vector if the position changes.
+ * @details This method modifies a specific property of an existing optical object (e.g., position, decentering, tilt, focal length, refractive index).
+ * The parameters specific to the type of the object are set through the schema of its type in the `ElementRegistry`,
+ * and the object is moved within the `order` vector if the position changes.
+ * A position that is too close to another object is rejected and leaves the object where it was.
  * @param name The string name of the optical object to modify.
- * @param param The name of the property to modify (e.g., "x", "f", "n", "r_left", "r_right", "d").
+ * @param param The name of the property to modify (e.g., "x", "y", "z", "tilt_y", "tilt_z", "aperture", "f", "n", "r_left", "r_right", "d").
  * @param val The new double value for the specified property.
- * @throws OptiSimError If the provided `name` does not correspond to an existing optical object, or if `param` is an invalid property name for that object type.
- */
-void OpticalSystem::modifyOpticalObject(string name, string param, double val){
-	if(name_lens_map.find(name) == name_lens_map.end()) throw OptiSimError("ERROR: \tInvalid key: " + name);
-	ThinLens* ptr_thin = dynamic_cast<ThinLens*>(name_lens_map[name]);
-	ThickLens* ptr_thick = dynamic_cast<ThickLens*>(name_lens_map[name]);
-	if (ptr_thin) {
-		if(param == "f") ptr_thin->setF(val);
-		else if(param == "x"){
-			ThinLens l(val, ptr_thin->getF());
-			remove(name);
-			add(l, name);
-		}
-		else throw OptiSimError("ERROR: \tInvalid parameter: " + param);
-	}
-	else if (ptr_thick) {
-		if(param == "n") ptr_thick->setN(val);
-		else if(param == "r_left") ptr_thick->setR_Left(val);
-		else if(param == "r_right") ptr_thick->setR_Right(val);
-		else if(param == "d") ptr_thick->setD(val);
-		else if(param == "x"){
-			ThickLens L(val, ptr_thick->getN(), ptr_thick->getD(), ptr_thick->getR_Left(), ptr_thick->getR_Right());
-			remove(name);
-			add(L, name);
+ * @throws OptiSimError If the provided `name` does not correspond to an existing optical object, if `param` is an invalid property name for that object type, or if the new position is too close to another object.
+ */
+void OpticalSystem::modifyOpticalObject(string_view name, string_view param, double val){
+	pupils_valid = false;
+	int id = names.find(name);
+	if(id < 0) throw OptiSimError("ERROR: \tInvalid key: " + string(name));
+	if (param == "x") {
+		size_t index = indexOf(id);
+		order.erase(order.begin() + index);
+		size_t slot;
+		try {
+			slot = findSlot(val);
+		} catch (OptiSimError&) {
+			order.insert(order.begin() + index, id);
+			throw;
 		}
-		else throw OptiSimError("ERROR: \tInvalid parameter: " + param);
+		elements[id]->setX(val);
+		order.insert(order.begin() + slot, id);
+	}
+	else if (param == "y") elements[id]->setY(val);
+	else if (param == "z") elements[id]->setZ(val);
+	else if (param == "tilt_y") elements[id]->setTiltY(val);
+	else if (param == "tilt_z") elements[id]->setTiltZ(val);
+	else if (param == "aperture") elements[id]->setAperture(val);
+	else {
+		const element_class& type = ElementRegistry::global().get(kinds[id]);
+		int k = type.param(param);
+		if (k < 0 || !type.params[k].set) throw OptiSimError("ERROR: \tInvalid parameter: " + string(param));
+		type.params[k].set(*elements[id], val);
 	}
 }
 
 
+/**
+ * @details The common properties ("x", "y", "z", "tilt_y", "tilt_z", "aperture") are read directly, the others through the
+ * schema of the object's type in the `ElementRegistry`, so derived properties such as the focal length of a thick lens can be read too.
+ * @param name The string name of the optical object.
+ * @param param The name of the property.
+ * @return The value of the property.
+ * @throws OptiSimError If the provided `name` does not correspond to an existing optical object, or if the object has no such property.
+ */
+double OpticalSystem::getParameter(string_view name, string_view param){
+	int id = names.find(name);
+	if(id < 0) throw OptiSimError("ERROR: \tInvalid key: " + string(name));
+	const OpticalObject& element = *elements[id];
+	if (param == "x") return element.getX();
+	if (param == "y") return element.getY();
+	if (param == "z") return element.getZ();
+	if (param == "tilt_y") return element.getTiltY();
+	if (param == "tilt_z") return element.getTiltZ();
+	if (param == "aperture") return element.getAperture();
+	const element_class& type = ElementRegistry::global().get(kinds[id]);
+	int k = type.param(param);
+	if (k < 0) throw OptiSimError("ERROR: \tInvalid parameter: " + string(param));
+	return type.params[k].get(element);
+}
+
+/**
+ * @details The elements are matched by name. An element of this system whose type and parameters equal those
+ * of its namesake in `other` is kept as it is, together with its cached state (e.g. the principal planes of a
+ * thick lens); the others are replaced by copies of the elements of `other`, and elements missing from `other`
+ * are removed. Since `other` is a valid system, its element order is taken over without checking distances again.
+ * The image sequence and the rays are cleared, as they belong to the previous state of the system.
+ * @param other The system to copy; it is not modified.
+ */
+int OpticalSystem::update(OpticalSystem& other){
+	pupils_valid = false;
+	int changed = 0;
+	if (other.LS == nullptr) {
+		if (LS != nullptr) changed++;
+		pool.destroy(LS);
+		LS = nullptr;
+	} else if (LS == nullptr) {
+		LS = pool.create<LightSource>(other.LS->getX(), other.LS->getY(), other.LS->getZ());
+		OPTISIM_COUNT(COUNTER_ALLOCATIONS, 1);
+		changed++;
+	} else if (LS->getX() != other.LS->getX() || LS->getY() != other.LS->getY() || LS->getZ() != other.LS->getZ()) {
+		LS->setX(other.LS->getX());
+		LS->setY(other.LS->getY());
+		LS->setZ(other.LS->getZ());
+		changed++;
+	}
+
+	// kept[id] marks the elements of this system that are still in use
+	vector<int> new_order;
+	new_order.reserve(other.order.size());
+	vector<char> kept(elements.size(), 0);
+	for (int their_id : other.order) {
+		OpticalObject* theirs = other.elements[their_id];
+		int id = names.intern(other.names.getName(their_id));
+		if (id >= elements.size()) {
+			elements.resize(id + 1, nullptr);
+			kinds.resize(id + 1, -1);
+		}
+		if (id >= kept.size()) kept.resize(id + 1, 0);
+		kept[id] = 1;
+		new_order.push_back(id);
+		OpticalObject* ours = elements[id];
+		const element_class& type = ElementRegistry::global().get(other.kinds[their_id]);
+		if (ours != nullptr) {
+			if (kinds[id] == type.id && ElementRegistry::same(type, *ours, *theirs)) continue;
+			pool.destroy(ours);
+		}
+		elements[id] = type.copy(pool, *theirs);
+		kinds[id] = type.id;
+		OPTISIM_COUNT(COUNTER_ALLOCATIONS, 1);
+		changed++;
+	}
+	for (int id : order) {
+		if (kept[id]) continue;
+		pool.destroy(elements[id]);
+		elements[id] = nullptr;
+		names.release(id);
+		changed++;
+	}
+
+	order = move(new_order);
+	glass_catalog = other.glass_catalog;
+	imageSequence.clear();
+	ray_coord.clear();
+	return changed;
+}
+
 // Other methods --------------------------------------------------------------
 /**
- * @details This method returns a copy of the sequence of images formed by the optical objects in the system.
+ * @details This method returns a reference to the sequence of images formed by the optical objects in the system;
+ * copy it to keep it across calculations.
  */
-vector<Image> OpticalSystem::getImageSequence(){
+const vector<Image>& OpticalSystem::getImageSequence(){
 	return imageSequence;
 }
 
 /**
  * @details This method simulates the path of light through the optical system, calculates the image formed by each optical object in sequence, and traces representative rays.
- * It updates the `imageSequence` and `ray_coord` members.
+ * It updates the `imageSequence` and `ray_coord` members. Their storage is reused, so recalculating a system
+ * whose number of elements did not grow allocates no memory.
+ * Centered systems use the on-axis formulas below; as soon as an element is decentered or tilted, or the light
+ * source is out of the meridional plane, the off-axis calculation is chosen instead.
  * @return The final `Image` object formed by the entire optical system.
  * @throws OptiSimError If no `LightSource` is present, if no `OpticalObjects` are in the system, or if the light source is positioned behind all optical objects.
  */
 Image OpticalSystem::Calculate(){
+	OPTISIM_TIME_SCOPE(PHASE_CALCULATE);
 	if(LS == nullptr) throw OptiSimError("ERROR: \tYou have to add a Light Source to the system before calling the Calculate() method.");
 	if(order.size() == 0) throw OptiSimError("ERROR: \tYou have to add Optical Objects to the system first before calling the Calculate() method.");
 	
-	ray_coord["ray_1"].x = vector<double>();
-	ray_coord["ray_1"].y = vector<double>();
-	ray_coord["ray_2"].x = vector<double>();
-	ray_coord["ray_2"].y = vector<double>();
+	ray& ray_1 = ray_coord["ray_1"];
+	ray& ray_2 = ray_coord["ray_2"];
+	ray_1.x.clear();
+	ray_1.y.clear();
+	ray_2.x.clear();
+	ray_2.y.clear();
 
 	// calculate first image
 	imageSequence.clear();
 
 	int start = 0;
 	while (start < order.size()) {
-		if (LS->getX() > name_lens_map[order[start]]->getX())
+		if (LS->getX() > elements[order[start]]->getX())
         	start++;
     	else
         	break;
@@ -251,75 +427,495 @@ Image OpticalSystem::Calculate(){
 
 	if(start == order.size()) throw OptiSimError("ERROR: \t The Light Source is behind all the Optical Objects, nothing to calculate.");
 
+	if(isOffAxis()) return CalculateOffAxis(start);
+
 	// initial coordinates
-	ray_coord["ray_1"].x.push_back(LS->getX());
-	ray_coord["ray_1"].y.push_back(LS->getY());
-	ray_coord["ray_2"].x.push_back(LS->getX());
-	ray_coord["ray_2"].y.push_back(LS->getY());
+	ray_1.x.push_back(LS->getX());
+	ray_1.y.push_back(LS->getY());
+	ray_2.x.push_back(LS->getX());
+	ray_2.y.push_back(LS->getY());
 
 	// first lens
-	ray_coord["ray_1"].x.push_back(name_lens_map[order[start]]->getX());
-	ray_coord["ray_1"].y.push_back(LS->getY());
-	ray_coord["ray_2"].x.push_back(name_lens_map[order[start]]->getX());
-	ray_coord["ray_2"].y.push_back(0);
+	ray_1.x.push_back(elements[order[start]]->getX());
+	ray_1.y.push_back(LS->getY());
+	ray_2.x.push_back(elements[order[start]]->getX());
+	ray_2.y.push_back(0);
 
-	Image img = name_lens_map[order[start]]->Calculate(*LS);
+	Image img = elements[order[start]]->Calculate(*LS);
 	
 	imageSequence.push_back(img);
 	
 	for(int i = start+1; i < order.size(); i++){
 
-		NextRayCoords(name_lens_map[order[i]], img, "ray_1");
-		NextRayCoords(name_lens_map[order[i]], img, "ray_2");
+		NextRayCoords(elements[order[i]], img, ray_1);
+		NextRayCoords(elements[order[i]], img, ray_2);
 
-		img = name_lens_map[order[i]]->Calculate(img);
+		img = elements[order[i]]->Calculate(img);
 		imageSequence.push_back(img);
 	}
+	OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, order.size() - start);
+
 	// rays intersect at final image
-	ray_coord["ray_1"].x.push_back(img.getX());
-	ray_coord["ray_1"].y.push_back(img.getY());
-	ray_coord["ray_2"].x.push_back(img.getX());
-	ray_coord["ray_2"].y.push_back(img.getY());
+	ray_1.x.push_back(img.getX());
+	ray_1.y.push_back(img.getY());
+	ray_2.x.push_back(img.getX());
+	ray_2.y.push_back(img.getY());
 	
 	return img;
 }
 
+/**
+ * @details This method images the light source through the system at every given wavelength in one pass.
+ * The lanes are kept in contiguous arrays and each optical object processes all of them at once through
+ * `OpticalObject::CalculateSpectrum`, so dispersive thick lenses evaluate their refractive indices, focal
+ * lengths and principal planes for the whole spectrum in batch. The element selection matches `Calculate()`.
+ * The image sequence and the traced rays are not modified.
+ * @param wavelengths The wavelengths in micrometres.
+ * @return The final image at each wavelength, in the order of `wavelengths`.
+ * @throws OptiSimError If no `LightSource` is present, if no `OpticalObjects` are in the system, if the light source is positioned behind all optical objects, if a wavelength is not positive, or if the system has decentered or tilted elements.
+ */
+vector<Image> OpticalSystem::CalculateChromatic(const vector<double>& wavelengths){
+	OPTISIM_TIME_SCOPE(PHASE_CALCULATE);
+	if(LS == nullptr) throw OptiSimError("ERROR: \tYou have to add a Light Source to the system before calling the CalculateChromatic() method.");
+	if(order.size() == 0) throw OptiSimError("ERROR: \tYou have to add Optical Objects to the system first before calling the CalculateChromatic() method.");
+	for(double wavelength : wavelengths){
+		if(!(wavelength > 0)) throw OptiSimError("ERROR: \tThe wavelength must be a positive number.");
+	}
+	if(isOffAxis()) throw OptiSimError("ERROR: \tThe CalculateChromatic() method supports centered systems only.");
+
+	int start = 0;
+	while (start < order.size() && LS->getX() > elements[order[start]]->getX()) start++;
+	if(start == order.size()) throw OptiSimError("ERROR: \t The Light Source is behind all the Optical Objects, nothing to calculate.");
+
+	size_t count = wavelengths.size();
+	vector<double> x(count, LS->getX());
+	vector<double> y(count, LS->getY());
+	vector<char> real(count, 0);
+	for(int i = start; i < order.size(); i++){
+		elements[order[i]]->CalculateSpectrum(wavelengths.data(), x.data(), y.data(), real.data(), count);
+	}
+	OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, (order.size() - start) * count);
+
+	vector<Image> images;
+	images.reserve(count);
+	for(size_t i = 0; i < count; i++) images.push_back(Image(x[i], y[i], real[i]));
+	return images;
+}
+
+/**
+ * @details This method checks the light source and every element; it is cheap compared to a calculation.
+ */
+bool OpticalSystem::isOffAxis(){
+	if(LS->getZ() != 0) return true;
+	for(int id : order){
+		if(!elements[id]->isCentered()) return true;
+	}
+	return false;
+}
+
+/**
+ * @details This is the off-axis counterpart of the on-axis part of `Calculate()`. Each element images the previous
+ * image through `OpticalObject::CalculateOffAxis`, so the images have a z-coordinate as well. The two construction
+ * rays start at the light source like in `Calculate()`, one parallel to the axis and one aimed at the center of the
+ * first element, and are traced through the elements with `OpticalObject::TraceRays`; `ray_coord` keeps the x and y
+ * coordinates of the points where they leave each element.
+ * @param start The position in the optical order of the first element after the light source.
+ * @return The final `Image` object formed by the entire optical system.
+ */
+Image OpticalSystem::CalculateOffAxis(int start){
+	ray& ray_1 = ray_coord["ray_1"];
+	ray& ray_2 = ray_coord["ray_2"];
+	OpticalObject* first = elements[order[start]];
+	double distance = first->getX() - LS->getX();
+	double x[2] = {LS->getX(), LS->getX()};
+	double y[2] = {LS->getY(), LS->getY()};
+	double z[2] = {LS->getZ(), LS->getZ()};
+	double u[2] = {0, (first->getY() - LS->getY()) / distance};
+	double v[2] = {0, (first->getZ() - LS->getZ()) / distance};
+	char blocked[2];
+
+	ray_1.x.push_back(x[0]);
+	ray_1.y.push_back(y[0]);
+	ray_2.x.push_back(x[1]);
+	ray_2.y.push_back(y[1]);
+
+	Image img(LS->getX(), LS->getY(), false, LS->getZ());
+	for(int i = start; i < order.size(); i++){
+		OpticalObject* element = elements[order[i]];
+		element->TraceRays(x, y, z, u, v, blocked, 2);
+		ray_1.x.push_back(x[0]);
+		ray_1.y.push_back(y[0]);
+		ray_2.x.push_back(x[1]);
+		ray_2.y.push_back(y[1]);
+
+		img = element->CalculateOffAxis(img);
+		imageSequence.push_back(img);
+	}
+	OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, order.size() - start);
+
+	// rays intersect at final image
+	ray_1.x.push_back(img.getX());
+	ray_1.y.push_back(img.getY());
+	ray_2.x.push_back(img.getX());
+	ray_2.y.push_back(img.getY());
+
+	return img;
+}
+
+/**
+ * @details Every element after the light source (all of them if there is none) traces the whole bundle in one call
+ * to `OpticalObject::TraceRays`, so the work is a sequence of loops over the coordinate arrays. Centered elements use
+ * the on-axis form of the loop, decentered and tilted ones the general form; the choice is made per element.
+ * On return the bundle holds the points where the rays leave the last element, and their slopes there.
+ *
+ * A ray that passes outside the aperture of an element is vignetted: it stops there, keeps the point and slopes it
+ * had when leaving that element, and `vignetted` records the position of the element in the optical order.
+ * If no element limits the rays the bundle is traced in place. Otherwise the rays are traced in a scratch bundle
+ * whose live rays are compacted after every element that blocked some of them, so the following elements only
+ * loop over the rays that are still going; the survivors are written back at the end. The scratch storage is kept
+ * by the system, so tracing bundles of the same size again allocates no memory.
+ * @param rays The bundle to trace; it is updated in place.
+ * @throws OptiSimError If the vectors of the bundle differ in length.
+ */
+void OpticalSystem::TraceRays(ray_bundle& rays){
+	OPTISIM_TIME_SCOPE(PHASE_CALCULATE);
+	size_t count = rays.x.size();
+	if(rays.y.size() != count || rays.z.size() != count || rays.u.size() != count || rays.v.size() != count)
+		throw OptiSimError("ERROR: \tAll coordinates of a ray bundle must have the same length.");
+	rays.vignetted.assign(count, -1);
+	trace_blocked.resize(count);
+
+	int start = 0;
+	while (LS != nullptr && start < order.size() && LS->getX() > elements[order[start]]->getX()) start++;
+	bool limited = false;
+	for(int i = start; i < order.size(); i++) limited |= isfinite(elements[order[i]]->getAperture());
+
+	if(!limited){
+		for(int i = start; i < order.size(); i++){
+			elements[order[i]]->TraceRays(rays.x.data(), rays.y.data(), rays.z.data(), rays.u.data(), rays.v.data(),
+			                              trace_blocked.data(), count);
+		}
+		OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, (order.size() - start) * count);
+		return;
+	}
+
+	trace_rays.x.assign(rays.x.begin(), rays.x.end());
+	trace_rays.y.assign(rays.y.begin(), rays.y.end());
+	trace_rays.z.assign(rays.z.begin(), rays.z.end());
+	trace_rays.u.assign(rays.u.begin(), rays.u.end());
+	trace_rays.v.assign(rays.v.begin(), rays.v.end());
+	trace_index.resize(count);
+	for(size_t j = 0; j < count; j++) trace_index[j] = j;
+
+	double* x = trace_rays.x.data();
+	double* y = trace_rays.y.data();
+	double* z = trace_rays.z.data();
+	double* u = trace_rays.u.data();
+	double* v = trace_rays.v.data();
+	size_t* index = trace_index.data();
+	char* blocked = trace_blocked.data();
+	size_t live = count;
+	size_t evaluations = 0;
+	for(int i = start; i < order.size() && live > 0; i++){
+		elements[order[i]]->TraceRays(x, y, z, u, v, blocked, live);
+		evaluations += live;
+
+		char any = 0;
+		for(size_t j = 0; j < live; j++) any |= blocked[j];
+		if(!any) continue;
+
+		// write the blocked rays back and move the live ones to the front
+		size_t k = 0;
+		for(size_t j = 0; j < live; j++){
+			size_t original = index[j];
+			if(blocked[j]){
+				rays.x[original] = x[j];
+				rays.y[original] = y[j];
+				rays.z[original] = z[j];
+				rays.u[original] = u[j];
+				rays.v[original] = v[j];
+				rays.vignetted[original] = i;
+			}
+			x[k] = x[j];
+			y[k] = y[j];
+			z[k] = z[j];
+			u[k] = u[j];
+			v[k] = v[j];
+			index[k] = original;
+			k += !blocked[j];
+		}
+		live = k;
+	}
+	OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, evaluations);
+
+	for(size_t j = 0; j < live; j++){
+		size_t original = index[j];
+		rays.x[original] = x[j];
+		rays.y[original] = y[j];
+		rays.z[original] = z[j];
+		rays.u[original] = u[j];
+		rays.v[original] = v[j];
+	}
+}
+
+/**
+ * @details The pupils are computed on the first call after a modification of the system and then returned from the
+ * cache, so they are cheap to query repeatedly.
+ * @throws OptiSimError If no `LightSource` is present, if no `OpticalObjects` are in the system, if the light source is positioned behind all optical objects, if the system has decentered or tilted elements, or if no element has a finite aperture.
+ */
+const pupil_info& OpticalSystem::getPupils(){
+	if(!pupils_valid) computePupils();
+	return pupils;
+}
+
+/**
+ * @details Two paraxial rays are traced through the elements after the light source with `OpticalObject::TraceRays`:
+ * one leaves the object plane at unit height parallel to the axis, the other leaves the axis with unit slope. Every
+ * other paraxial ray from the object plane is a combination of these two. The aperture stop is the element where the
+ * ratio of the aperture to the height of the axial ray is the smallest; the marginal and chief rays are then scaled
+ * to the edge and the center of the stop. The entrance pupil lies where the chief ray meets the axis in object space,
+ * the exit pupil where it meets the axis behind the last element, and their radii are the heights of the marginal
+ * ray there. A second pass finds the field stop, the element other than the aperture stop that first cuts the chief
+ * ray as the field grows.
+ * @throws OptiSimError If no `LightSource` is present, if no `OpticalObjects` are in the system, if the light source is positioned behind all optical objects, if the system has decentered or tilted elements, or if no element has a finite aperture.
+ */
+void OpticalSystem::computePupils(){
+	if(LS == nullptr) throw OptiSimError("ERROR: \tYou have to add a Light Source to the system before calling the getPupils() method.");
+	if(order.size() == 0) throw OptiSimError("ERROR: \tYou have to add Optical Objects to the system first before calling the getPupils() method.");
+	if(isOffAxis()) throw OptiSimError("ERROR: \tThe getPupils() method supports centered systems only.");
+
+	int start = 0;
+	while (start < order.size() && LS->getX() > elements[order[start]]->getX()) start++;
+	if(start == order.size()) throw OptiSimError("ERROR: \t The Light Source is behind all the Optical Objects, nothing to calculate.");
+
+	// ray 0 leaves the object at unit height parallel to the axis, ray 1 leaves the axis with unit slope
+	const double infinity = numeric_limits<double>::infinity();
+	double x[2] = {LS->getX(), LS->getX()};
+	double y[2] = {1, 0};
+	double z[2] = {0, 0};
+	double u[2] = {0, 1};
+	double v[2] = {0, 0};
+	char blocked[2];
+	int stop = -1;
+	double narrowest = infinity;
+	for(int i = start; i < order.size(); i++){
+		OpticalObject* element = elements[order[i]];
+		element->TraceRays(x, y, z, u, v, blocked, 2);
+		double ratio = element->getAperture() / abs(y[1]);
+		if(ratio < narrowest){
+			narrowest = ratio;
+			stop = i;
+			stop_field = y[0];
+			stop_axial = y[1];
+		}
+	}
+	if(stop < 0) throw OptiSimError("ERROR: \tThe system has no aperture stop; set the aperture of an element or add an ApertureStop.");
+
+	double radius = elements[order[stop]]->getAperture();
+	double chief = -stop_field / stop_axial; // the slope of the chief ray from unit height
+	pupils.aperture_stop = stop;
+	pupils.marginal_u = radius / stop_axial;
+	pupils.entrance_x = LS->getX() + stop_axial / stop_field;
+	pupils.entrance_radius = radius / abs(stop_field);
+
+	// the chief and the marginal ray behind the last element
+	double chief_y = y[0] + chief * y[1];
+	double chief_slope = u[0] + chief * u[1];
+	double marginal_y = pupils.marginal_u * y[1];
+	double marginal_slope = pupils.marginal_u * u[1];
+	pupils.exit_x = x[0] - chief_y / chief_slope;
+	pupils.exit_radius = isinf(pupils.exit_x) ? infinity : abs(marginal_y + marginal_slope * (pupils.exit_x - x[0]));
+	pupils.na_object = abs(pupils.marginal_u) / sqrt(1 + pupils.marginal_u * pupils.marginal_u);
+	pupils.na_image = abs(marginal_slope) / sqrt(1 + marginal_slope * marginal_slope);
+
+	// the field stop cuts the chief ray at the smallest fraction of the object height
+	x[0] = x[1] = LS->getX();
+	y[0] = 1;
+	y[1] = 0;
+	u[0] = 0;
+	u[1] = 1;
+	pupils.field_stop = -1;
+	double fraction = infinity;
+	for(int i = start; i < order.size(); i++){
+		OpticalObject* element = elements[order[i]];
+		element->TraceRays(x, y, z, u, v, blocked, 2);
+		if(i == stop || !isfinite(element->getAperture())) continue;
+		double limit = element->getAperture() / abs(LS->getY() * (y[0] + chief * y[1]));
+		if(pupils.field_stop < 0 || limit < fraction){
+			fraction = limit;
+			pupils.field_stop = i;
+		}
+	}
+	pupils.field_height = LS->getY() * min(1.0, fraction);
+	pupils.chief_u = pupils.field_height * chief;
+	pupils.field_angle = atan(abs(pupils.chief_u)) * 180 / acos(-1.0);
+	pupils_valid = true;
+}
+
+/**
+ * @details The rays leave the object plane at evenly spaced heights from the axis to the edge of the field
+ * (`pupil_info::field_height`); a single field samples the axis only. For every field point the aperture stop is
+ * sampled on a hexapolar grid: its center and `rings` concentric rings of 6, 12, 18, ... points out to the edge of the
+ * stop, so every field point gets `1 + 3 rings (rings + 1)` rays, the first of which is its chief ray. The slopes are
+ * found from the paraxial pupil calculation, so the rays fill the stop whether the entrance pupil is finite or not.
+ * @param fields The number of field points.
+ * @param rings The number of rings in the stop; 0 traces the chief rays only.
+ * @return The bundle, ordered by field point and then from the center of the stop outwards.
+ * @throws OptiSimError If `fields` is not positive or `rings` is negative, or if the pupils cannot be computed (see `getPupils`).
+ */
+ray_bundle OpticalSystem::SampleField(int fields, int rings){
+	if(fields < 1 || rings < 0) throw OptiSimError("ERROR: \tThe field sampling needs at least one field point and a non-negative number of rings.");
+	const pupil_info& info = getPupils();
+	double radius = elements[order[info.aperture_stop]]->getAperture();
+	const double pi = acos(-1.0);
+
+	ray_bundle rays;
+	size_t count = (size_t)fields * (1 + 3 * rings * (rings + 1));
+	rays.x.reserve(count);
+	rays.y.reserve(count);
+	rays.z.reserve(count);
+	rays.u.reserve(count);
+	rays.v.reserve(count);
+	for(int i = 0; i < fields; i++){
+		double height = fields > 1 ? info.field_height * i / (fields - 1) : 0.0;
+		for(int ring = 0; ring <= rings; ring++){
+			int points = ring == 0 ? 1 : 6 * ring;
+			double r = ring == 0 ? 0.0 : radius * ring / rings;
+			for(int k = 0; k < points; k++){
+				double angle = 2 * pi * k / points;
+				rays.x.push_back(LS->getX());
+				rays.y.push_back(height);
+				rays.z.push_back(0);
+				rays.u.push_back((r * cos(angle) - height * stop_field) / stop_axial);
+				rays.v.push_back(r * sin(angle) / stop_axial);
+			}
+		}
+	}
+	return rays;
+}
+
+/**
+ * @details Every beam is described by its complex beam parameter `q = z + i zR`, where `z` is the distance from its
+ * waist and `zR` its Rayleigh range. Between elements `q` grows by the distance travelled; an element with a finite
+ * focal length maps it by the thin-lens law `1/q' = 1/q - 1/f` from its object-side to its image-side principal plane,
+ * and an element without optical power only moves the beam from one principal plane to the other. The principal
+ * planes come from the paraxial kernel of each element type, so thick lenses, mirrors and plates need no special
+ * handling. The real and imaginary parts of `q` are kept in two arrays and the complex arithmetic is written out,
+ * so each element is one loop over the batch that the compiler can vectorize.
+ *
+ * Every element of the system acts on the beams, in optical order, regardless of the light source; the input waists
+ * should lie before the first element. The outputs hold, for every element, where the waist of each beam leaving it
+ * lies (before the element for a diverging beam), its radius and Rayleigh range, and the radius of the beam arriving
+ * at the element.
+ * @param beams The batch to propagate; its output vectors are overwritten.
+ * @throws OptiSimError If the input vectors differ in length, a waist or wavelength is not positive, or an element
+ * is decentered or tilted.
+ */
+void OpticalSystem::PropagateBeams(beam_bundle& beams){
+	OPTISIM_TIME_SCOPE(PHASE_CALCULATE);
+	size_t count = beams.waist_x.size();
+	if(beams.waist_w.size() != count || beams.wavelength.size() != count)
+		throw OptiSimError("ERROR: \tAll inputs of a beam bundle must have the same length.");
+	for(size_t j = 0; j < count; j++){
+		if(!(beams.waist_w[j] > 0) || !(beams.wavelength[j] > 0))
+			throw OptiSimError("ERROR: \tThe waist and the wavelength of a Gaussian beam must be positive.");
+	}
+	for(int id : order){
+		if(!elements[id]->isCentered()) throw OptiSimError("ERROR: \tThe PropagateBeams() method supports centered elements only.");
+	}
+
+	const double pi = acos(-1.0);
+	size_t total = order.size() * count;
+	beams.x.resize(total);
+	beams.w.resize(total);
+	beams.rayleigh.resize(total);
+	beams.spot.resize(total);
+	if(order.empty()) return;
+
+	// q = a + ib on the plane p, with lambda in mm
+	vector<double> a(count), b(count), lambda(count);
+	double p = ElementRegistry::global().get(kinds[order[0]]).kernel(*elements[order[0]], nullptr, nullptr, nullptr).h_left;
+	for(size_t j = 0; j < count; j++){
+		lambda[j] = beams.wavelength[j] * 1e-3;
+		a[j] = p - beams.waist_x[j];
+		b[j] = pi * beams.waist_w[j] * beams.waist_w[j] / lambda[j];
+	}
+
+	for(int i = 0; i < order.size(); i++){
+		const OpticalObject& element = *elements[order[i]];
+		principal_planes planes = ElementRegistry::global().get(kinds[order[i]]).kernel(element, nullptr, nullptr, nullptr);
+		double shift = planes.h_left - p;
+		double f = planes.f;
+		double* x = beams.x.data() + i * count;
+		double* w = beams.w.data() + i * count;
+		double* rayleigh = beams.rayleigh.data() + i * count;
+		double* spot = beams.spot.data() + i * count;
+		if(isfinite(f)){
+			for(size_t j = 0; j < count; j++){
+				double aj = a[j] + shift;
+				double bj = b[j];
+				spot[j] = sqrt(lambda[j] * (aj * aj + bj * bj) / (pi * bj));
+				double g = f - aj;
+				double scale = f / (g * g + bj * bj);
+				a[j] = scale * (aj * g - bj * bj);
+				b[j] = scale * f * bj;
+			}
+		} else {
+			for(size_t j = 0; j < count; j++){
+				a[j] += shift;
+				spot[j] = sqrt(lambda[j] * (a[j] * a[j] + b[j] * b[j]) / (pi * b[j]));
+			}
+		}
+		p = planes.h_right;
+		for(size_t j = 0; j < count; j++){
+			x[j] = p - a[j];
+			w[j] = sqrt(b[j] * lambda[j] / pi);
+			rayleigh[j] = b[j];
+		}
+	}
+	OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, order.size() * count);
+}
+
 /**
  * @details This method prints a formatted summary of the optical system, including details of the light source,
  * all optical objects (thin and thick lenses), and the final calculated image (if available).
+ * The text is formatted by an `OutputWriter` and written to the stream in one piece; it is the same as
+ * formatting it with the stream directly.
  * @param os The output stream to which the summary will be written. Defaults to `std::cout`.
  */
 void OpticalSystem::toString(ostream& os){
+	OutputWriter writer(os);
+	toString(writer);
+}
+
+/**
+ * @details This overload appends the same text to a writer, so the summary can be followed by more output in the same buffer.
+ * Numbers are written in the default notation with the precision the writer took from its stream.
+ * @param os The writer to which the system's details will be appended.
+ */
+void OpticalSystem::toString(OutputWriter& os){
 
 	os << "\n-------------------------------------------------------------------------------\n";
 	os << "#    SYSTEM SUMMARY";
 	os << "\n-------------------------------------------------------------------------------\n";
 	if(LS != nullptr){
-		os << "Object Position: " << LS->getX() << ", Size: " << LS->getY() << "\n";
+		os << "Object Position: " << LS->getX() << ", Size: " << LS->getY();
+		if (LS->getZ() != 0) os << ", Size z: " << LS->getZ();
+		os << "\n";
 
 	}
 	for (int i=0; i< order.size(); i++){
-		ThinLens* ptr_thin = dynamic_cast<ThinLens*>(name_lens_map[order[i]]);
-		ThickLens* ptr_thick = dynamic_cast<ThickLens*>(name_lens_map[order[i]]);
-		if (ptr_thin){
-			os << "\nThin Lens: " << order[i]
-				 <<",  Position: " << ptr_thin->getX()
-		         << ", Focal Length: " << ptr_thin->getF() << "\n";
-		}
-		if (ptr_thick){
-			os << "\nThick Lens: " << order[i]
-				 << ", Position: " << ptr_thick->getX()
-	             << ", n: " << ptr_thick->getN()
-	             << ", Thickness: " << ptr_thick->getD() 
-	        	 << ", Radius_left: " << ptr_thick->getR_Left()
-	        	 << ", Radius_right: " << ptr_thick->getR_Right()
-				 << ", Focal Length: " << ptr_thick->getF() << "\n";
-		}
+		OpticalObject* element = elements[order[i]];
+		const element_class& type = ElementRegistry::global().get(kinds[order[i]]);
+		os << "\n" << type.label << ": " << names.getName(order[i]);
+		ElementRegistry::print(type, os, *element);
+		os << "\n";
 	}
 	if (imageSequence.size() != 0){
 		os << "\nImage Position: " << imageSequence.back().getX()
-		<< ", Size: " << imageSequence.back().getY()
-		<< ", Is real: " << imageSequence.back().getReal();
+		<< ", Size: " << imageSequence.back().getY();
+		if (imageSequence.back().getZ() != 0) os << ", Size z: " << imageSequence.back().getZ();
+		os << ", Is real: " << imageSequence.back().getReal();
 	}
 	os << "\n-------------------------------------------------------------------------------\n";
 }
@@ -327,44 +923,43 @@ void OpticalSystem::toString(ostream& os){
 /**
  * @details This method saves the current configuration of the optical system to a JSON file.
  * It includes details of the light source and all added lenses (thin or thick).
+ * The glass catalog is written relative to the directory of the saved file, so the file can be read back from
+ * wherever it is saved. Without a glass catalog, the lenses made of a named material are written with the
+ * dispersion model of the material instead, since the name could not be looked up when the file is read.
  * @param file_name The path to the file where the system configuration will be saved.
  * @throws OptiSimError If no LightSource is present in the system, or if the file cannot be opened for writing.
  */
-void OpticalSystem::save(string file_name) {
+void OpticalSystem::save(const string& file_name) {
+    OPTISIM_TIME_SCOPE(PHASE_SAVE);
     if (LS == nullptr) throw OptiSimError("ERROR: \tCannot save system: no light source present.");
 
     json data;
 
+    if (!glass_catalog.empty()) {
+        filesystem::path directory = filesystem::absolute(file_name).lexically_normal().parent_path();
+        filesystem::path catalog_path = filesystem::path(glass_catalog).lexically_relative(directory);
+        data["glass_catalog"] = catalog_path.empty() ? glass_catalog : catalog_path.generic_string();
+    }
+
     // Save light source (object)
     data["object"] = {
         {"position", LS->getX()},
         {"size", LS->getY()}
     };
+    if (LS->getZ() != 0) data["object"]["size_z"] = LS->getZ();
 
     // Save lenses
-    for (const auto& name : order) {
-        OpticalObject* obj = name_lens_map[name];
-        ThinLens* thin = dynamic_cast<ThinLens*>(obj);
-        ThickLens* thick = dynamic_cast<ThickLens*>(obj);
-
-        if (thin) {
-            data["lenses"].push_back({
-                {"name", name},
-                {"type", "thin"},
-                {"position", thin->getX()},
-                {"focal_length", thin->getF()}
-            });
-        } else if (thick) {
-            data["lenses"].push_back({
-                {"name", name},
-                {"type", "thick"},
-                {"position", thick->getX()},
-                {"radius_left", thick->getR_Left()},
-                {"radius_right", thick->getR_Right()},
-                {"refractive_index", thick->getN()},
-                {"thickness", thick->getD()}
-            });
+    for (int id : order) {
+        const string& name = names.getName(id);
+        OpticalObject* obj = elements[id];
+        json lens = {{"name", name}};
+        ElementRegistry::write(ElementRegistry::global().get(kinds[id]), *obj, lens);
+        if (glass_catalog.empty() && lens.contains("material")) {
+            MaterialCatalog& catalog = MaterialCatalog::global();
+            lens["dispersion"] = ElementRegistry::writeDispersion(*catalog.getModel(catalog.getId(lens["material"].get<string>())));
+            lens.erase("material");
         }
+        data["lenses"].push_back(lens);
     }
 
     // Write to file
@@ -378,32 +973,31 @@ void OpticalSystem::save(string file_name) {
 // Destructor -----------------------------------------------------------------
 /**
  * @details This destructor is responsible for cleaning up dynamically allocated memory.
- * It iterates through the `name_lens_map` to `delete` all `OpticalObject` pointers and also `delete`s the `LightSource` pointer.
+ * It destroys every `OpticalObject` and the `LightSource`; their memory is then returned to the upstream resource
+ * in one go when the element pool is destroyed.
  */
 OpticalSystem::~OpticalSystem(){
 	for(int i = 0; i < order.size(); i++){
-		delete name_lens_map[order[i]];
+		pool.destroy(elements[order[i]]);
 	}
-	name_lens_map.clear();
-	delete LS;
+	elements.clear();
+	pool.destroy(LS);
 }
 
 /**
  * @details This method removes an optical object from the system by its unique name.
- * It deallocates the memory associated with the object and removes its entry from the internal maps and order vector.
+ * It deallocates the memory associated with the object, removes it from the order vector and releases its name.
  * @param name The string name of the optical object to be removed.
  * @throws OptiSimError If the provided `name` does not correspond to an existing optical object in the system.
  */
-void OpticalSystem::remove(string name){
-	if(name_lens_map.find(name) == name_lens_map.end()) throw OptiSimError("ERROR: \tInvalid key: " + name);
-	for(int i = 0; i < order.size(); i++){
-		if(order[i] == name) {
-			order.erase(order.begin() + i);
-			break;
-		}
-	}
-	delete name_lens_map[name];
-	name_lens_map.erase(name);
+void OpticalSystem::remove(string_view name){
+	pupils_valid = false;
+	int id = names.find(name);
+	if(id < 0) throw OptiSimError("ERROR: \tInvalid key: " + string(name));
+	order.erase(order.begin() + indexOf(id));
+	pool.destroy(elements[id]);
+	elements[id] = nullptr;
+	names.release(id);
 }
 
 /**
@@ -411,13 +1005,13 @@ void OpticalSystem::remove(string name){
  * It calculates the point where the ray intersects the plane of the given `ActualLens` based on the previous image formed.
  * @param ActualLens A pointer to the `OpticalObject` (lens) that the ray is currently interacting with.
  * @param ActualImage The `Image` object formed by the *previous* optical element or the initial `LightSource`.
- * @param which A string identifier for the ray being traced (e.g., "ray_1", "ray_2").
+ * @param which The ray being traced (e.g., the entry of "ray_1" or "ray_2" in `ray_coord`).
  */
-void OpticalSystem::NextRayCoords(OpticalObject* ActualLens, Image ActualImage, string which){
+void OpticalSystem::NextRayCoords(OpticalObject* ActualLens, const Image& ActualImage, ray& which){
 	double x_image = ActualImage.getX();
 	double y_image = ActualImage.getY();
-	double x_ray = ray_coord[which].x.back();
-	double y_ray = ray_coord[which].y.back();
+	double x_ray = which.x.back();
+	double y_ray = which.y.back();
 	double x_lens = ActualLens->getX();
 
 	double a = (y_image-y_ray)/(x_image-x_ray);
@@ -425,16 +1019,16 @@ void OpticalSystem::NextRayCoords(OpticalObject* ActualLens, Image ActualImage,
 	double x_ray_new = x_lens;
 	double y_ray_new = a*x_ray_new+b;
 
-	ray_coord[which].x.push_back(x_ray_new);
-	ray_coord[which].y.push_back(y_ray_new);
+	which.x.push_back(x_ray_new);
+	which.y.push_back(y_ray_new);
 }
 
 /**
- * @details This method returns a map containing the traced ray coordinates.
+ * @details This method returns a reference to the map containing the traced ray coordinates; copy it to keep it across calculations.
  * The map keys are ray identifiers (e.g., "ray_1", "ray_2"), and the values are `ray` structs holding x and y coordinate sequences.
  * @return A `std::map<std::string, ray>` containing the ray trace data.
  */
-map<string, ray> OpticalSystem::getRays(){
+const map<string, ray>& OpticalSystem::getRays(){
 	return ray_coord;
 }
 
@@ -445,23 +1039,74 @@ map<string, ray> OpticalSystem::getRays(){
  */
 map<string, OpticalObject*> OpticalSystem::getSystemElements(){
     std::map<string, OpticalObject*> copyMap;
-    for (const auto& [key, objPtr] : name_lens_map) {
-		ThinLens* ptr_thin = dynamic_cast<ThinLens*>(objPtr);
-		ThickLens* ptr_thick = dynamic_cast<ThickLens*>(objPtr);
-        if (ptr_thin) {
-            copyMap[key] = new ThinLens(ptr_thin->getX(),ptr_thin->getF());
-        }
-		else if (ptr_thick) {
-	    	copyMap[key] = new ThickLens(ptr_thick->getX(),
-	    								 ptr_thick->getN(),
-	    								 ptr_thick->getD(),
-	    								 ptr_thick->getR_Left(),
-	    								 ptr_thick->getR_Right());
-    	}
+    for (int id : order) {
+		const string& key = names.getName(id);
+		OpticalObject* objPtr = elements[id];
+		copyMap[key] = ElementRegistry::global().get(kinds[id]).clone(*objPtr);
 	}
+	OPTISIM_COUNT(COUNTER_ALLOCATIONS, copyMap.size());
     return copyMap;
 }
 
+/**
+ * @details The view reads the elements on demand and copies nothing, so it is cheap enough to be used on every repaint
+ * of a user interface. It stays bound to this system and must not outlive it.
+ */
+ElementRange OpticalSystem::getElements(){
+	return ElementRange(this);
+}
+
+/**
+ * @details This method returns the number of optical objects, the light source not included.
+ */
+size_t OpticalSystem::getElementCount(){
+	return order.size();
+}
+
+/**
+ * @details The element is looked up by the name at the given position of the optical order; no memory is allocated.
+ * @param index The position of the element in the optical order.
+ * @throws OptiSimError If the index is not smaller than the number of elements.
+ */
+element_info OpticalSystem::getElement(size_t index){
+	if (index >= order.size()) throw OptiSimError("ERROR: \tInvalid element index: " + to_string(index));
+	OpticalObject* element = elements[order[index]];
+	const double none = numeric_limits<double>::quiet_NaN();
+	element_info info = {names.getName(order[index]), ELEMENT_THIN_LENS, element->getX(), none, none, none, none, none,
+	                     element->getY(), element->getZ(), element->getTiltY(), element->getTiltZ(), element->getAperture()};
+	const element_class& type = ElementRegistry::global().get(kinds[order[index]]);
+	info.type = (element_type)type.id;
+	if (type.describe) type.describe(*element, info);
+	return info;
+}
+
+/**
+ * @details The arrays are written in optical order, one entry per element, as in `getElement`. Any array may be
+ * `nullptr` to skip that column. At most `capacity` elements are written; `getElementCount` tells how many there are.
+ * @param type The output array of element types, as `element_type` values.
+ * @param x The output array of positions.
+ * @param f The output array of focal lengths (NaN for stops).
+ * @param n The output array of refractive indices (NaN for thin lenses).
+ * @param d The output array of thicknesses (NaN for thin lenses).
+ * @param r_left The output array of left radii (NaN for thin lenses).
+ * @param r_right The output array of right radii (NaN for thin lenses).
+ * @param capacity The number of entries every non-null array can hold.
+ */
+size_t OpticalSystem::exportElements(int* type, double* x, double* f, double* n, double* d, double* r_left, double* r_right, size_t capacity){
+	size_t count = min(capacity, order.size());
+	for (size_t i = 0; i < count; i++) {
+		element_info info = getElement(i);
+		if (type) type[i] = info.type;
+		if (x) x[i] = info.x;
+		if (f) f[i] = info.f;
+		if (n) n[i] = info.n;
+		if (d) d[i] = info.d;
+		if (r_left) r_left[i] = info.r_left;
+		if (r_right) r_right[i] = info.r_right;
+	}
+	return count;
+}
+
 /**
  * @details This method retrieves a copy of the `LightSource` currently in the system.
  * @return A `LightSource` object representing the current light source.
@@ -469,5 +1114,73 @@ map<string, OpticalObject*> OpticalSystem::getSystemElements(){
  */
 LightSource OpticalSystem::getLightSource(){
 	if (LS == nullptr) throw OptiSimError("ERROR: \tNo light source present.");
-	return LightSource(LS->getX(), LS->getY());
+	return LightSource(LS->getX(), LS->getY(), LS->getZ());
+}
+
+
+// Element views --------------------------------------------------------------
+/**
+ * @param system The system to walk.
+ * @param index The position in the optical order.
+ */
+ElementIterator::ElementIterator(OpticalSystem* system, size_t index){
+	this->system = system;
+	this->index = index;
+}
+
+/**
+ * @details The description is built when the iterator is dereferenced, so it reflects the current parameters.
+ */
+element_info ElementIterator::operator*() const{
+	return system->getElement(index);
+}
+
+/**
+ * @details This operator advances the iterator to the next element in optical order.
+ */
+ElementIterator& ElementIterator::operator++(){
+	index++;
+	return *this;
+}
+
+/**
+ * @param other The iterator to compare with.
+ */
+bool ElementIterator::operator==(const ElementIterator& other) const{
+	return system == other.system && index == other.index;
+}
+
+/**
+ * @param other The iterator to compare with.
+ */
+bool ElementIterator::operator!=(const ElementIterator& other) const{
+	return !(*this == other);
+}
+
+/**
+ * @param system The system to view.
+ */
+ElementRange::ElementRange(OpticalSystem* system){
+	this->system = system;
+}
+
+/**
+ * @details This method returns an iterator at the first element in optical order.
+ */
+ElementIterator ElementRange::begin() const{
+	return ElementIterator(system, 0);
+}
+
+/**
+ * @details This method returns an iterator past the last element in optical order.
+ */
+ElementIterator ElementRange::end() const{
+	return ElementIterator(system, system->getElementCount());
+}
+
+/**
+ * @details This method returns the number of elements in the system.
+ */
+size_t ElementRange::size() const{
+	return system->getElementCount();
 }
@@ -0,0 +1,420 @@
+/**
+* @file Optimizer.cpp
+* @brief Implements the Optimizer class, a Levenberg-Marquardt designer for optical systems.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "Optimizer.h"
+#include <cmath>             // For std::abs, std::isinf, std::isfinite
+#include <limits>            // For std::numeric_limits
+#include <chrono>            // For timing the iteration loop
+#include <algorithm>         // For std::sort, std::min, std::max
+#include "OptiSimError.h"    // Custom exception class
+#include "ElementRegistry.h" // Parameters and kernels of the element types
+#include "Instrumentation.h" // Per-phase timers and counters
+
+using namespace std;
+
+// Slots of the local derivative tables: the position, then the parameters in the schema of the element's type.
+static const int SLOT_X = 0;
+static const int SLOT_COUNT = 1 + ELEMENT_MAX_PARAMS;
+
+/**
+ * @details Creates an optimizer with no variables and no targets. The system is only referenced;
+ * it must outlive the optimizer.
+ * @param system The optical system whose parameters will be optimized.
+ */
+Optimizer::Optimizer(OpticalSystem& system){
+    this->system = &system;
+    max_iterations = 100;
+    tolerance = 1e-10;
+    ls_x = 0;
+    ls_y = 0;
+}
+
+/**
+ * @details Registers a free parameter. The element and the parameter name are only resolved
+ * when `run()` is called, so variables may be added before the element exists in the system.
+ * @param element The name of the element that owns the parameter.
+ * @param param The parameter name: "x", or a settable parameter in the schema of the element's type
+ * ("f" for thin lenses, "n", "d", "r_left", "r_right" for thick lenses).
+ * @param lower The lower bound of the parameter.
+ * @param upper The upper bound of the parameter.
+ * @throws OptiSimError If the lower bound is greater than the upper bound.
+ */
+void Optimizer::addVariable(string element, string param, double lower, double upper){
+    if(lower > upper) throw OptiSimError("ERROR: \tThe lower bound of " + element + "." + param + " is greater than its upper bound.");
+    variables.push_back({element, param, lower, upper, -1, -1});
+}
+
+/**
+ * @details Registers a merit function term. The residual of the term is `weight * (value - target)`.
+ * @param quantity The final image quantity: "x" (position), "y" (size) or "magnification".
+ * @param value The value the quantity should reach.
+ * @param weight The weight of the term in the merit function.
+ * @throws OptiSimError If `quantity` is not a known image quantity or the weight is not positive.
+ */
+void Optimizer::addTarget(string quantity, double value, double weight){
+    if(quantity != "x" && quantity != "y" && quantity != "magnification") throw OptiSimError("ERROR: \tInvalid target: " + quantity);
+    if(weight <= 0) throw OptiSimError("ERROR: \tThe weight of a target must be a positive number.");
+    targets.push_back({quantity, value, weight});
+}
+
+/**
+ * @param iterations The maximum number of Levenberg-Marquardt iterations.
+ * @throws OptiSimError If `iterations` is not positive.
+ */
+void Optimizer::setMaxIterations(int iterations){
+    if(iterations <= 0) throw OptiSimError("ERROR: \tThe number of iterations must be a positive number.");
+    max_iterations = iterations;
+}
+
+/**
+ * @details The run stops when the relative decrease of the merit function or the largest
+ * component of its gradient falls below this value.
+ * @param tolerance The relative convergence tolerance.
+ * @throws OptiSimError If `tolerance` is not positive.
+ */
+void Optimizer::setTolerance(double tolerance){
+    if(tolerance <= 0) throw OptiSimError("ERROR: \tThe tolerance must be a positive number.");
+    this->tolerance = tolerance;
+}
+
+/**
+ * @details Writes every variable into its working copy through the setters of the schema, so thick lenses
+ * recompute their focal length. The candidate is rejected if a setter refuses the value or if the
+ * elements no longer respect the ordering and the 0.001 mm minimum distance of `OpticalSystem::add`.
+ * @param params The parameter values, one per variable.
+ * @return True if the values describe a valid system.
+ */
+bool Optimizer::apply(const vector<double>& params){
+    try {
+        for(int j = 0; j < variables.size(); j++){
+            const variable& var = variables[j];
+            OpticalObject* element = elements[var.index];
+            if(var.slot == SLOT_X) element->setX(params[j]);
+            else types[var.index]->params[var.slot - 1].set(*element, params[j]);
+        }
+    } catch (OptiSimError&) {
+        return false;
+    }
+
+    for(int i = 0; i < elements.size(); i++){
+        if(abs(elements[i]->getX() - ls_x) < 0.001) return false;
+        if(i > 0 && elements[i]->getX() - elements[i-1]->getX() < 0.001) return false;
+    }
+    return true;
+}
+
+/**
+ * @details The image is computed with the element's own `Calculate` method, while the derivatives
+ * follow from differentiating the imaging equation
+ * $$ d_{im} = \frac{f s}{s - f}, \qquad y_{im} = -\frac{f}{s - f} y $$
+ * where $s = H_{left} - x_{object}$ and the image lies at $H_{right} + d_{im}$. The focal length, the principal planes
+ * and their derivatives with respect to the parameters of the element come from the kernel of its type in the
+ * `ElementRegistry`; every principal plane moves with the element. An element without optical power, such as an
+ * aperture stop, a plane mirror or a parallel plate, moves the image by the distance of its principal planes.
+ * @param i The index of the element in the working copy.
+ * @param x The position of the incoming image; replaced by the position of the outgoing image.
+ * @param y The height of the incoming image; replaced by the height of the outgoing image.
+ * @return False if the image is at infinity or otherwise not finite.
+ */
+bool Optimizer::propagate(int i, double& x, double& y){
+    OpticalObject* element = elements[i];
+
+    // local derivatives of the focal length and of the principal planes
+    double df[SLOT_COUNT] = {0};
+    double dh_left[SLOT_COUNT] = {0};
+    double dh_right[SLOT_COUNT] = {0};
+    principal_planes planes = types[i]->kernel(*element, df + 1, dh_left + 1, dh_right + 1);
+    double f = planes.f;
+    double h_left = planes.h_left;
+    double h_right = planes.h_right;
+    dh_left[SLOT_X] = dh_right[SLOT_X] = 1;
+
+    if(isinf(f)){
+        // without optical power the image is moved by the distance of the principal planes
+        if(!isfinite(h_left) || !isfinite(h_right)) return false;
+        x += h_right - h_left;
+        for(int j = 0; j < variables.size(); j++){
+            int slot = variables[j].index == i ? variables[j].slot : -1;
+            if(slot >= 0) dx[j] += dh_right[slot] - dh_left[slot];
+        }
+        return isfinite(x);
+    }
+    if(!isfinite(f)) return false;
+
+    Image img = element->Calculate(LightSource(x, y));
+    OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, 1);
+    double s = h_left - x;
+
+    if(isinf(s)){
+        // object at infinity: the image lies in the back focal plane with zero height
+        for(int j = 0; j < variables.size(); j++){
+            int slot = variables[j].index == i ? variables[j].slot : -1;
+            dx[j] = slot < 0 ? 0.0 : dh_right[slot] + df[slot];
+            dy[j] = 0.0;
+        }
+    } else {
+        double denominator = s - f;
+        if(abs(denominator) < numeric_limits<double>::epsilon()) return false;
+        double K = 1.0 / denominator;
+        double ddim_ds = -f * f * K * K;
+        double ddim_df = s * s * K * K;
+        double m = -f * K;
+        double dm_ds = f * K * K;
+        double dm_df = -s * K * K;
+
+        for(int j = 0; j < variables.size(); j++){
+            int slot = variables[j].index == i ? variables[j].slot : -1;
+            double l_h_left = slot < 0 ? 0.0 : dh_left[slot];
+            double l_h_right = slot < 0 ? 0.0 : dh_right[slot];
+            double l_f = slot < 0 ? 0.0 : df[slot];
+
+            double ds = l_h_left - dx[j];
+            double dx_new = l_h_right + ddim_ds * ds + ddim_df * l_f;
+            double dy_new = y * (dm_ds * ds + dm_df * l_f) + m * dy[j];
+            dx[j] = dx_new;
+            dy[j] = dy_new;
+        }
+    }
+
+    x = img.getX();
+    y = img.getY();
+    return isfinite(x) && isfinite(y);
+}
+
+/**
+ * @details Traces the light source through the working copies, mirroring the element selection
+ * of `OpticalSystem::Calculate()`, and fills `residuals` and `jacobian`.
+ * @return False if the final image cannot be evaluated.
+ */
+bool Optimizer::evaluate(){
+    int k = variables.size();
+    fill(dx.begin(), dx.end(), 0.0);
+    fill(dy.begin(), dy.end(), 0.0);
+
+    int start = 0;
+    while(start < elements.size() && ls_x > elements[start]->getX()) start++;
+    if(start == elements.size()) return false;
+
+    double x = ls_x;
+    double y = ls_y;
+    for(int i = start; i < elements.size(); i++){
+        if(!propagate(i, x, y)) return false;
+    }
+
+    for(int t = 0; t < targets.size(); t++){
+        double w = targets[t].weight;
+        if(targets[t].quantity == "x"){
+            residuals[t] = w * (x - targets[t].value);
+            for(int j = 0; j < k; j++) jacobian[t*k + j] = w * dx[j];
+        } else if(targets[t].quantity == "y"){
+            residuals[t] = w * (y - targets[t].value);
+            for(int j = 0; j < k; j++) jacobian[t*k + j] = w * dy[j];
+        } else {
+            residuals[t] = w * (y / ls_y - targets[t].value);
+            for(int j = 0; j < k; j++) jacobian[t*k + j] = w * dy[j] / ls_y;
+        }
+    }
+    return true;
+}
+
+/**
+ * @details Deletes the working copies created by `run()`.
+ */
+void Optimizer::clear(){
+    for(int i = 0; i < elements.size(); i++){
+        delete elements[i];
+    }
+    elements.clear();
+    types.clear();
+}
+
+/**
+ * @details Copies the system elements once, resolves the variables and then iterates
+ * $$ (J^T J + \lambda\, \mathrm{diag}(J^T J))\, \delta = -J^T r $$
+ * projecting every step onto the variable bounds. Steps that increase the merit function or lead to an
+ * invalid system are rejected and the damping factor is increased; accepted steps decrease it.
+ * The accepted solution is written back to the system with `modifyOpticalObject`; positions are
+ * written in an order that never brings two elements closer than their start and end positions.
+ * @return An `optimization_result` with the iteration count, merit values and throughput.
+ * @throws OptiSimError If there is nothing to optimize, if the system has decentered or tilted elements, if a
+ * variable refers to an unknown element or parameter, or if the starting point cannot be evaluated.
+ */
+optimization_result Optimizer::run(){
+    if(variables.size() == 0) throw OptiSimError("ERROR: \tYou have to add variables to the Optimizer before calling the run() method.");
+    if(targets.size() == 0) throw OptiSimError("ERROR: \tYou have to add targets to the Optimizer before calling the run() method.");
+
+    LightSource ls = system->getLightSource();
+    ls_x = ls.getX();
+    ls_y = ls.getY();
+    // the derivatives are those of the on-axis formulas
+    bool centered = ls.getZ() == 0;
+    for (const element_info& info : system->getElements()) centered = centered && info.y == 0 && info.z == 0 && info.tilt_y == 0 && info.tilt_z == 0;
+    if(!centered) throw OptiSimError("ERROR: \tThe Optimizer supports centered systems only.");
+    for(int t = 0; t < targets.size(); t++){
+        if(targets[t].quantity == "magnification" && ls_y == 0) throw OptiSimError("ERROR: \tThe magnification cannot be targeted with a light source of zero size.");
+    }
+
+    // working copies in optical order
+    clear();
+    map<string, OpticalObject*> copies = system->getSystemElements();
+    vector<pair<double, string>> positions;
+    for (const auto& [name, objPtr] : copies) positions.push_back({objPtr->getX(), name});
+    sort(positions.begin(), positions.end());
+    for (const auto& [position, name] : positions) {
+        elements.push_back(copies[name]);
+        types.push_back(&ElementRegistry::global().of(*copies[name]));
+    }
+
+    int k = variables.size();
+    int m = targets.size();
+    vector<double> params(k);
+    for(int j = 0; j < k; j++){
+        variable& var = variables[j];
+        var.index = -1;
+        for(int i = 0; i < positions.size(); i++){
+            if(positions[i].second == var.element) var.index = i;
+        }
+        if(var.index < 0) throw OptiSimError("ERROR: \tInvalid key: " + var.element);
+
+        if(var.param == "x"){
+            var.slot = SLOT_X;
+            params[j] = elements[var.index]->getX();
+        } else {
+            // the settable parameters of the element's type
+            const element_class& type = *types[var.index];
+            int param_index = type.param(var.param);
+            if(param_index < 0 || !type.params[param_index].set) throw OptiSimError("ERROR: \tInvalid parameter: " + var.param);
+            var.slot = param_index + 1;
+            params[j] = type.params[param_index].get(*elements[var.index]);
+        }
+        params[j] = min(max(params[j], var.lower), var.upper);
+    }
+
+    dx.assign(k, 0.0);
+    dy.assign(k, 0.0);
+    residuals.assign(m, 0.0);
+    jacobian.assign(m * k, 0.0);
+    vector<double> normal(k * k), gradient(k), system_matrix(k * k), step(k), trial(k);
+
+    optimization_result result = {0, 1, false, 0, 0, 0, 0};
+    if(!apply(params) || !evaluate()) throw OptiSimError("ERROR: \tThe starting point of the optimization cannot be evaluated.");
+
+    auto merit = [&](){
+        double sum = 0;
+        for(int t = 0; t < m; t++) sum += residuals[t] * residuals[t];
+        return 0.5 * sum;
+    };
+    auto build_normal = [&](){
+        for(int a = 0; a < k; a++){
+            gradient[a] = 0;
+            for(int t = 0; t < m; t++) gradient[a] += jacobian[t*k + a] * residuals[t];
+            for(int b = 0; b < k; b++){
+                normal[a*k + b] = 0;
+                for(int t = 0; t < m; t++) normal[a*k + b] += jacobian[t*k + a] * jacobian[t*k + b];
+            }
+        }
+    };
+
+    double cost = merit();
+    result.initial_merit = cost;
+    double lambda = 1e-3;
+    build_normal();
+
+    auto begin = chrono::steady_clock::now();
+    while(result.iterations < max_iterations){
+        double largest = 0;
+        for(int j = 0; j < k; j++) largest = max(largest, abs(gradient[j]));
+        if(cost <= numeric_limits<double>::min() || largest <= tolerance * (1 + cost)){
+            result.converged = true;
+            break;
+        }
+        result.iterations++;
+
+        bool accepted = false;
+        double new_cost = cost;
+        while(!accepted && lambda < 1e16){
+            // solve the damped normal equations with Gaussian elimination
+            for(int a = 0; a < k; a++){
+                for(int b = 0; b < k; b++) system_matrix[a*k + b] = normal[a*k + b];
+                system_matrix[a*k + a] += lambda * (normal[a*k + a] + 1e-12);
+                step[a] = -gradient[a];
+            }
+            for(int c = 0; c < k; c++){
+                int pivot = c;
+                for(int r = c + 1; r < k; r++){
+                    if(abs(system_matrix[r*k + c]) > abs(system_matrix[pivot*k + c])) pivot = r;
+                }
+                if(pivot != c){
+                    for(int b = 0; b < k; b++) swap(system_matrix[c*k + b], system_matrix[pivot*k + b]);
+                    swap(step[c], step[pivot]);
+                }
+                for(int r = c + 1; r < k; r++){
+                    double factor = system_matrix[r*k + c] / system_matrix[c*k + c];
+                    for(int b = c; b < k; b++) system_matrix[r*k + b] -= factor * system_matrix[c*k + b];
+                    step[r] -= factor * step[c];
+                }
+            }
+            for(int c = k - 1; c >= 0; c--){
+                for(int b = c + 1; b < k; b++) step[c] -= system_matrix[c*k + b] * step[b];
+                step[c] /= system_matrix[c*k + c];
+            }
+
+            for(int j = 0; j < k; j++) trial[j] = min(max(params[j] + step[j], variables[j].lower), variables[j].upper);
+            result.evaluations++;
+            if(apply(trial) && evaluate()){
+                new_cost = merit();
+                accepted = new_cost < cost;
+            }
+            if(!accepted) lambda *= 10;
+        }
+
+        if(!accepted){
+            // no descent direction left inside the bounds
+            result.converged = true;
+            break;
+        }
+
+        double decrease = cost - new_cost;
+        params = trial;
+        cost = new_cost;
+        lambda = max(lambda / 10, 1e-15);
+        build_normal();
+        if(decrease <= tolerance * (cost + decrease)){
+            result.converged = true;
+            break;
+        }
+    }
+    auto end = chrono::steady_clock::now();
+
+    result.final_merit = cost;
+    result.elapsed_seconds = chrono::duration<double>(end - begin).count();
+    result.iterations_per_second = result.elapsed_seconds > 0 ? result.iterations / result.elapsed_seconds : 0;
+
+    // write back: other parameters first, then positions moving right (rightmost first)
+    // and positions moving left (leftmost first)
+    vector<int> right_moves, left_moves;
+    for(int j = 0; j < k; j++){
+        if(variables[j].slot != SLOT_X) system->modifyOpticalObject(variables[j].element, variables[j].param, params[j]);
+        else if(params[j] > positions[variables[j].index].first) right_moves.push_back(j);
+        else if(params[j] < positions[variables[j].index].first) left_moves.push_back(j);
+    }
+    sort(right_moves.begin(), right_moves.end(), [&](int a, int b){ return variables[a].index > variables[b].index; });
+    sort(left_moves.begin(), left_moves.end(), [&](int a, int b){ return variables[a].index < variables[b].index; });
+    for(int j : right_moves) system->modifyOpticalObject(variables[j].element, "x", params[j]);
+    for(int j : left_moves) system->modifyOpticalObject(variables[j].element, "x", params[j]);
+
+    clear();
+    return result;
+}
+
+/**
+ * @details Releases the working copies of the elements, if a run left any behind.
+ */
+Optimizer::~Optimizer(){
+    clear();
+}
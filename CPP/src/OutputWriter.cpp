@@ -0,0 +1,222 @@
+/**
+* @file OutputWriter.cpp
+* @brief Implements the OutputWriter class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "OutputWriter.h"
+#include <cstring>           // For std::memcpy, std::strlen
+#include <sstream>           // For the stream formatting fallback
+
+using namespace std;
+
+/**
+ * @brief The longest number the writer formats: a fixed-notation double near the largest double with many decimals.
+ */
+static const size_t max_number_size = 400;
+
+/**
+ * @brief The buffer shared by the writers of a thread.
+ */
+static thread_local vector<char> thread_buffer;
+
+/**
+ * @brief True while a writer of the thread uses `thread_buffer`.
+ */
+static thread_local bool thread_buffer_used = false;
+
+/**
+ * @details The writer takes the formatting state of the stream for `operator<<`, so it prints doubles exactly
+ * as the stream would. The stream is not modified.
+ * @param os The destination stream.
+ * @param capacity The size of the buffer in bytes; at least 4096 bytes are used.
+ */
+OutputWriter::OutputWriter(ostream& os, size_t capacity) : os(os){
+    capacity = max(capacity, (size_t)4096);
+    shared = !thread_buffer_used;
+    if (shared) {
+        thread_buffer_used = true;
+        buffer = &thread_buffer;
+    } else {
+        buffer = &own_buffer;
+    }
+    if (buffer->size() < capacity) buffer->resize(capacity);
+    used = 0;
+
+    flags = os.flags();
+    precision = os.precision();
+    ios_base::fmtflags floatfield = flags & ios_base::floatfield;
+    if (floatfield == ios_base::fixed) format = chars_format::fixed;
+    else if (floatfield == ios_base::scientific) format = chars_format::scientific;
+    else format = chars_format::general;
+    stream_format = floatfield == (ios_base::fixed | ios_base::scientific) || precision > 60 ||
+                    (flags & (ios_base::showpos | ios_base::showpoint | ios_base::uppercase));
+}
+
+/**
+ * @details The buffered bytes are written to the stream, and the shared buffer is released for the next writer.
+ */
+OutputWriter::~OutputWriter(){
+    flush();
+    if (shared) thread_buffer_used = false;
+}
+
+/**
+ * @param size The number of bytes that will be appended.
+ */
+void OutputWriter::reserve(size_t size){
+    if (used + size <= buffer->size()) return;
+    flush();
+    if (size > buffer->size()) buffer->resize(size);
+}
+
+/**
+ * @param text The characters.
+ * @param size The number of characters.
+ * @param width The minimum width; shorter text is padded with spaces.
+ * @param left True to pad on the right, false to pad on the left.
+ */
+void OutputWriter::append(const char* text, size_t size, int width, bool left){
+    size_t padding = width > (int)size ? width - size : 0;
+    reserve(size + padding);
+    char* out = buffer->data() + used;
+    if (!left) {
+        memset(out, ' ', padding);
+        out += padding;
+    }
+    memcpy(out, text, size);
+    out += size;
+    if (left) memset(out, ' ', padding);
+    used += size + padding;
+}
+
+/**
+ * @param text The text.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(const string& text){
+    append(text.data(), text.size(), 0, true);
+    return *this;
+}
+
+/**
+ * @param text The null-terminated text.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(const char* text){
+    append(text, strlen(text), 0, true);
+    return *this;
+}
+
+/**
+ * @param c The character.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(char c){
+    append(&c, 1, 0, true);
+    return *this;
+}
+
+/**
+ * @details The output matches `ostream << value` for the stream state captured by the constructor.
+ * @param value The number.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(double value){
+    if (stream_format) {
+        ostringstream ss;
+        ss.flags(flags);
+        ss.precision(precision);
+        ss << value;
+        return *this << ss.str();
+    }
+    // the stream prints the default notation with at least one significant digit, as printf("%g") does
+    char number[max_number_size];
+    to_chars_result result = to_chars(number, number + sizeof(number), value, format, precision);
+    append(number, result.ptr - number, 0, true);
+    return *this;
+}
+
+/**
+ * @param value The number.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(long long value){
+    char number[24];
+    to_chars_result result = to_chars(number, number + sizeof(number), value);
+    append(number, result.ptr - number, 0, true);
+    return *this;
+}
+
+/**
+ * @param value The number.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(int value){
+    return *this << (long long)value;
+}
+
+/**
+ * @param value The number.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(size_t value){
+    char number[24];
+    to_chars_result result = to_chars(number, number + sizeof(number), value);
+    append(number, result.ptr - number, 0, true);
+    return *this;
+}
+
+/**
+ * @details The value is written as the stream writes booleans without `boolalpha`.
+ * @param value The value.
+ * @return This writer.
+ */
+OutputWriter& OutputWriter::operator<<(bool value){
+    return *this << (value ? '1' : '0');
+}
+
+/**
+ * @details The output matches `os << right << fixed << setprecision(precision) << setw(width) << value`.
+ * @param value The number.
+ * @param precision The number of decimals.
+ * @param width The minimum width.
+ */
+void OutputWriter::writeFixed(double value, int precision, int width){
+    char number[max_number_size];
+    to_chars_result result = to_chars(number, number + sizeof(number), value, chars_format::fixed, min(precision, 60));
+    append(number, result.ptr - number, width, false);
+}
+
+/**
+ * @details The output matches `os << right << defaultfloat << setprecision(precision) << setw(width) << value`.
+ * @param value The number.
+ * @param precision The number of significant digits.
+ * @param width The minimum width.
+ */
+void OutputWriter::writeGeneral(double value, int precision, int width){
+    char number[max_number_size];
+    to_chars_result result = to_chars(number, number + sizeof(number), value, chars_format::general, min(precision, 60));
+    append(number, result.ptr - number, width, false);
+}
+
+/**
+ * @details The output matches `os << setw(width) << text` with `left` or `right` alignment.
+ * @param text The text.
+ * @param width The minimum width.
+ * @param left True to pad on the right, false to pad on the left.
+ */
+void OutputWriter::writeText(const string& text, int width, bool left){
+    append(text.data(), text.size(), width, left);
+}
+
+/**
+ * @details The stream itself is not flushed; it is written in one call per buffer.
+ */
+void OutputWriter::flush(){
+    if (used == 0) return;
+    os.write(buffer->data(), used);
+    used = 0;
+}
@@ -0,0 +1,105 @@
+/**
+* @file ParallelPlate.cpp
+* @brief Implementation of the ParallelPlate class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "ParallelPlate.h"
+#include <limits>           // For std::numeric_limits
+#include "OptiSimError.h"   // Custom exception class
+
+using namespace std;
+
+/**
+ * @param x The position of the middle of the plate on the optical axis.
+ * @param n The refractive index of the plate.
+ * @param d The thickness of the plate.
+ * @throws OptiSimError If the refractive index or the thickness is not positive.
+ */
+ParallelPlate::ParallelPlate(double x, double n, double d):OpticalObject(x){
+    setN(n);
+    setD(d);
+}
+
+/**
+ * @details The image is the subject moved along the axis by the shift of the plate, with the same height.
+ * Like for a lens, it counts as real if it lies behind the plate, which happens when the subject does.
+ * @param is The subject.
+ */
+Image ParallelPlate::Calculate(const ImagingSubject& is){
+    double shift = getShift();
+    return Image(is.getX() + shift, is.getY(), is.getX() > x - shift / 2);
+}
+
+/**
+ * @details The refractive index of a plate does not depend on the wavelength, so every lane is moved by the same shift.
+ * The subject heights are left as they are.
+ * @param x The subject positions on entry, the image positions on exit.
+ * @param real The real (1) or virtual (0) status of each image on exit.
+ * @param count The number of wavelengths.
+ */
+void ParallelPlate::CalculateSpectrum(const double* /* wavelengths */, double* x, double* /* y */, char* real, size_t count){
+    const double shift = getShift();
+    const double first = this->x - shift / 2;
+    for(size_t i = 0; i < count; i++){
+        real[i] = x[i] > first;
+        x[i] += shift;
+    }
+}
+
+/**
+ * @details A plate acts like its principal planes, which are `d (1 - 1/n)` apart around its middle and have no power:
+ * a ray keeps its slope and is moved along the axis by the shift.
+ * @param x The x-coordinates of the rays.
+ * @param y The y-coordinates of the rays.
+ * @param z The z-coordinates of the rays.
+ * @param u The slopes dy/dx of the rays.
+ * @param v The slopes dz/dx of the rays.
+ * @param vignetted Set to 1 for every ray outside the aperture, 0 for the others.
+ * @param count The number of rays.
+ */
+void ParallelPlate::TraceRays(double* x, double* y, double* z, double* u, double* v, char* vignetted, size_t count){
+    double shift = getShift();
+    TracePrincipalPlanes(-shift / 2, shift / 2, numeric_limits<double>::infinity(), x, y, z, u, v, vignetted, count);
+}
+
+/**
+ * @details This method returns the refractive index of the plate.
+ */
+double ParallelPlate::getN() const{
+    return n;
+}
+
+/**
+ * @param n The new refractive index.
+ * @throws OptiSimError If the refractive index is not positive.
+ */
+void ParallelPlate::setN(double n){
+    if (!(n > 0)) throw OptiSimError("ERROR: \tThe refractive index must be a positive number.");
+    this->n = n;
+}
+
+/**
+ * @details This method returns the thickness of the plate.
+ */
+double ParallelPlate::getD() const{
+    return d;
+}
+
+/**
+ * @param d The new thickness.
+ * @throws OptiSimError If the thickness is not positive.
+ */
+void ParallelPlate::setD(double d){
+    if (!(d > 0)) throw OptiSimError("ERROR: \tThe thickness of the plate must be a positive number.");
+    this->d = d;
+}
+
+/**
+ * @details This method returns `d (1 - 1/n)`, which is negative for an index below 1.
+ */
+double ParallelPlate::getShift() const{
+    return d * (1 - 1 / n);
+}
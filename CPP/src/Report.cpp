@@ -0,0 +1,310 @@
+/**
+* @file Report.cpp
+* @brief Implements the Report class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "Report.h"
+#include <cstring>           // For std::memcpy
+#include <cstdint>           // For the fixed-width binary fields
+#include <cmath>             // For NAN
+#include <nlohmann/json.hpp> // Assumes nlohmann/json library is installed
+#include "Instrumentation.h" // Per-phase timers and counters
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * @brief Looks up a traced ray, or an empty one if the system has not been calculated.
+ */
+static const ray& find_ray(const map<string, ray>& rays, const string& name){
+    static const ray empty;
+    auto it = rays.find(name);
+    return it == rays.end() ? empty : it->second;
+}
+
+/**
+ * @brief Appends an unsigned integer to a buffer in little-endian byte order.
+ */
+static void put_u64(string& buffer, uint64_t value, int bytes = 8){
+    for (int i = 0; i < bytes; i++) buffer.push_back((char)((value >> (8 * i)) & 0xff));
+}
+
+/**
+ * @brief Appends a double to a buffer as its IEEE 754 bit pattern in little-endian byte order.
+ */
+static void put_double(string& buffer, double value){
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u64(buffer, bits);
+}
+
+/**
+ * @details The table lists the position, height and real/virtual status of the image formed by each
+ * optical object, with six decimals. If any image lies out of the meridional plane, a column of the
+ * z-coordinates follows the heights.
+ * @param system The calculated system.
+ * @param os The output stream.
+ */
+void Report::writeImageList(OpticalSystem& system, ostream& os){
+    OutputWriter writer(os);
+    writeImageList(system, writer);
+}
+
+/**
+ * @param system The calculated system.
+ * @param os The writer.
+ */
+void Report::writeImageList(OpticalSystem& system, OutputWriter& os){
+    const vector<Image>& imageSequence = system.getImageSequence();
+    bool off_plane = false;
+    for (const Image& image : imageSequence) off_plane = off_plane || image.getZ() != 0;
+    os << "#\tImages"
+    << "\n-------------------------------------------------------------------------------\n";
+    os.writeText("X coordinate", 15);
+    os.writeText("Y coordinate", 15);
+    if (off_plane) os.writeText("Z coordinate", 15);
+    os << "Is real?" << "\n\n";
+
+    for (const Image& image : imageSequence) {
+        os.writeFixed(image.getX(), 6, 12);
+        os.writeFixed(image.getY(), 6, 15);
+        if (off_plane) os.writeFixed(image.getZ(), 6, 15);
+        os.writeText(image.getReal() ? "1" : "0", 10, false);
+        os << "\n";
+    }
+    os << "\n-------------------------------------------------------------------------------\n";
+}
+
+/**
+ * @details The table lists the coordinates of the two traced rays side by side, with six decimals.
+ * @param system The calculated system.
+ * @param os The output stream.
+ */
+void Report::writeRays(OpticalSystem& system, ostream& os){
+    OutputWriter writer(os);
+    writeRays(system, writer);
+}
+
+/**
+ * @param system The calculated system.
+ * @param os The writer.
+ */
+void Report::writeRays(OpticalSystem& system, OutputWriter& os){
+    const map<string, ray>& rays = system.getRays();
+    const ray& ray_1 = find_ray(rays, "ray_1");
+    const ray& ray_2 = find_ray(rays, "ray_2");
+    os << "#\tRays"
+    << "\n-------------------------------------------------------------------------------\n";
+    os.writeText("Ray 1", 16, false);
+    os.writeText("Ray 2", 30, false);
+    os << "\n\n";
+    os.writeText("X coordinate", 15);
+    os.writeText("Y coordinate", 15);
+    os.writeText("X coordinate", 15);
+    os.writeText("Y coordinate", 15);
+    os << "\n\n";
+    for (size_t i = 0; i < ray_1.x.size(); i++){
+        os.writeFixed(ray_1.x[i], 6, 12);
+        os.writeFixed(ray_1.y[i], 6, 15);
+        os.writeFixed(ray_2.x[i], 6, 15);
+        os.writeFixed(ray_2.y[i], 6, 15);
+        os << "\n";
+    }
+    os << "\n-------------------------------------------------------------------------------\n";
+}
+
+/**
+ * @details This is the content of the output file of the `OptiSim` command-line tool. In the text format the
+ * summary is followed by the requested tables; the other formats are written by `writeJson`, `writeCsv` and
+ * `writeBinary`. The writing is timed as the output phase.
+ * @param system The calculated system.
+ * @param os The output stream.
+ * @param image_list True to append the image list.
+ * @param rays True to append the ray coordinates.
+ * @param format The output format.
+ */
+void Report::write(OpticalSystem& system, ostream& os, bool image_list, bool rays, report_format format){
+    if (format == FORMAT_JSON) writeJson(system, os, image_list, rays);
+    else if (format == FORMAT_CSV) writeCsv(system, os, image_list, rays);
+    else if (format == FORMAT_BINARY) writeBinary(system, os, image_list, rays);
+    else {
+        OPTISIM_TIME_SCOPE(PHASE_OUTPUT);
+        OutputWriter writer(os);
+        system.toString(writer);
+        if (image_list) writeImageList(system, writer);
+        if (rays) writeRays(system, writer);
+    }
+}
+
+/**
+ * @param name The name of the format.
+ * @throws OptiSimError If the name is not "text", "json", "csv" or "bin".
+ */
+report_format Report::parseFormat(const string& name){
+    if (name == "text") return FORMAT_TEXT;
+    if (name == "json") return FORMAT_JSON;
+    if (name == "csv") return FORMAT_CSV;
+    if (name == "bin") return FORMAT_BINARY;
+    throw OptiSimError("ERROR: \tInvalid output format: " + name);
+}
+
+/**
+ * @details The table has the header `kind,index,x,y,z,real` and one row per point: `image` rows for the images
+ * formed by the optical objects (the last one being the final image), and `ray_1` and `ray_2` rows for the
+ * points of the two traced rays, which lie in the meridional plane and leave the `z` and `real` columns empty. Without the image list only the final image is
+ * written. Numbers are written with 17 significant digits, so they read back as the same doubles.
+ * The writing is timed as the output phase.
+ * @param system The calculated system.
+ * @param os The output stream.
+ * @param image_list True to write every image instead of only the final one.
+ * @param rays True to add the ray coordinates.
+ */
+void Report::writeCsv(OpticalSystem& system, ostream& os, bool image_list, bool rays){
+    OPTISIM_TIME_SCOPE(PHASE_OUTPUT);
+    OutputWriter writer(os);
+    writer << "kind,index,x,y,z,real\n";
+    const vector<Image>& imageSequence = system.getImageSequence();
+    size_t first = image_list || imageSequence.empty() ? 0 : imageSequence.size() - 1;
+    for (size_t i = first; i < imageSequence.size(); i++) {
+        writer << "image," << i << ",";
+        writer.writeGeneral(imageSequence[i].getX(), 17);
+        writer << ",";
+        writer.writeGeneral(imageSequence[i].getY(), 17);
+        writer << ",";
+        writer.writeGeneral(imageSequence[i].getZ(), 17);
+        writer << "," << imageSequence[i].getReal() << "\n";
+    }
+    if (rays) {
+        for (auto& entry : system.getRays()) {
+            for (size_t i = 0; i < entry.second.x.size(); i++) {
+                writer << entry.first << "," << i << ",";
+                writer.writeGeneral(entry.second.x[i], 17);
+                writer << ",";
+                writer.writeGeneral(entry.second.y[i], 17);
+                writer << ",,\n";
+            }
+        }
+    }
+}
+
+/**
+ * @details All fields are little-endian, and every array starts at a multiple of 8 bytes from the start of the
+ * file, so the arrays can be mapped directly (e.g. with `numpy.frombuffer` or `mmap`).
+ *
+ * | Offset          | Type          | Content                                                           |
+ * |-----------------|---------------|-------------------------------------------------------------------|
+ * | 0               | char[8]       | The magic `OPTISIMB`.                                             |
+ * | 8               | uint32        | The layout version, 2.                                            |
+ * | 12              | uint32        | Flags: bit 0 set if the image list is present, bit 1 for the rays. |
+ * | 16              | uint64        | The number of images N (0 without the image list).                |
+ * | 24              | uint64        | The number of points M of each ray (0 without the rays).          |
+ * | 32              | float64       | The x coordinate of the final image.                              |
+ * | 40              | float64       | The y coordinate of the final image.                              |
+ * | 48              | float64       | The z coordinate of the final image.                              |
+ * | 56              | uint32        | 1 if the final image is real, 0 otherwise.                        |
+ * | 60              | uint32        | Reserved, 0.                                                      |
+ * | 64              | float64[N]    | The x coordinates of the images.                                  |
+ * | 64 + 8N         | float64[N]    | The y coordinates of the images.                                  |
+ * | 64 + 16N        | float64[N]    | The z coordinates of the images.                                  |
+ * | 64 + 24N        | uint8[N]      | 1 for each real image, 0 otherwise, padded with zeros to P = 8 * ceil(N / 8) bytes. |
+ * | 64 + 24N + P    | float64[M]    | The x coordinates of ray 1, followed by its y coordinates, and the x and y coordinates of ray 2. |
+ *
+ * Version 1 had no z coordinates. A system without images has a final image of (NaN, NaN, NaN, 0). The writing is timed as the output phase.
+ * @param system The calculated system.
+ * @param os The output stream, which should be opened in binary mode.
+ * @param image_list True to add the image list.
+ * @param rays True to add the ray coordinates.
+ */
+void Report::writeBinary(OpticalSystem& system, ostream& os, bool image_list, bool rays){
+    OPTISIM_TIME_SCOPE(PHASE_OUTPUT);
+    const vector<Image>& imageSequence = system.getImageSequence();
+    const map<string, ray>& ray_map = system.getRays();
+    uint64_t images = image_list ? imageSequence.size() : 0;
+    uint64_t points = rays ? find_ray(ray_map, "ray_1").x.size() : 0;
+    uint64_t padding = (8 - images % 8) % 8;
+
+    string buffer;
+    buffer.reserve(64 + 25 * images + padding + 32 * points);
+    buffer.append("OPTISIMB", 8);
+    put_u64(buffer, 2, 4);
+    put_u64(buffer, (image_list ? 1 : 0) | (rays ? 2 : 0), 4);
+    put_u64(buffer, images);
+    put_u64(buffer, points);
+    if (imageSequence.empty()) {
+        put_double(buffer, NAN);
+        put_double(buffer, NAN);
+        put_double(buffer, NAN);
+        put_u64(buffer, 0, 4);
+    } else {
+        put_double(buffer, imageSequence.back().getX());
+        put_double(buffer, imageSequence.back().getY());
+        put_double(buffer, imageSequence.back().getZ());
+        put_u64(buffer, imageSequence.back().getReal(), 4);
+    }
+    put_u64(buffer, 0, 4);
+
+    for (uint64_t i = 0; i < images; i++) put_double(buffer, imageSequence[i].getX());
+    for (uint64_t i = 0; i < images; i++) put_double(buffer, imageSequence[i].getY());
+    for (uint64_t i = 0; i < images; i++) put_double(buffer, imageSequence[i].getZ());
+    for (uint64_t i = 0; i < images; i++) buffer.push_back(imageSequence[i].getReal() ? 1 : 0);
+    buffer.append(padding, '\0');
+    if (points) {
+        for (const char* name : {"ray_1", "ray_2"}) {
+            for (double x : find_ray(ray_map, name).x) put_double(buffer, x);
+            for (double y : find_ray(ray_map, name).y) put_double(buffer, y);
+        }
+    }
+    os.write(buffer.data(), buffer.size());
+}
+
+/**
+ * @details The object holds the position, height and real/virtual status of the image; the z-coordinate is only
+ * written for images out of the meridional plane.
+ * @param image The image.
+ * @return The JSON object of the image.
+ */
+json Report::imageJson(const Image& image){
+    json result = {{"x", image.getX()}, {"y", image.getY()}, {"real", image.getReal()}};
+    if (image.getZ() != 0) result["z"] = image.getZ();
+    return result;
+}
+
+/**
+ * @details The line has the form `{"image": {"x": ..., "y": ..., "real": ...}, "images": [...], "rays": {"ray_1":
+ * {"x": [...], "y": [...]}, "ray_2": {...}}}`, where `images` and `rays` are present only when requested, and is
+ * terminated by a newline. Numbers are written with the fewest digits that read back as the same double;
+ * coordinates that are not finite, such as the height of an image at infinity, are written as `null`.
+ * The writing is timed as the output phase.
+ * @param system The calculated system.
+ * @param os The output stream.
+ * @param image_list True to add the image list.
+ * @param rays True to add the ray coordinates.
+ */
+void Report::writeJson(OpticalSystem& system, ostream& os, bool image_list, bool rays){
+    OPTISIM_TIME_SCOPE(PHASE_OUTPUT);
+    const vector<Image>& imageSequence = system.getImageSequence();
+    json result;
+    result["image"] = imageSequence.empty() ? json(nullptr) : imageJson(imageSequence.back());
+    if (image_list) {
+        result["images"] = json::array();
+        for (const Image& image : imageSequence) result["images"].push_back(imageJson(image));
+    }
+    if (rays) {
+        result["rays"] = json::object();
+        for (auto& entry : system.getRays()) result["rays"][entry.first] = {{"x", entry.second.x}, {"y", entry.second.y}};
+    }
+    os << result.dump() << "\n";
+}
+
+/**
+ * @details The line has the form `{"error": "..."}` and is terminated by a newline.
+ * @param message The error message.
+ * @param os The output stream.
+ */
+void Report::writeJsonError(const string& message, ostream& os){
+    os << json({{"error", message}}).dump() << "\n";
+}
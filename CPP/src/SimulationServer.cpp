@@ -0,0 +1,275 @@
+/**
+* @file SimulationServer.cpp
+* @brief Implements the SimulationServer class and its event loop.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "SimulationServer.h"
+#include <vector>            // For the connected clients
+#include <cstring>           // For std::strerror
+#include <cerrno>            // For errno
+#include <poll.h>            // For the event loop
+#include <fcntl.h>           // For non-blocking descriptors
+#include <unistd.h>          // For read, write, close, unlink
+#include <sys/socket.h>      // For the listening socket
+#include <sys/un.h>          // For Unix socket addresses
+#include <nlohmann/json.hpp> // Assumes nlohmann/json library is installed
+#include "ElementRegistry.h" // Elements added by commands
+#include "Report.h"          // The JSON form of images
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * @brief The longest accepted request line; a client sending a longer one is disconnected.
+ */
+static const size_t max_request_size = 16 * 1024 * 1024;
+
+/**
+ * @brief How long the server waits for a client to accept more of its pending responses when shutting down, in milliseconds.
+ */
+static const int drain_timeout_ms = 5000;
+
+/**
+ * @brief A connected client of the event loop.
+ */
+struct server_client {
+    /** @brief The socket of the client. */
+    int fd;
+    /** @brief The bytes received but not yet forming a complete line. */
+    string input;
+    /** @brief The responses not yet sent. */
+    string output;
+    /** @brief True once the client has finished sending; it is closed when its responses are sent. */
+    bool eof;
+};
+
+/**
+ * @brief Sends as much of the pending responses of a client as its socket accepts.
+ * @return False if the connection failed.
+ */
+static bool send_pending(server_client& client){
+    while (!client.output.empty()) {
+        ssize_t n = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+        if (n > 0) client.output.erase(0, n);
+        else return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    return true;
+}
+
+/**
+ * @brief Switches a descriptor to non-blocking mode.
+ * @throws OptiSimError If the mode cannot be set.
+ */
+static void set_nonblocking(int fd){
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) throw OptiSimError("ERROR: \tfcntl failed: " + string(strerror(errno)));
+}
+
+/**
+ * @details Creates a server without resident systems.
+ */
+SimulationServer::SimulationServer(){
+    running = false;
+    wake_fd = -1;
+}
+
+/**
+ * @param name The name of the resident system, which is replaced.
+ * @param file_name The path of the system file.
+ * @throws OptiSimError If the system file cannot be loaded.
+ */
+void SimulationServer::load(const string& name, const string& file_name){
+    systems[name] = make_unique<OpticalSystem>(file_name);
+}
+
+/**
+ * @details Errors of the command, including malformed JSON and missing arguments, are reported in the
+ * response rather than thrown, so one bad request never affects the other clients.
+ * @param request One JSON object, as described in the class documentation.
+ */
+string SimulationServer::handleCommand(const string& request){
+    json response;
+    json command;
+    try {
+        command = json::parse(request);
+        if (command.contains("id")) response["id"] = command["id"];
+        string cmd = command.at("cmd");
+        string name = command.value("system", "default");
+        // the system is created by the first command that uses it
+        auto get_system = [&]() -> OpticalSystem* {
+            unique_ptr<OpticalSystem>& system = systems[name];
+            if (!system) system = make_unique<OpticalSystem>();
+            return system.get();
+        };
+
+        if (cmd == "load") {
+            load(name, command.at("file"));
+        } else if (cmd == "save") {
+            get_system()->save(command.at("file"));
+        } else if (cmd == "clear") {
+            systems.erase(name);
+        } else if (cmd == "add") {
+            string type = command.value("type", "thin");
+            if (type == "object") {
+                get_system()->add(LightSource(command.at("position"), command.at("size"), command.value("size_z", 0.0)));
+            } else {
+                const element_class* kind = ElementRegistry::global().find(type);
+                if (!kind) throw OptiSimError("ERROR: \tInvalid element type: " + type);
+                get_system()->add(*ElementRegistry::read(*kind, command), command.at("name").get_ref<const string&>());
+            }
+        } else if (cmd == "remove") {
+            get_system()->remove(command.at("name").get_ref<const string&>());
+        } else if (cmd == "modify") {
+            const string& param = command.at("param").get_ref<const string&>();
+            if (command.contains("name")) get_system()->modifyOpticalObject(command["name"].get_ref<const string&>(), param, command.at("value"));
+            else get_system()->modifyLightSource(param, command.at("value"));
+        } else if (cmd == "calculate") {
+            response["image"] = Report::imageJson(get_system()->Calculate());
+            if (command.value("images", false)) {
+                json images = json::array();
+                for (const Image& image : get_system()->getImageSequence()) images.push_back(Report::imageJson(image));
+                response["images"] = images;
+            }
+        } else if (cmd == "rays") {
+            get_system()->Calculate();
+            for (auto& entry : get_system()->getRays()) response["rays"][entry.first] = {{"x", entry.second.x}, {"y", entry.second.y}};
+        } else if (cmd == "list") {
+            response["systems"] = json::array();
+            for (auto& entry : systems) response["systems"].push_back(entry.first);
+        } else if (cmd == "shutdown") {
+            stop();
+        } else {
+            throw OptiSimError("ERROR: \tUnknown command: " + cmd);
+        }
+        response["ok"] = true;
+    } catch (exception& e) {
+        response["ok"] = false;
+        response["error"] = e.what();
+    }
+    return response.dump();
+}
+
+/**
+ * @details An existing file at the socket path is replaced, and the socket file is removed when the loop ends.
+ * Each client is read until it closes its connection; every complete line it sent is answered in order, and
+ * the answers are queued and written as the socket accepts them, so a slow reader does not block the others.
+ * A client that shuts down its sending side is answered in full before its connection is closed. When the loop
+ * ends, the pending answers are still delivered to every client that keeps reading.
+ * The loop ends after a `shutdown` command or a call to `stop()` from another thread.
+ * @param socket_path The path of the Unix socket.
+ * @throws OptiSimError If the socket cannot be created or bound.
+ */
+void SimulationServer::serve(const string& socket_path){
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) throw OptiSimError("ERROR: \tThe socket path is too long: " + socket_path);
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) throw OptiSimError("ERROR: \tFailed to create socket: " + string(strerror(errno)));
+    unlink(socket_path.c_str());
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        string reason = strerror(errno);
+        close(listener);
+        throw OptiSimError("ERROR: \tFailed to listen on " + socket_path + ": " + reason);
+    }
+    set_nonblocking(listener);
+
+    int wake[2];
+    if (pipe(wake) < 0) {
+        close(listener);
+        throw OptiSimError("ERROR: \tFailed to create pipe: " + string(strerror(errno)));
+    }
+    set_nonblocking(wake[0]);
+    wake_fd = wake[1];
+    running = true;
+
+    vector<server_client> clients;
+    vector<pollfd> fds;
+    char buffer[65536];
+    while (running) {
+        fds.clear();
+        fds.push_back({listener, POLLIN, 0});
+        fds.push_back({wake[0], POLLIN, 0});
+        for (server_client& client : clients)
+            fds.push_back({client.fd, (short)((client.eof ? 0 : POLLIN) | (client.output.empty() ? 0 : POLLOUT)), 0});
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) while (read(wake[0], buffer, sizeof(buffer)) > 0);
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listener, nullptr, nullptr)) >= 0) {
+                set_nonblocking(fd);
+                clients.push_back({fd, "", "", false});
+            }
+        }
+
+        // the clients accepted above have no entry in fds yet
+        size_t polled = fds.size() - 2;
+        vector<char> closed(clients.size(), 0);
+        for (size_t i = 0; i < polled; i++) {
+            server_client& client = clients[i];
+            short revents = fds[i + 2].revents;
+            if (!client.eof && (revents & (POLLIN | POLLHUP | POLLERR))) {
+                ssize_t n;
+                while ((n = read(client.fd, buffer, sizeof(buffer))) > 0) client.input.append(buffer, n);
+                if (n == 0) {
+                    // the client has finished sending; a last request without a newline is answered as well
+                    client.eof = true;
+                    client.input += '\n';
+                } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) closed[i] = 1;
+
+                size_t start = 0, end;
+                while ((end = client.input.find('\n', start)) != string::npos) {
+                    string line = client.input.substr(start, end - start);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (!line.empty()) client.output += handleCommand(line) + "\n";
+                    start = end + 1;
+                }
+                client.input.erase(0, start);
+                if (client.input.size() > max_request_size) closed[i] = 1;
+            }
+            if (!send_pending(client)) closed[i] = 1;
+            if (client.eof && client.output.empty()) closed[i] = 1;
+        }
+        for (size_t i = clients.size(); i-- > 0;) {
+            if (!closed[i]) continue;
+            close(clients[i].fd);
+            clients.erase(clients.begin() + i);
+        }
+    }
+
+    // deliver the pending responses, such as the answer to `shutdown`, to the clients that keep reading
+    for (server_client& client : clients) {
+        while (send_pending(client) && !client.output.empty()) {
+            pollfd writable = {client.fd, POLLOUT, 0};
+            if (poll(&writable, 1, drain_timeout_ms) <= 0) break;
+        }
+        close(client.fd);
+    }
+    wake_fd = -1;
+    close(wake[0]);
+    close(wake[1]);
+    close(listener);
+    unlink(socket_path.c_str());
+}
+
+/**
+ * @details Can be called from any thread, and from a command handled by the loop itself.
+ */
+void SimulationServer::stop(){
+    running = false;
+    int fd = wake_fd;
+    if (fd >= 0) {
+        char byte = 0;
+        ssize_t ignored = write(fd, &byte, 1);
+        (void)ignored;
+    }
+}
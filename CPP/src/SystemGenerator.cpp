@@ -0,0 +1,142 @@
+/**
+* @file SystemGenerator.cpp
+* @brief Implements the SystemGenerator class.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "SystemGenerator.h"
+#include <fstream>           // For writing JSON files
+#include <iomanip>           // For std::setprecision
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+
+/**
+ * @brief Returns a uniform random number in [0, 1) for one draw of one lens.
+ * @details SplitMix64 applied to the seed, the lens index and the draw number, so the draws of every lens are
+ * independent of each other and of the order in which lenses are generated.
+ */
+static double uniform_draw(uint64_t seed, uint64_t index, uint64_t draw){
+    uint64_t z = seed + (index * 8 + draw + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @param seed The seed of the random lens parameters.
+ */
+SystemGenerator::SystemGenerator(uint64_t seed){
+    this->seed = seed;
+    this->spacing = 10.0;
+    this->thick_fraction = 0.5;
+}
+
+/**
+ * @param seed The new seed.
+ */
+void SystemGenerator::setSeed(uint64_t seed){
+    this->seed = seed;
+}
+
+/**
+ * @details Neighbouring lenses are at least half a spacing apart, so the spacing must be at least 0.002 mm
+ * to respect the minimum distance enforced by `OpticalSystem::add`.
+ * @param spacing The new spacing in mm.
+ * @throws OptiSimError If the spacing is below 0.002 mm.
+ */
+void SystemGenerator::setSpacing(double spacing){
+    if (!(spacing >= 0.002)) throw OptiSimError("ERROR: \tThe spacing must be at least 0.002 mm.");
+    this->spacing = spacing;
+}
+
+/**
+ * @param thick_fraction The new probability, 0 for thin lenses only and 1 for thick lenses only.
+ * @throws OptiSimError If the probability is outside [0, 1].
+ */
+void SystemGenerator::setThickFraction(double thick_fraction){
+    if (!(thick_fraction >= 0 && thick_fraction <= 1)) throw OptiSimError("ERROR: \tThe fraction of thick lenses must be between 0 and 1.");
+    this->thick_fraction = thick_fraction;
+}
+
+/**
+ * @param index The index of the lens.
+ */
+SystemGenerator::lens_parameters SystemGenerator::lens(long long index){
+    lens_parameters p;
+    p.thick = uniform_draw(seed, index, 0) < thick_fraction;
+    p.x = spacing * (index + 1 + 0.5 * (uniform_draw(seed, index, 1) - 0.5));
+    if (p.thick) {
+        p.n = 1.45 + 0.4 * uniform_draw(seed, index, 2);
+        p.d = spacing * (0.1 + 0.2 * uniform_draw(seed, index, 3));
+        p.r_left = spacing * (0.5 + uniform_draw(seed, index, 4));
+        p.r_right = -spacing * (0.5 + uniform_draw(seed, index, 5));
+        p.f = 0;
+    } else {
+        p.f = spacing * (0.2 + 0.1 * uniform_draw(seed, index, 2));
+        p.n = p.d = p.r_left = p.r_right = 0;
+    }
+    return p;
+}
+
+/**
+ * @details The lenses are added in ascending position, so every insertion appends to the end of the system.
+ * @param OS The system to fill. The object replaces its light source, and it must not contain lenses named like the generated ones.
+ * @param count The number of lenses.
+ * @throws OptiSimError If the count is negative or a lens cannot be added.
+ */
+void SystemGenerator::generate(OpticalSystem& OS, long long count){
+    if (count < 0) throw OptiSimError("ERROR: \tThe number of lenses cannot be negative.");
+    OS.add(LightSource(0, 1));
+    for (long long i = 0; i < count; i++) {
+        lens_parameters p = lens(i);
+        if (p.thick) {
+            ThickLens ThickL(p.x, p.n, p.d, p.r_left, p.r_right);
+            OS.add(ThickL, "L" + to_string(i));
+        } else {
+            ThinLens ThinL(p.x, p.f);
+            OS.add(ThinL, "L" + to_string(i));
+        }
+    }
+}
+
+/**
+ * @details The JSON is streamed lens by lens in the layout read by `OpticalSystem(string)`, so systems far larger
+ * than what fits in memory as an `OpticalSystem` can be written. Numbers are written with 17 significant digits,
+ * which reproduces the in-memory parameters exactly when the file is loaded.
+ * @param os The output stream.
+ * @param count The number of lenses.
+ * @throws OptiSimError If the count is negative.
+ */
+void SystemGenerator::write(ostream& os, long long count){
+    if (count < 0) throw OptiSimError("ERROR: \tThe number of lenses cannot be negative.");
+    streamsize precision = os.precision(17);
+    os << "{\n  \"lenses\": [";
+    for (long long i = 0; i < count; i++) {
+        lens_parameters p = lens(i);
+        os << (i ? ",\n    " : "\n    ") << "{\"name\": \"L" << i << "\", ";
+        if (p.thick) {
+            os << "\"type\": \"thick\", \"position\": " << p.x
+               << ", \"radius_left\": " << p.r_left << ", \"radius_right\": " << p.r_right
+               << ", \"refractive_index\": " << p.n << ", \"thickness\": " << p.d << "}";
+        } else {
+            os << "\"type\": \"thin\", \"position\": " << p.x << ", \"focal_length\": " << p.f << "}";
+        }
+    }
+    os << "\n  ],\n  \"object\": {\n    \"position\": 0.0,\n    \"size\": 1.0\n  }\n}\n";
+    os.precision(precision);
+}
+
+/**
+ * @param file_name The path of the JSON file.
+ * @param count The number of lenses.
+ * @throws OptiSimError If the count is negative or the file cannot be opened.
+ */
+void SystemGenerator::write(const string& file_name, long long count){
+    ofstream file(file_name);
+    if (!file.is_open()) throw OptiSimError("ERROR: \tFailed to open file for writing: " + file_name);
+    write(file, count);
+}
@@ -12,6 +12,7 @@
 #include <limits>           // For std::numeric_limits
 #include <cmath>            // For std::abs, std::isinf
 #include <OptiSimError.h>   // Custom exception class
+#include "MaterialCatalog.h" // Shared table of named materials
 
 using namespace std;
 
@@ -53,6 +54,34 @@ double ThickLens::computeF(double n, double d, double r_left, double r_right){
     }
 }
 
+/**
+ * @brief Computes the effective focal lengths for an array of refractive indices.
+ * @details This is the array form of `computeF` for the current thickness and radii: the checks and
+ * the reciprocal radii are computed once, and the lensmaker's equation is then evaluated for every
+ * refractive index in a single loop.
+ *
+ * @param n The refractive indices.
+ * @param f The output array, receiving one focal length per refractive index.
+ * @param count The number of refractive indices.
+ * @throws OptiSimError if `r_left` or `r_right` is exactly zero.
+ */
+void ThickLens::computeFocalLengths(const double* n, double* f, size_t count){
+    if(r_left == 0.0 || r_right == 0.0) {
+        throw OptiSimError("ERROR: \tThe radius of the surface cannot be 0.");
+    }
+
+    const double term1 = isinf(r_left) ? 0.0 : 1.0 / r_left;
+    const double term2 = isinf(r_right) ? 0.0 : 1.0 / r_right;
+    const bool curved = !isinf(r_left) && !isinf(r_right);
+    const double radii = r_left * r_right;
+
+    for(size_t i = 0; i < count; i++){
+        double term3 = curved ? ((n[i] - 1.0) * d) / (n[i] * radii) : 0.0;
+        double finv = (n[i] - 1.0) * (term1 - term2 + term3);
+        f[i] = abs(finv) < numeric_limits<double>::epsilon() ? numeric_limits<double>::infinity() : 1.0 / finv;
+    }
+}
+
 /**
  * @brief Computes the position of the left principal plane.
  * 
@@ -71,6 +100,17 @@ double ThickLens::computeHRight(){
     return - f * (n - 1) * d / r_left / n + x + d/2;
 }
 
+/**
+ * @brief Recomputes the cached principal planes.
+ * @details `Calculate` needs both principal planes for every subject, but they only change when one of the
+ * lens parameters does, so they are computed here once and reused until a setter clears `planes_valid`.
+ */
+void ThickLens::updatePlanes(){
+    h_left = computeHLeft();
+    h_right = computeHRight();
+    planes_valid = true;
+}
+
 /**
  * @brief Constructor for ThickLens.
  * 
@@ -88,18 +128,22 @@ ThickLens::ThickLens(double x, double n, double d, double r_left, double r_right
     this->d = d;
     this->r_left = r_left;
     this->r_right = r_right;
+    this->material = -1;
+    this->planes_valid = false;
 }
 
 /**
  * @brief Gets the refractive index of the lens.
  * @return The refractive index
  */
-double ThickLens::getN(){
+double ThickLens::getN() const{
     return n;
 }
 
 /**
  * @brief Sets the refractive index of the lens and updates focal length.
+ * @details A new index replaces the material of the lens: the dispersion model and the material are dropped,
+ * so the lens is non-dispersive and images every wavelength with the new index.
  * 
  * @param n New refractive index
  * @throws OptiSimError if n is non-positive
@@ -109,6 +153,9 @@ void ThickLens::setN(double n){
     if(this->n != n){
         this->n = n;
         this->f = computeF(n, d, r_left, r_right);
+        this->planes_valid = false;
+        this->dispersion = nullptr;
+        this->material = -1;
     }
 }
 
@@ -116,7 +163,7 @@ void ThickLens::setN(double n){
  * @brief Gets the thickness of the lens.
  * @return The thickness
  */
-double ThickLens::getD(){
+double ThickLens::getD() const{
     return d;
 }
 
@@ -131,6 +178,7 @@ void ThickLens::setD(double d){
     if(this->d != d){
         this->d = d;
         this->f = computeF(n, d, r_left, r_right);
+        this->planes_valid = false;
     }
 }
 
@@ -138,7 +186,7 @@ void ThickLens::setD(double d){
  * @brief Gets the left radius of curvature.
  * @return The left radius of curvature
  */
-double ThickLens::getR_Left(){
+double ThickLens::getR_Left() const{
     return r_left;
 }
 
@@ -151,6 +199,7 @@ void ThickLens::setR_Left(double r_left){
     if(this->r_left != r_left){
         this->r_left = r_left;
         this->f = computeF(n, d, r_left, r_right);
+        this->planes_valid = false;
     }
 }
 
@@ -158,7 +207,7 @@ void ThickLens::setR_Left(double r_left){
  * @brief Gets the right radius of curvature.
  * @return The right radius of curvature
  */
-double ThickLens::getR_Right(){
+double ThickLens::getR_Right() const{
     return r_right;
 }
 
@@ -171,18 +220,108 @@ void ThickLens::setR_Right(double r_right){
     if(this->r_right != r_right){
         this->r_right = r_right;
         this->f = computeF(n, d, r_left, r_right);
+        this->planes_valid = false;
     }
 }
 
+/**
+ * @brief Sets the position of the lens center.
+ * @details Overrides `OpticalObject::setX`, because the cached principal planes move with the lens.
+ *
+ * @param x New position of the lens center
+ */
+void ThickLens::setX(double x){
+    if(this->x != x){
+        this->x = x;
+        this->planes_valid = false;
+    }
+}
+
+/**
+ * @brief Sets the dispersion model of the lens material.
+ * @details The scalar refractive index used by `Calculate` becomes the index of the model at the
+ * reference wavelength (the helium d-line), and the focal length is updated accordingly.
+ * Passing `nullptr` makes the lens non-dispersive again and keeps the current refractive index.
+ *
+ * @param dispersion The new dispersion model, or `nullptr`
+ * @throws OptiSimError if the model gives a non-positive refractive index at the reference wavelength
+ */
+void ThickLens::setDispersion(shared_ptr<const DispersionModel> dispersion){
+    if(dispersion){
+        double n_d = dispersion->getIndex(OPTISIM_REFERENCE_WAVELENGTH);
+        if(!(n_d > 0)) throw OptiSimError("ERROR: \tThe refractive index must be a positive number.");
+        this->f = computeF(n_d, d, r_left, r_right);
+        this->n = n_d;
+        this->planes_valid = false;
+    }
+    this->dispersion = dispersion;
+    this->material = -1;
+}
+
+/**
+ * @brief Gets the dispersion model of the lens material.
+ * @return The dispersion model, or `nullptr` if the lens is not dispersive
+ */
+shared_ptr<const DispersionModel> ThickLens::getDispersion() const{
+    return dispersion;
+}
+
+/**
+ * @brief Sets the lens material to a material of the global `MaterialCatalog`.
+ * @details The lens uses the dispersion model of the material, and its refractive indices are taken from
+ * the catalog's cache, which is shared with every other lens made of the same material.
+ * The scalar refractive index becomes the index of the material at the reference wavelength.
+ *
+ * @param material The ID of the material in the global `MaterialCatalog`
+ * @throws OptiSimError if the ID is not valid or the material has a non-positive refractive index
+ */
+void ThickLens::setMaterial(int material){
+    MaterialCatalog& catalog = MaterialCatalog::global();
+    shared_ptr<const DispersionModel> model = catalog.getModel(material);
+    double n_d = catalog.getIndex(material, OPTISIM_REFERENCE_WAVELENGTH);
+    if(!(n_d > 0)) throw OptiSimError("ERROR: \tThe refractive index must be a positive number.");
+    this->f = computeF(n_d, d, r_left, r_right);
+    this->n = n_d;
+    this->planes_valid = false;
+    this->dispersion = model;
+    this->material = material;
+}
+
+/**
+ * @brief Gets the lens material.
+ * @return The ID of the material in the global `MaterialCatalog`, or -1
+ */
+int ThickLens::getMaterial() const{
+    return material;
+}
+
+/**
+ * @brief Computes the effective focal length at each of the given wavelengths.
+ * @details A lens without a dispersion model has the same focal length at every wavelength.
+ *
+ * @param wavelengths The wavelengths in micrometres
+ * @return One focal length per wavelength
+ */
+vector<double> ThickLens::getFocalLengths(const vector<double>& wavelengths){
+    vector<double> indices(wavelengths.size(), n);
+    vector<double> focal_lengths(wavelengths.size());
+    if(material >= 0) MaterialCatalog::global().getIndices(material, wavelengths.data(), indices.data(), wavelengths.size());
+    else if(dispersion) dispersion->getIndices(wavelengths.data(), indices.data(), wavelengths.size());
+    computeFocalLengths(indices.data(), focal_lengths.data(), wavelengths.size());
+    return focal_lengths;
+}
+
 /**
  * @brief Calculates the image formed by the thick lens for a given object.
+ * @details The principal planes are taken from the cache and only recomputed after a parameter changed.
  * 
  * @param is ImagingSubject representing the object to image
  * @return Image representing the result of the lens imaging
  */
-Image ThickLens::Calculate(ImagingSubject is){
-    double H_left = computeHLeft();
-    double H_right = computeHRight();
+Image ThickLens::Calculate(const ImagingSubject& is){
+    if (!planes_valid) updatePlanes();
+    double H_left = h_left;
+    double H_right = h_right;
 
     double d_is;
     if (isinf(is.getX())) {
@@ -223,3 +362,72 @@ Image ThickLens::Calculate(ImagingSubject is){
 
     return Image(H_right + d_im, y_im, is_real);
 }
+
+
+/**
+ * @brief Calculates the images formed by the thick lens for many wavelengths at once.
+ * @details The refractive indices of all lanes are obtained in one batch, from the material catalog or from the
+ * dispersion model, followed
+ * by the focal lengths and the principal planes, and finally the images. Each stage is a single loop
+ * over contiguous arrays; the special cases of `Calculate` are substituted after the regular result so the
+ * loop bodies have no early exits.
+ *
+ * @param wavelengths The wavelengths in micrometres
+ * @param x The subject positions on entry, the image positions on exit
+ * @param y The subject heights on entry, the image heights on exit
+ * @param real The real (1) or virtual (0) status of each image on exit
+ * @param count The number of wavelengths
+ */
+void ThickLens::CalculateSpectrum(const double* wavelengths, double* x, double* y, char* real, size_t count){
+    const double inf = numeric_limits<double>::infinity();
+    vector<double> indices(count, n);
+    vector<double> focal_lengths(count);
+    if(material >= 0) MaterialCatalog::global().getIndices(material, wavelengths, indices.data(), count);
+    else if(dispersion) dispersion->getIndices(wavelengths, indices.data(), count);
+    computeFocalLengths(indices.data(), focal_lengths.data(), count);
+
+    for(size_t i = 0; i < count; i++){
+        double n_i = indices[i];
+        double f_i = focal_lengths[i];
+        double H_left = - f_i * (n_i - 1) * d / r_right / n_i + this->x - d/2;
+        double H_right = - f_i * (n_i - 1) * d / r_left / n_i + this->x + d/2;
+
+        double d_is = H_left - x[i];
+        double denominator = d_is - f_i;
+        double d_im = (f_i * d_is) / denominator;
+        double y_im = -d_im / d_is * y[i];
+        bool is_real = d_im > 0;
+
+        if (abs(x[i]) == inf) {
+            d_im = f_i;
+            y_im = 0.0;
+            is_real = (f_i > 0);
+        } else if (abs(denominator) < numeric_limits<double>::epsilon()) {
+            y_im = inf;
+            d_im = f_i > 0 ? inf : -inf;
+            is_real = f_i > 0;
+        }
+
+        x[i] = H_right + d_im;
+        y[i] = y_im;
+        real[i] = is_real;
+    }
+}
+
+/**
+ * @brief Traces a bundle of rays through the thick lens.
+ * @details A ray is deflected at the left principal plane and leaves the right principal plane at the same height,
+ * both taken from the cache.
+ *
+ * @param x The x-coordinates of the rays
+ * @param y The y-coordinates of the rays
+ * @param z The z-coordinates of the rays
+ * @param u The slopes dy/dx of the rays
+ * @param v The slopes dz/dx of the rays
+ * @param vignetted Set to 1 for every ray outside the aperture, 0 for the others
+ * @param count The number of rays
+ */
+void ThickLens::TraceRays(double* x, double* y, double* z, double* u, double* v, char* vignetted, size_t count){
+    if (!planes_valid) updatePlanes();
+    TracePrincipalPlanes(h_left - this->x, h_right - this->x, f, x, y, z, u, v, vignetted, count);
+}
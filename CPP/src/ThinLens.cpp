@@ -23,45 +23,39 @@ using namespace std;
 ThinLens::ThinLens(double x, double f):Lens(x, f){}
 
 /**
- * @details This method implements the thin lens formula to determine the image's
- * position, size, and whether it is real or virtual. The object distance `d_is`
- * is calculated relative to the lens's own position (`x`).
+ * @details This method applies the thin lens formula of `Lens::CalculateThin` with the lens's own position and focal length.
  *
  * @param is The `ImagingSubject` (object) to be imaged by the lens. This includes
  * its x-coordinate and y-coordinate (height/size).
  */
-Image ThinLens::Calculate(ImagingSubject is){
-    double d_is = x - is.getX();
-    double y_is = is.getY();
-
-    double d_im;
-    double y_im;
-    bool is_real;
-
-    if (isinf(d_is)) {
-        d_im = f;
-        y_im = 0.0;
-        is_real = (f > 0);
-    } else {
-        double denominator = d_is - f;
+Image ThinLens::Calculate(const ImagingSubject& is){
+    return CalculateThin(is);
+}
 
-        if (abs(denominator) < numeric_limits<double>::epsilon()) {
-            y_im = numeric_limits<double>::infinity();
-            if (f > 0) {
-                d_im = numeric_limits<double>::infinity();
-                is_real = true;
-            } else {
-                d_im = -numeric_limits<double>::infinity();
-                is_real = false;
-            }
-        } else {
-            d_im = (f * d_is) / denominator;
-            y_im = -d_im / d_is * y_is;
-            is_real = d_im > 0;
-        }
-    }
+/**
+ * @details A thin lens is not dispersive, so every lane uses the same focal length; the lanes are imaged by
+ * `Lens::CalculateThinSpectrum`.
+ * @param x The subject positions on entry, the image positions on exit.
+ * @param y The subject heights on entry, the image heights on exit.
+ * @param real The real (1) or virtual (0) status of each image on exit.
+ * @param count The number of wavelengths.
+ */
+void ThinLens::CalculateSpectrum(const double* /* wavelengths */, double* x, double* y, char* real, size_t count){
+    CalculateThinSpectrum(x, y, real, count);
+}
 
-    return Image(x + d_im, y_im, is_real);
+/**
+ * @details Both principal planes of a thin lens lie at its center, so a ray is deflected where it crosses the lens plane.
+ * @param x The x-coordinates of the rays.
+ * @param y The y-coordinates of the rays.
+ * @param z The z-coordinates of the rays.
+ * @param u The slopes dy/dx of the rays.
+ * @param v The slopes dz/dx of the rays.
+ * @param vignetted Set to 1 for every ray outside the aperture, 0 for the others.
+ * @param count The number of rays.
+ */
+void ThinLens::TraceRays(double* x, double* y, double* z, double* u, double* v, char* vignetted, size_t count){
+    TracePrincipalPlanes(0, 0, f, x, y, z, u, v, vignetted, count);
 }
 
 /**
@@ -0,0 +1,357 @@
+/**
+* @file ToleranceAnalysis.cpp
+* @brief Implements the ToleranceAnalysis class, a parallel Monte Carlo tolerance engine.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "ToleranceAnalysis.h"
+#include <cmath>             // For std::abs, std::sqrt, std::isfinite
+#include <limits>            // For std::numeric_limits
+#include <chrono>            // For timing the run
+#include <random>            // For the random streams and distributions
+#include <thread>            // For the worker threads
+#include <atomic>            // For handing out blocks to the workers
+#include <algorithm>         // For std::sort, std::min, std::max
+#include "OptiSimError.h"    // Custom exception class
+#include "Instrumentation.h" // Per-phase timers and counters
+#include "Trace.h"           // Timeline spans
+#include "ElementRegistry.h" // Parameters of the element types
+
+using namespace std;
+
+// Number of trials drawn from one random stream. Blocks are the unit of work of the threads.
+static const long long BLOCK_SIZE = 4096;
+
+/**
+ * @brief Running count, mean and sum of squared deviations of a set of samples.
+ */
+struct moments {
+    long long count = 0;
+    double mean = 0;
+    double m2 = 0;
+    double min = numeric_limits<double>::infinity();
+    double max = -numeric_limits<double>::infinity();
+
+    void add(double value){
+        count++;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        if(value < min) min = value;
+        if(value > max) max = value;
+    }
+
+    void merge(const moments& other){
+        if(other.count == 0) return;
+        long long total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * ((double)count * other.count / total);
+        count = total;
+        if(other.min < min) min = other.min;
+        if(other.max > max) max = other.max;
+    }
+};
+
+/**
+ * @brief The private state of one worker thread: its own copy of the elements.
+ */
+struct tolerance_worker {
+    vector<OpticalObject*> elements;
+    vector<OpticalObject*> targets;
+    vector<void (*)(OpticalObject&, double)> setters;
+    vector<double> nominal;
+    vector<long long> position_histogram;
+    vector<long long> size_histogram;
+    long long position_underflow = 0, position_overflow = 0;
+    long long size_underflow = 0, size_overflow = 0;
+    long long failed = 0;
+
+    ~tolerance_worker(){
+        for(int i = 0; i < elements.size(); i++) delete elements[i];
+    }
+};
+
+/**
+ * @brief Derives the seed of a block's random stream (SplitMix64 finalizer).
+ */
+static uint64_t stream_seed(uint64_t seed, uint64_t block){
+    uint64_t z = seed + (block + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Counts a sample into a histogram.
+ */
+static void bin_sample(double value, double lower, double upper, vector<long long>& histogram, long long& underflow, long long& overflow){
+    if(value < lower) underflow++;
+    else if(value > upper) overflow++;
+    else {
+        long long index = (long long)((value - lower) / (upper - lower) * histogram.size());
+        if(index >= (long long)histogram.size()) index = histogram.size() - 1;
+        histogram[index]++;
+    }
+}
+
+/**
+ * @details Walks the cumulative histogram and interpolates linearly inside the bin that holds the
+ * requested rank. Samples in the underflow and overflow counters are attributed to the extreme values,
+ * so the estimate is always between `min` and `max`.
+ * @param p The percentile, between 0 and 100.
+ * @return The estimated percentile, or NaN if there are no samples.
+ */
+double tolerance_statistics::percentile(double p) const{
+    if(count == 0) return numeric_limits<double>::quiet_NaN();
+    double rank = p / 100.0 * count;
+    double cumulative = underflow;
+    if(rank <= cumulative) return min;
+    double width = (upper - lower) / histogram.size();
+    for(int i = 0; i < histogram.size(); i++){
+        if(histogram[i] > 0 && cumulative + histogram[i] >= rank){
+            double value = lower + (i + (rank - cumulative) / histogram[i]) * width;
+            return std::min(std::max(value, min), max);
+        }
+        cumulative += histogram[i];
+    }
+    return max;
+}
+
+/**
+ * @details Creates an analysis with no tolerances, seed 0, one thread per hardware thread and 100 bins.
+ * The system is only referenced; it must outlive the analysis and must not be modified during `run()`.
+ * @param system The nominal optical system.
+ */
+ToleranceAnalysis::ToleranceAnalysis(OpticalSystem& system){
+    this->system = &system;
+    seed = 0;
+    threads = max(1u, thread::hardware_concurrency());
+    bins = 100;
+}
+
+/**
+ * @details Registers a perturbed parameter. The element and parameter are resolved by `run()`.
+ * @param element The name of the element that owns the parameter.
+ * @param param The parameter name: "x", or a settable parameter in the schema of the element's type
+ * ("f" for thin lenses, "n", "d", "r_left", "r_right" for thick lenses).
+ * @param distribution "normal" or "uniform".
+ * @param width The standard deviation of a normal perturbation or the half-width of a uniform one.
+ * @throws OptiSimError If the distribution is unknown or the width is negative.
+ */
+void ToleranceAnalysis::addTolerance(string element, string param, string distribution, double width){
+    if(distribution != "normal" && distribution != "uniform") throw OptiSimError("ERROR: \tInvalid distribution: " + distribution);
+    if(width < 0) throw OptiSimError("ERROR: \tThe width of a tolerance cannot be negative.");
+    tolerances.push_back({element, param, distribution == "normal", width});
+}
+
+/**
+ * @param seed The seed from which the random stream of every block is derived.
+ */
+void ToleranceAnalysis::setSeed(uint64_t seed){
+    this->seed = seed;
+}
+
+/**
+ * @details The number of threads only changes the speed of a run, not its result.
+ * @param threads The number of worker threads.
+ * @throws OptiSimError If `threads` is not positive.
+ */
+void ToleranceAnalysis::setThreads(int threads){
+    if(threads <= 0) throw OptiSimError("ERROR: \tThe number of threads must be a positive number.");
+    this->threads = threads;
+}
+
+/**
+ * @param bins The number of histogram bins of each statistic.
+ * @throws OptiSimError If `bins` is not positive.
+ */
+void ToleranceAnalysis::setBins(int bins){
+    if(bins <= 0) throw OptiSimError("ERROR: \tThe number of bins must be a positive number.");
+    this->bins = bins;
+}
+
+/**
+ * @details Each worker copies the system elements once and then, for every trial, overwrites the
+ * toleranced parameters with perturbed values and images the light source through the copies, following
+ * the element selection of `OpticalSystem::Calculate()`. A trial fails if a setter rejects a value, if the
+ * elements no longer keep their order and the 0.001 mm minimum distance, or if the image is not finite.
+ *
+ * The first block is evaluated before the others to fix the histogram range around its samples; values
+ * outside the range are counted as underflow or overflow. The other blocks are then distributed over the
+ * threads.
+ * @param trials The number of trials.
+ * @return A `tolerance_result` with the position and size statistics of the final image.
+ * @throws OptiSimError If `trials` is not positive, if there is no light source, if the system has decentered
+ * or tilted elements, or if a tolerance refers to an unknown element or parameter.
+ */
+tolerance_result ToleranceAnalysis::run(long long trials){
+    if(trials <= 0) throw OptiSimError("ERROR: \tThe number of trials must be a positive number.");
+    auto begin = chrono::steady_clock::now();
+
+    LightSource ls = system->getLightSource();
+    double ls_x = ls.getX();
+    // the trials use the on-axis formulas
+    bool centered = ls.getZ() == 0;
+    for (const element_info& info : system->getElements()) centered = centered && info.y == 0 && info.z == 0 && info.tilt_y == 0 && info.tilt_z == 0;
+    if(!centered) throw OptiSimError("ERROR: \tThe tolerance analysis supports centered systems only.");
+
+    long long block_count = (trials + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int worker_count = (int)min<long long>(threads, block_count);
+    vector<tolerance_worker> workers(worker_count);
+
+    // copy the elements for every worker and resolve the tolerances
+    for(int w = 0; w < worker_count; w++){
+        tolerance_worker& worker = workers[w];
+        map<string, OpticalObject*> copies = system->getSystemElements();
+        vector<pair<double, string>> positions;
+        for (const auto& [name, objPtr] : copies) positions.push_back({objPtr->getX(), name});
+        sort(positions.begin(), positions.end());
+        for (const auto& [position, name] : positions) worker.elements.push_back(copies[name]);
+
+        for(int t = 0; t < tolerances.size(); t++){
+            if(copies.find(tolerances[t].element) == copies.end()) throw OptiSimError("ERROR: \tInvalid key: " + tolerances[t].element);
+            OpticalObject* target = copies[tolerances[t].element];
+            const string& param = tolerances[t].param;
+            void (*setter)(OpticalObject&, double);
+            double value;
+            if(param == "x"){
+                setter = [](OpticalObject& element, double x){ element.setX(x); };
+                value = target->getX();
+            } else {
+                // the settable parameters of the element's type
+                const element_class& type = ElementRegistry::global().of(*target);
+                int k = type.param(param);
+                if(k < 0 || !type.params[k].set) throw OptiSimError("ERROR: \tInvalid parameter: " + param);
+                setter = type.params[k].set;
+                value = type.params[k].get(*target);
+            }
+            worker.targets.push_back(target);
+            worker.setters.push_back(setter);
+            worker.nominal.push_back(value);
+        }
+        worker.position_histogram.assign(bins, 0);
+        worker.size_histogram.assign(bins, 0);
+    }
+
+    // evaluates one block of trials and hands every sample to the sink
+    auto run_block = [&](tolerance_worker& worker, long long block, moments& position, moments& size, auto&& sink){
+        OPTISIM_TRACE_SCOPE("tolerance_block");
+        mt19937_64 rng(stream_seed(seed, block));
+        normal_distribution<double> gauss(0.0, 1.0);
+        uniform_real_distribution<double> uniform(-1.0, 1.0);
+        long long first = block * BLOCK_SIZE;
+        long long last = min(first + BLOCK_SIZE, trials);
+        vector<OpticalObject*>& elements = worker.elements;
+        long long evaluations = 0;
+
+        for(long long trial = first; trial < last; trial++){
+            bool valid = true;
+            try {
+                for(int t = 0; t < tolerances.size(); t++){
+                    double r = tolerances[t].normal ? gauss(rng) : uniform(rng);
+                    double value = worker.nominal[t] + tolerances[t].width * r;
+                    worker.setters[t](*worker.targets[t], value);
+                }
+            } catch (OptiSimError&) {
+                valid = false;
+            }
+
+            int start = 0;
+            for(int i = 0; valid && i < elements.size(); i++){
+                if(abs(elements[i]->getX() - ls_x) < 0.001) valid = false;
+                if(i > 0 && elements[i]->getX() - elements[i-1]->getX() < 0.001) valid = false;
+                if(ls_x > elements[i]->getX()) start = i + 1;
+            }
+            if(start == elements.size()) valid = false;
+
+            if(valid){
+                Image img = elements[start]->Calculate(ls);
+                for(int i = start + 1; i < elements.size(); i++) img = elements[i]->Calculate(img);
+                evaluations += elements.size() - start;
+                if(isfinite(img.getX()) && isfinite(img.getY())){
+                    position.add(img.getX());
+                    size.add(img.getY());
+                    sink(worker, img.getX(), img.getY());
+                    continue;
+                }
+            }
+            worker.failed++;
+        }
+        OPTISIM_COUNT(COUNTER_ELEMENT_EVALUATIONS, evaluations);
+    };
+
+    vector<moments> position_blocks(block_count), size_blocks(block_count);
+
+    // the first block fixes the histogram ranges
+    vector<double> pilot_position, pilot_size;
+    run_block(workers[0], 0, position_blocks[0], size_blocks[0], [&](tolerance_worker&, double x, double y){
+        pilot_position.push_back(x);
+        pilot_size.push_back(y);
+    });
+    auto range = [](const moments& m, double& lower, double& upper){
+        if(m.count == 0){ lower = -1; upper = 1; return; }
+        double span = m.max - m.min;
+        if(span == 0) span = max(abs(m.max), 1.0) * 1e-9;
+        lower = m.min - 0.5 * span;
+        upper = m.max + 0.5 * span;
+    };
+    double position_lower, position_upper, size_lower, size_upper;
+    range(position_blocks[0], position_lower, position_upper);
+    range(size_blocks[0], size_lower, size_upper);
+    for(int i = 0; i < pilot_position.size(); i++){
+        bin_sample(pilot_position[i], position_lower, position_upper, workers[0].position_histogram, workers[0].position_underflow, workers[0].position_overflow);
+        bin_sample(pilot_size[i], size_lower, size_upper, workers[0].size_histogram, workers[0].size_underflow, workers[0].size_overflow);
+    }
+
+    // the remaining blocks are shared by the workers
+    atomic<long long> next_block(1);
+    auto work = [&](tolerance_worker& worker){
+        auto sink = [&](tolerance_worker& owner, double x, double y){
+            bin_sample(x, position_lower, position_upper, owner.position_histogram, owner.position_underflow, owner.position_overflow);
+            bin_sample(y, size_lower, size_upper, owner.size_histogram, owner.size_underflow, owner.size_overflow);
+        };
+        for(long long block = next_block++; block < block_count; block = next_block++){
+            run_block(worker, block, position_blocks[block], size_blocks[block], sink);
+        }
+    };
+    vector<thread> pool;
+    for(int w = 1; w < worker_count; w++) pool.emplace_back(work, ref(workers[w]));
+    work(workers[0]);
+    for(int w = 0; w < pool.size(); w++) pool[w].join();
+
+    // merge in block order so the floating point result is independent of the thread count
+    moments position, size;
+    for(long long block = 0; block < block_count; block++){
+        position.merge(position_blocks[block]);
+        size.merge(size_blocks[block]);
+    }
+
+    tolerance_result result;
+    result.trials = trials;
+    result.failed = 0;
+    result.position = {position.count, position.mean, 0, position.min, position.max,
+                       position_lower, position_upper, vector<long long>(bins, 0), 0, 0};
+    result.size = {size.count, size.mean, 0, size.min, size.max,
+                   size_lower, size_upper, vector<long long>(bins, 0), 0, 0};
+    result.position.stddev = position.count > 1 ? sqrt(position.m2 / (position.count - 1)) : 0;
+    result.size.stddev = size.count > 1 ? sqrt(size.m2 / (size.count - 1)) : 0;
+    for(int w = 0; w < worker_count; w++){
+        result.failed += workers[w].failed;
+        for(int b = 0; b < bins; b++){
+            result.position.histogram[b] += workers[w].position_histogram[b];
+            result.size.histogram[b] += workers[w].size_histogram[b];
+        }
+        result.position.underflow += workers[w].position_underflow;
+        result.position.overflow += workers[w].position_overflow;
+        result.size.underflow += workers[w].size_underflow;
+        result.size.overflow += workers[w].size_overflow;
+    }
+
+    auto end = chrono::steady_clock::now();
+    result.elapsed_seconds = chrono::duration<double>(end - begin).count();
+    result.trials_per_second = result.elapsed_seconds > 0 ? trials / result.elapsed_seconds : 0;
+    return result;
+}
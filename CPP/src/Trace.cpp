@@ -0,0 +1,201 @@
+/**
+* @file Trace.cpp
+* @brief Implements the Trace and ScopedTrace classes.
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include "Trace.h"
+#include <atomic>            // For the on/off switch and the ring buffer heads
+#include <mutex>             // For registering thread buffers
+#include <vector>            // For the buffers
+#include <memory>            // For std::unique_ptr
+#include <fstream>           // For writing the trace file
+#include <iomanip>           // For std::setprecision
+#include <cstdlib>           // For std::atexit
+#include <iostream>          // For reporting errors at exit
+#include "OptiSimError.h"    // Custom exception class
+
+using namespace std;
+
+/**
+ * @brief One recorded span.
+ */
+struct trace_event {
+    const char* name;
+    long long start_ns;
+    long long duration_ns;
+};
+
+/**
+ * @brief The ring buffer of one thread.
+ * @details Only the owning thread writes `events` and advances `head`; `head` counts every span ever recorded,
+ * and the span `i` lives in slot `i % events.size()`.
+ */
+struct trace_buffer {
+    int tid;
+    vector<trace_event> events;
+    atomic<unsigned long long> head;
+};
+
+/**
+ * @brief The time origin of all timestamps.
+ */
+static const chrono::steady_clock::time_point trace_epoch = chrono::steady_clock::now();
+
+static atomic<bool> trace_enabled(false);
+static mutex registry_mutex;
+static vector<unique_ptr<trace_buffer>> registry;
+static size_t trace_capacity = 1 << 18;
+static string exit_file;
+
+/**
+ * @brief Returns the buffer of the calling thread, registering it on first use.
+ * @details Buffers are owned by the registry, so the spans of finished threads are still written.
+ */
+static trace_buffer* local_buffer(){
+    thread_local trace_buffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        lock_guard<mutex> lock(registry_mutex);
+        unique_ptr<trace_buffer> created(new trace_buffer());
+        created->tid = registry.size() + 1;
+        created->events.resize(trace_capacity);
+        created->head = 0;
+        buffer = created.get();
+        registry.push_back(move(created));
+    }
+    return buffer;
+}
+
+/**
+ * @brief Writes the trace registered by `writeAtExit`.
+ */
+static void write_at_exit(){
+    try {
+        Trace::write(exit_file);
+    } catch (exception& e) {
+        cerr << e.what() << "\n";
+    }
+}
+
+/**
+ * @param enabled True to record spans from now on, false to stop.
+ */
+void Trace::enable(bool enabled){
+    trace_enabled.store(enabled, memory_order_relaxed);
+}
+
+/**
+ * @details A single relaxed atomic load.
+ */
+bool Trace::isEnabled(){
+    return trace_enabled.load(memory_order_relaxed);
+}
+
+/**
+ * @details Only buffers of threads that record their first span afterwards get the new capacity.
+ * @param capacity The number of spans per thread.
+ * @throws OptiSimError If the capacity is zero.
+ */
+void Trace::setCapacity(size_t capacity){
+    if (capacity == 0) throw OptiSimError("ERROR: \tThe trace buffer capacity must be positive.");
+    lock_guard<mutex> lock(registry_mutex);
+    trace_capacity = capacity;
+}
+
+/**
+ * @details Lock-free except for the first span of each thread, which registers its buffer.
+ * @param name The name of the span; must outlive the trace, e.g. a string literal.
+ * @param start The time the span began.
+ * @param end The time the span ended.
+ */
+void Trace::record(const char* name, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end){
+    trace_buffer* buffer = local_buffer();
+    unsigned long long head = buffer->head.load(memory_order_relaxed);
+    trace_event& event = buffer->events[head % buffer->events.size()];
+    event.name = name;
+    event.start_ns = chrono::duration_cast<chrono::nanoseconds>(start - trace_epoch).count();
+    event.duration_ns = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+    buffer->head.store(head + 1, memory_order_release);
+}
+
+/**
+ * @details Spans overwritten in a full buffer are not counted.
+ */
+long long Trace::getEventCount(){
+    lock_guard<mutex> lock(registry_mutex);
+    long long count = 0;
+    for (auto& buffer : registry) count += min<unsigned long long>(buffer->head.load(memory_order_acquire), buffer->events.size());
+    return count;
+}
+
+/**
+ * @details Must not run while other threads record spans.
+ */
+void Trace::clear(){
+    lock_guard<mutex> lock(registry_mutex);
+    for (auto& buffer : registry) buffer->head.store(0, memory_order_release);
+}
+
+/**
+ * @details Writes a `traceEvents` array with one thread name record per buffer followed by its spans, oldest first,
+ * with timestamps in microseconds since the library was loaded. It should be called while no other thread is
+ * recording, e.g. after a run or at exit.
+ * @param file_name The path of the trace file.
+ * @throws OptiSimError If the file cannot be opened for writing.
+ */
+void Trace::write(const string& file_name){
+    ofstream file(file_name);
+    if (!file.is_open()) throw OptiSimError("ERROR: \tFailed to open file for writing: " + file_name);
+
+    lock_guard<mutex> lock(registry_mutex);
+    file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    file << fixed << setprecision(3);
+    for (auto& buffer : registry) {
+        file << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+             << ", \"args\": {\"name\": \"thread " << buffer->tid << "\"}}";
+        first = false;
+
+        unsigned long long head = buffer->head.load(memory_order_acquire);
+        unsigned long long capacity = buffer->events.size();
+        for (unsigned long long i = head > capacity ? head - capacity : 0; i < head; i++) {
+            const trace_event& event = buffer->events[i % capacity];
+            file << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"optisim\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid
+                 << ", \"ts\": " << event.start_ns * 1e-3 << ", \"dur\": " << event.duration_ns * 1e-3 << "}";
+        }
+    }
+    file << "\n]}\n";
+}
+
+/**
+ * @details The file is written by an `atexit` handler, so the trace covers everything up to the normal end of
+ * the process. Calling it again only changes the file name.
+ * @param file_name The path of the trace file.
+ */
+void Trace::writeAtExit(const string& file_name){
+    static bool registered = false;
+    exit_file = file_name;
+    if (!registered) {
+        atexit(write_at_exit);
+        registered = true;
+    }
+    enable(true);
+}
+
+/**
+ * @param name The name of the span; must outlive the trace, e.g. a string literal.
+ */
+ScopedTrace::ScopedTrace(const char* name){
+    this->name = name;
+    this->active = Trace::isEnabled();
+    if (active) this->start = chrono::steady_clock::now();
+}
+
+/**
+ * @details Records the span with `Trace::record` if tracing was on when the scope was entered.
+ */
+ScopedTrace::~ScopedTrace(){
+    if (active) Trace::record(name, start, chrono::steady_clock::now());
+}
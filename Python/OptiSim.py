@@ -97,30 +97,23 @@ class OpticalSystem(object):
     # Retrieves all optical elements in the system.
     def getSystemElements(self):
         try:
-            # Get a map of optical elements by their names.
-            name_lens_map = self.system.getSystemElements()
             # Create an outer HashMap to store details of each element.
             outer_map = HashMap()
-            # Iterate through each element in the retrieved map.
-            for name, oo in name_lens_map.items():
+            # The registered element types, with the names of their parameters, by type ID.
+            types = {element_type["id"]: element_type for element_type in op.getElementTypes()}
+            # Iterate through the descriptions of the elements; the elements themselves are not copied.
+            for element in self.system.getElements():
                 # Create an inner HashMap for current element's properties.
                 inner_map = HashMap()
-                # Check if the element is a ThinLens.
-                if isinstance(oo, op.ThinLens):
-                    inner_map.put("type", "ThinLens")
-                    inner_map.put("x", oo.getX())
-                    inner_map.put("f", oo.getF())
-                # Check if the element is a ThickLens.
-                elif isinstance(oo, op.ThickLens):
-                    inner_map.put("type", "ThickLens")
-                    inner_map.put("x", oo.getX())
-                    inner_map.put("n", oo.getN())
-                    inner_map.put("d", oo.getD())
-                    inner_map.put("r_left", oo.getR_left())
-                    inner_map.put("r_right", oo.getR_right())
-                    inner_map.put("f", oo.getF())
+                element_type = types[int(element["type"])]
+                # The class name of the type, e.g. "ThinLens" for "Thin Lens".
+                inner_map.put("type", element_type["label"].replace(" ", ""))
+                inner_map.put("x", element["x"])
+                # Every parameter of the type's schema, e.g. "f" for a thin lens.
+                for param in element_type["params"]:
+                    inner_map.put(param, self.system.getParameter(element["name"], param))
                 # Add the inner map (element details) to the outer map with its name as key.
-                outer_map.put(name, inner_map)
+                outer_map.put(element["name"], inner_map)
         except op.OptiSimError as e:
             # If an OptiSimError occurs, re-raise it as an optisim_java.OptiSimError.
             raise optisim_java.OptiSimError(str(e))
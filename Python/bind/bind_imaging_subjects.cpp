@@ -32,7 +32,9 @@ void bind_imaging_subjects(py::module_& m) {
         .def("getX", &ImagingSubject::getX, "Gets the X-coordinate of the subject.")
         .def("setX", &ImagingSubject::setX, "Sets the X-coordinate of the subject.")
         .def("getY", &ImagingSubject::getY, "Gets the Y-coordinate of the subject.")
-        .def("setY", &ImagingSubject::setY, "Sets the Y-coordinate of the subject.");
+        .def("setY", &ImagingSubject::setY, "Sets the Y-coordinate of the subject.")
+        .def("getZ", &ImagingSubject::getZ, "Gets the Z-coordinate of the subject.")
+        .def("setZ", &ImagingSubject::setZ, "Sets the Z-coordinate of the subject.");
 
     /**
      * @brief Python binding for the `LightSource` class, derived from `ImagingSubject`.
@@ -40,9 +42,9 @@ void bind_imaging_subjects(py::module_& m) {
      * Represents a light-emitting source within the imaging simulation.
      */
     py::class_<LightSource, ImagingSubject>(m, "LightSource", "Represents a point light source in the simulation.")
-        .def(py::init<double, double>(),
-             py::arg("x"), py::arg("y"),
-             "Initializes a LightSource with specified X and Y coordinates.");
+        .def(py::init<double, double, double>(),
+             py::arg("x"), py::arg("y"), py::arg("z") = 0.0,
+             "Initializes a LightSource with specified X, Y and (optionally) Z coordinates.");
 
     /**
      * @brief Python binding for the `Image` class, derived from `ImagingSubject`.
@@ -50,9 +52,9 @@ void bind_imaging_subjects(py::module_& m) {
      * Represents an image formed by light, which can be real or virtual.
      */
     py::class_<Image, ImagingSubject>(m, "Image", "Represents an image (real or virtual) in the simulation.")
-        .def(py::init<double, double, bool>(),
-             py::arg("x"), py::arg("y"), py::arg("is_real"),
-             "Initializes an Image with specified X, Y coordinates, and real/virtual status.")
+        .def(py::init<double, double, bool, double>(),
+             py::arg("x"), py::arg("y"), py::arg("is_real"), py::arg("z") = 0.0,
+             "Initializes an Image with specified X, Y coordinates, real/virtual status and (optionally) Z coordinate.")
         .def("getReal", &Image::getReal, "Checks if the image is real (True) or virtual (False).")
         .def("setReal", &Image::setReal, "Sets the real/virtual status of the image.");
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+/**
+* @file bind_instrumentation.cpp
+* @brief Defines the bind_instrumentation function
+* @author Bács Tamás <tamas.bacs@stud.ubbcluj.ro>
+* @author Vitus Szabolcs <szabolcs.vitus1@stud.ubbcluj.ro>
+* @date 2025-06-09
+*/
+
+#include <pybind11/pybind11.h>
+#include <sstream> // For stringstream to capture the report
+
+#include "Instrumentation.h" // Timers and counters of the library
+
+namespace py = pybind11;
+
+/**
+ * @brief Binds the aggregated timers and counters of the instrumentation layer to Python.
+ *
+ * The statistics are exposed as module-level functions, since they are shared by every
+ * system of the process.
+ *
+ * @param m A reference to the pybind11 module to which the functions will be bound.
+ */
+void bind_instrumentation(py::module_ &m) {
+    m.def("getStats", []() {
+        py::dict phases;
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            stats_phase phase = (stats_phase)i;
+            py::dict timer;
+            timer["calls"] = Instrumentation::getCalls(phase);
+            timer["total_seconds"] = Instrumentation::getSeconds(phase);
+            timer["max_seconds"] = Instrumentation::getMaxSeconds(phase);
+            phases[Instrumentation::getName(phase)] = timer;
+        }
+        py::dict counters;
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            counters[Instrumentation::getName((stats_counter)i)] = Instrumentation::getCount((stats_counter)i);
+        }
+        py::dict stats;
+        stats["enabled"] = Instrumentation::isEnabled();
+        stats["phases"] = phases;
+        stats["counters"] = counters;
+        return stats;
+    }, "Returns the aggregated timings of every phase and the event counters as a dictionary.");
+
+    m.def("resetStats", &Instrumentation::reset,
+          "Sets every timer and counter to zero.");
+
+    m.def("printStats", []() {
+        std::stringstream ss;
+        Instrumentation::report(ss);
+        py::print(ss.str()); // Print to Python's stdout
+    }, "Prints a table of the timings and counters to standard output.");
+}
@@ -11,6 +11,10 @@
 #include "Lens.h"    
 #include "ThickLens.h"
 #include "ThinLens.h"
+#include "ApertureStop.h"
+#include "Mirror.h"
+#include "ParallelPlate.h"
+#include <limits>
 
 namespace py = pybind11;
 
@@ -18,7 +22,7 @@ namespace py = pybind11;
  * @brief Binds the C++ `OpticalObject` class and its derived classes to Python.
  *
  * This function defines the Python interface for `OpticalObject`, `Lens`,
- * `ThinLens`, and `ThickLens` classes, making their constructors and methods
+ * `ThinLens`, `ThickLens`, `ApertureStop`, `Mirror` and `ParallelPlate` classes, making their constructors and methods
  * accessible from Python.
  *
  * @param m A reference to the pybind11 module to which the classes will be bound.
@@ -31,7 +35,20 @@ void bind_optical_objects(py::module_& m) {
      */
     py::class_<OpticalObject>(m, "OpticalObject", "Abstract base class for all optical components.")
         .def("getX", &OpticalObject::getX, "Gets the X-coordinate (position along the optical axis) of the object.")
-        .def("setX", &OpticalObject::setX, py::arg("x"), "Sets the X-coordinate (position along the optical axis) of the object.");
+        .def("setX", &OpticalObject::setX, py::arg("x"), "Sets the X-coordinate (position along the optical axis) of the object.")
+        .def("getY", &OpticalObject::getY, "Gets the decentering of the object along the Y axis.")
+        .def("setY", &OpticalObject::setY, py::arg("y"), "Sets the decentering of the object along the Y axis.")
+        .def("getZ", &OpticalObject::getZ, "Gets the decentering of the object along the Z axis.")
+        .def("setZ", &OpticalObject::setZ, py::arg("z"), "Sets the decentering of the object along the Z axis.")
+        .def("getTiltY", &OpticalObject::getTiltY, "Gets the tilt of the object about the Y axis, in degrees.")
+        .def("setTiltY", &OpticalObject::setTiltY, py::arg("tilt_y"), "Sets the tilt of the object about the Y axis, in degrees.")
+        .def("getTiltZ", &OpticalObject::getTiltZ, "Gets the tilt of the object about the Z axis, in degrees.")
+        .def("setTiltZ", &OpticalObject::setTiltZ, py::arg("tilt_z"), "Sets the tilt of the object about the Z axis, in degrees.")
+        .def("getAperture", &OpticalObject::getAperture, "Gets the radius of the clear aperture (infinity if unlimited).")
+        .def("setAperture", &OpticalObject::setAperture, py::arg("aperture"), "Sets the radius of the clear aperture.")
+        .def("isCentered", &OpticalObject::isCentered, "Checks if the object is neither decentered nor tilted.")
+        .def("CalculateOffAxis", &OpticalObject::CalculateOffAxis, py::arg("imaging_subject"),
+             "Calculates the image of a point anywhere in space, taking decentering and tilt into account.");
 
     /**
      * @brief Python binding for the `Lens` base class, derived from `OpticalObject`.
@@ -72,4 +89,44 @@ void bind_optical_objects(py::module_& m) {
         .def("setR_left", &ThickLens::setR_Left, py::arg("r_left"), "Sets the radius of curvature of the left surface.")
         .def("getR_right", &ThickLens::getR_Right, "Gets the radius of curvature of the right surface.")
         .def("setR_right", &ThickLens::setR_Right, py::arg("r_right"), "Sets the radius of curvature of the right surface.");
+
+    /**
+     * @brief Python binding for the `ApertureStop` class, derived from `OpticalObject`.
+     *
+     * Represents a circular opening that blocks the rays outside its radius.
+     */
+    py::class_<ApertureStop, OpticalObject>(m, "ApertureStop", "Represents an aperture stop (diaphragm) without optical power.")
+        .def(py::init<double, double>(), py::arg("x"), py::arg("aperture"),
+             "Initializes an ApertureStop with a specified X-coordinate and aperture radius.")
+        .def("Calculate", &ApertureStop::Calculate, py::arg("imaging_subject"),
+             "Calculates the image formed by the stop, which is the imaging subject itself.");
+
+    /**
+     * @brief Python binding for the `Mirror` class, derived from `Lens`.
+     *
+     * Represents a spherical or plane mirror, modelled in the unfolded system.
+     */
+    py::class_<Mirror, Lens>(m, "Mirror", "Represents a spherical or plane mirror, modelled in the unfolded system.")
+        .def(py::init<double, double>(), py::arg("x"), py::arg("r") = std::numeric_limits<double>::infinity(),
+             "Initializes a Mirror with a specified X-coordinate and radius of curvature (plane if omitted).")
+        .def("Calculate", &Mirror::Calculate, py::arg("imaging_subject"),
+             "Calculates the image formed by the mirror for a given imaging subject.")
+        .def("getR", &Mirror::getR, "Gets the radius of curvature of the mirror.")
+        .def("setR", &Mirror::setR, py::arg("r"), "Sets the radius of curvature of the mirror.");
+
+    /**
+     * @brief Python binding for the `ParallelPlate` class, derived from `OpticalObject`.
+     *
+     * Represents a window with flat, parallel faces.
+     */
+    py::class_<ParallelPlate, OpticalObject>(m, "ParallelPlate", "Represents a window with flat, parallel faces.")
+        .def(py::init<double, double, double>(), py::arg("x"), py::arg("n"), py::arg("d"),
+             "Initializes a ParallelPlate with X-coordinate, refractive index and thickness.")
+        .def("Calculate", &ParallelPlate::Calculate, py::arg("imaging_subject"),
+             "Calculates the image formed by the plate for a given imaging subject.")
+        .def("getN", &ParallelPlate::getN, "Gets the refractive index of the plate.")
+        .def("setN", &ParallelPlate::setN, py::arg("n"), "Sets the refractive index of the plate.")
+        .def("getD", &ParallelPlate::getD, "Gets the thickness of the plate.")
+        .def("setD", &ParallelPlate::setD, py::arg("d"), "Sets the thickness of the plate.")
+        .def("getShift", &ParallelPlate::getShift, "Gets the axial shift of the images formed by the plate.");
 }
\ No newline at end of file
@@ -11,17 +11,69 @@
 #include <pybind11/functional.h> // For lambda binding if needed
 #include <sstream> // For stringstream to capture toString output
 #include <fstream> // For ofstream to save to file
+#include <algorithm> // For std::min
 
 #include "OpticalSystem.h" // Your OpticalSystem header
+#include "ElementRegistry.h" // The registered element types
 #include "OpticalObject.h" // Base class
 #include "Lens.h"         // Base for Thin/ThickLens
 #include "ThinLens.h"     // Concrete lens types
 #include "ThickLens.h"
+#include "ApertureStop.h"
 #include "LightSource.h"     // Concrete object type
 #include "Image.h"         // Return type for Calculate
 
 namespace py = pybind11;
 
+/**
+ * @brief Converts an element description to a Python dictionary, copying its name.
+ *
+ * @param info The description of the element.
+ * @return A dictionary with the keys of `element_info`.
+ */
+static py::dict element_dict(const element_info& info) {
+    py::dict element;
+    element["name"] = py::str(info.name.data(), info.name.size());
+    element["type"] = info.type;
+    element["x"] = info.x;
+    element["f"] = info.f;
+    element["n"] = info.n;
+    element["d"] = info.d;
+    element["r_left"] = info.r_left;
+    element["r_right"] = info.r_right;
+    element["y"] = info.y;
+    element["z"] = info.z;
+    element["tilt_y"] = info.tilt_y;
+    element["tilt_z"] = info.tilt_z;
+    element["aperture"] = info.aperture;
+    return element;
+}
+
+/**
+ * @brief Resolves an optional writable one-dimensional buffer of the given item type.
+ *
+ * The buffer is exported into `info`, which the caller keeps alive until it is done writing through the address:
+ * destroying it releases the export.
+ *
+ * @tparam T The item type of the buffer.
+ * @param buffer A buffer object (e.g. a NumPy array or an `array.array`), or None.
+ * @param info Receives the exported buffer.
+ * @param capacity Lowered to the length of the buffer.
+ * @return The address of the first item, or `nullptr` for None.
+ * @throws py::value_error If the buffer is read-only, not one-dimensional and contiguous, or of another item type.
+ */
+template <class T>
+static T* export_column(const py::object& buffer, py::buffer_info& info, size_t& capacity) {
+    if (buffer.is_none()) return nullptr;
+    info = py::reinterpret_borrow<py::buffer>(buffer).request(true);
+    if (info.ndim != 1 || info.strides[0] != (py::ssize_t)sizeof(T) || info.itemsize != (py::ssize_t)sizeof(T) ||
+        info.format != py::format_descriptor<T>::format()) {
+        throw py::value_error("exportElements expects contiguous one-dimensional arrays of type " + py::format_descriptor<T>::format());
+    }
+    capacity = std::min(capacity, (size_t)info.shape[0]);
+    return static_cast<T*>(info.ptr);
+}
+
 /**
  * @brief Binds the C++ `ray` structure and `OpticalSystem` class to Python.
  *
@@ -43,6 +95,85 @@ void bind_optical_system(py::module_ &m) {
         .def_readwrite("x", &ray::x, "The X-coordinate of the ray.")
         .def_readwrite("y", &ray::y, "The Y-coordinate of the ray.");
 
+    /**
+     * @brief Python binding for the `ray_bundle` structure.
+     *
+     * A bundle of rays in three dimensions, one list per coordinate.
+     */
+    py::class_<ray_bundle>(m, "RayBundle", "A bundle of rays in three dimensions, stored as one list per coordinate.")
+        .def(py::init<>(), "Initializes an empty RayBundle.")
+        .def_readwrite("x", &ray_bundle::x, "The X-coordinates of the rays.")
+        .def_readwrite("y", &ray_bundle::y, "The Y-coordinates of the rays.")
+        .def_readwrite("z", &ray_bundle::z, "The Z-coordinates of the rays.")
+        .def_readwrite("u", &ray_bundle::u, "The slopes dy/dx of the rays.")
+        .def_readwrite("v", &ray_bundle::v, "The slopes dz/dx of the rays.")
+        .def_readwrite("vignetted", &ray_bundle::vignetted,
+                       "The position of the element that blocked each ray, or -1 if the ray passed every element.");
+
+    /**
+     * @brief Python binding for the `beam_bundle` structure.
+     *
+     * A batch of paraxial Gaussian beams, one list per quantity.
+     */
+    py::class_<beam_bundle>(m, "BeamBundle", "A batch of paraxial Gaussian beams, stored as one list per quantity.")
+        .def(py::init<>(), "Initializes an empty BeamBundle.")
+        .def_readwrite("waist_x", &beam_bundle::waist_x, "The positions of the input waists.")
+        .def_readwrite("waist_w", &beam_bundle::waist_w, "The radii of the input waists.")
+        .def_readwrite("wavelength", &beam_bundle::wavelength, "The wavelengths of the beams in micrometres.")
+        .def_readwrite("x", &beam_bundle::x, "The waist positions after each element, element-major.")
+        .def_readwrite("w", &beam_bundle::w, "The waist radii after each element, element-major.")
+        .def_readwrite("rayleigh", &beam_bundle::rayleigh, "The Rayleigh ranges after each element, element-major.")
+        .def_readwrite("spot", &beam_bundle::spot, "The beam radii at each element, element-major.");
+
+    /**
+     * @brief Python binding for the `pupil_info` structure.
+     *
+     * The paraxial pupils and field of a centered system.
+     */
+    py::class_<pupil_info>(m, "PupilInfo", "The paraxial pupils and field of a centered system.")
+        .def_readonly("aperture_stop", &pupil_info::aperture_stop, "The position in the optical order of the aperture stop.")
+        .def_readonly("field_stop", &pupil_info::field_stop, "The position in the optical order of the field stop, or -1.")
+        .def_readonly("entrance_x", &pupil_info::entrance_x, "The position of the entrance pupil.")
+        .def_readonly("entrance_radius", &pupil_info::entrance_radius, "The radius of the entrance pupil.")
+        .def_readonly("exit_x", &pupil_info::exit_x, "The position of the exit pupil.")
+        .def_readonly("exit_radius", &pupil_info::exit_radius, "The radius of the exit pupil.")
+        .def_readonly("marginal_u", &pupil_info::marginal_u, "The slope of the marginal ray at the object.")
+        .def_readonly("chief_u", &pupil_info::chief_u, "The slope of the chief ray at the object.")
+        .def_readonly("na_object", &pupil_info::na_object, "The numerical aperture in object space.")
+        .def_readonly("na_image", &pupil_info::na_image, "The numerical aperture in image space.")
+        .def_readonly("field_height", &pupil_info::field_height, "The object height at the edge of the field.")
+        .def_readonly("field_angle", &pupil_info::field_angle, "The half field of view, in degrees.");
+
+    /**
+     * @brief Python binding for the `element_type` enumeration.
+     */
+    py::enum_<element_type>(m, "ElementType", "The kinds of optical objects a system can hold.")
+        .value("THIN_LENS", ELEMENT_THIN_LENS)
+        .value("THICK_LENS", ELEMENT_THICK_LENS)
+        .value("STOP", ELEMENT_STOP)
+        .value("MIRROR", ELEMENT_MIRROR)
+        .value("PLATE", ELEMENT_PLATE);
+
+    /**
+     * @brief Describes the types of the `ElementRegistry`, so Python code can handle types registered in C++.
+     */
+    m.def("getElementTypes", []() {
+        py::list types;
+        ElementRegistry& registry = ElementRegistry::global();
+        for (int id = 0; id < registry.size(); id++) {
+            const element_class& type = registry.get(id);
+            py::dict entry;
+            py::list params;
+            for (const element_param& param : type.params) params.append(param.name);
+            entry["id"] = type.id;
+            entry["name"] = type.name;
+            entry["label"] = type.label;
+            entry["params"] = params;
+            types.append(entry);
+        }
+        return types;
+    }, "Describes every registered element type as a dictionary with its ID, name, label and parameter names.");
+
     /**
      * @brief Python binding for the `OpticalSystem` class.
      *
@@ -57,27 +188,38 @@ void bind_optical_system(py::module_ &m) {
 
         // Add methods
         // Overload for adding OpticalObject (Lenses)
-        .def("add", static_cast<void(OpticalSystem::*)(OpticalObject&, std::string)>(&OpticalSystem::add),
+        .def("add", static_cast<void(OpticalSystem::*)(OpticalObject&, std::string_view)>(&OpticalSystem::add),
              py::arg("optical_object"), py::arg("name"),
              "Adds an OpticalObject (e.g., Lens) to the system with a given name.")
         // Overload for adding LightSource
-        .def("add", static_cast<void(OpticalSystem::*)(LightSource)>(&OpticalSystem::add),
+        .def("add", static_cast<void(OpticalSystem::*)(const LightSource&)>(&OpticalSystem::add),
              py::arg("light_source"),
              "Adds a LightSource to the system.")
 
         // Modify methods
         .def("modifyLightSource", &OpticalSystem::modifyLightSource,
              py::arg("param"), py::arg("val"),
-             "Modifies a parameter of the LightSource (e.g., 'x', 'y').")
+             "Modifies a parameter of the LightSource (e.g., 'x', 'y', 'z').")
         .def("modifyOpticalObject", &OpticalSystem::modifyOpticalObject,
              py::arg("name"), py::arg("param"), py::arg("val"),
-             "Modifies a parameter of an OpticalObject by its name (e.g., 'x', 'f', 'n').")
+             "Modifies a parameter of an OpticalObject by its name (e.g., 'x', 'tilt_y', 'aperture', 'f', 'n', 'r').")
+        .def("getParameter", &OpticalSystem::getParameter,
+             py::arg("name"), py::arg("param"),
+             "Reads a parameter of an OpticalObject by its name, including derived ones such as the 'f' of a thick lens.")
 
         // Other methods
         .def("getImageSequence", &OpticalSystem::getImageSequence,
              "Retrieves a sequence of images generated by the system.")
         .def("Calculate", &OpticalSystem::Calculate,
              "Calculates and simulates the light propagation through the system, returning the final image.")
+        .def("TraceRays", &OpticalSystem::TraceRays, py::arg("rays"),
+             "Traces a RayBundle through the elements of the system, updating it in place and marking the vignetted rays.")
+        .def("getPupils", &OpticalSystem::getPupils, py::return_value_policy::copy,
+             "Computes the entrance and exit pupils, numerical aperture and field of view of the system.")
+        .def("SampleField", &OpticalSystem::SampleField, py::arg("fields"), py::arg("rings"),
+             "Creates a RayBundle sampling the field and the aperture stop of the system on a hexapolar grid.")
+        .def("PropagateBeams", &OpticalSystem::PropagateBeams, py::arg("beams"),
+             "Propagates a BeamBundle of Gaussian beams through the elements, filling in the waist after each element.")
         // toString method: Capture ostream output to std::string for Python
         .def("toString", [](OpticalSystem &self) {
             std::stringstream ss;
@@ -96,8 +238,35 @@ void bind_optical_system(py::module_ &m) {
              "Saves the current state of the optical system to a file.")
         .def("remove", &OpticalSystem::remove, py::arg("name"),
              "Removes an optical object from the system by its name.")
-        .def("getSystemElements", &OpticalSystem::getSystemElements,
-             "Gets a list of all optical elements (excluding the light source) in the system.")
+        .def("getSystemElements", &OpticalSystem::getSystemElements, py::return_value_policy::take_ownership,
+             "Gets copies of all optical elements (excluding the light source) in the system.")
+        .def("getElements", [](OpticalSystem &self) {
+            py::list elements;
+            for (const element_info& info : self.getElements()) elements.append(element_dict(info));
+            return elements;
+        }, "Describes every optical element in optical order as a dictionary, without copying the elements.")
+        .def("getElementCount", &OpticalSystem::getElementCount,
+             "Gets the number of optical elements (excluding the light source) in the system.")
+        .def("getElement", [](OpticalSystem &self, size_t index) { return element_dict(self.getElement(index)); },
+             py::arg("index"),
+             "Describes the optical element at a position of the optical order as a dictionary.")
+        .def("exportElements", [](OpticalSystem &self, py::object type, py::object x, py::object f, py::object n,
+                                  py::object d, py::object r_left, py::object r_right) {
+            size_t capacity = self.getElementCount();
+            py::buffer_info views[7]; // the exports stay alive until the columns are written
+            int* type_column = export_column<int>(type, views[0], capacity);
+            double* x_column = export_column<double>(x, views[1], capacity);
+            double* f_column = export_column<double>(f, views[2], capacity);
+            double* n_column = export_column<double>(n, views[3], capacity);
+            double* d_column = export_column<double>(d, views[4], capacity);
+            double* r_left_column = export_column<double>(r_left, views[5], capacity);
+            double* r_right_column = export_column<double>(r_right, views[6], capacity);
+            return self.exportElements(type_column, x_column, f_column, n_column,
+                                       d_column, r_left_column, r_right_column, capacity);
+        }, py::arg("type") = py::none(), py::arg("x") = py::none(), py::arg("f") = py::none(), py::arg("n") = py::none(),
+           py::arg("d") = py::none(), py::arg("r_left") = py::none(), py::arg("r_right") = py::none(),
+           "Writes the element parameters in optical order into writable buffers (int32 types, float64 parameters); "
+           "None skips a column. Returns the number of elements written.")
         .def("getLightSource", &OpticalSystem::getLightSource,
              "Gets the LightSource object currently configured in the system.")
         .def("getRays", &OpticalSystem::getRays,
@@ -16,6 +16,7 @@ namespace py = pybind11;
 void bind_imaging_subjects(py::module_& m);
 void bind_optical_objects(py::module_& m);
 void bind_optical_system(py::module_& m);
+void bind_instrumentation(py::module_& m);
 
 /**
  * @brief Main pybind11 module definition for the OptiSim library.
@@ -35,6 +36,7 @@ PYBIND11_MODULE(optisim, m) {
     bind_optical_objects(m);
     bind_imaging_subjects(m);
     bind_optical_system(m);
+    bind_instrumentation(m);
 
     /**
      * @brief Registers the custom `OptiSimError` C++ exception as a Python exception.
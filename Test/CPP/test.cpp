@@ -2,10 +2,40 @@
 #include <iostream>  // For standard input/output operations (cout, cerr)
 #include <vector>    // For using std::vector
 #include <iomanip>   // For formatting output (setw, setprecision)
+#include <fstream>   // For writing test input files
+#include <cmath>     // For std::isfinite
+#include <sstream>   // For capturing reports
+#include <cstring>   // For std::strcpy and std::memcpy
+#include <thread>    // For running the server event loop
+#include <unistd.h>  // For read and close
+#include <sys/socket.h> // For the server test clients
+#include <sys/un.h>  // For Unix socket addresses
+#include <memory_resource> // For the counting resource of the pool test
+#include <atomic>    // For the heap allocation counter
+#include <cstdlib>   // For std::malloc and std::free
+#include <new>       // For std::bad_alloc
+#include <filesystem> // For removing the report directory of the batch test
 #include "OptiSim.h" // Main header for the OptiSim library components
 
 using namespace std;
 
+// Every heap allocation of the test program is counted, so the allocation test can prove that a
+// recalculation does not touch the heap.
+static atomic<long long> HeapAllocations(0);
+
+void* operator new(size_t size){
+    HeapAllocations++;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept{
+    free(p);
+}
 
 void test_LightSource(){
     cout << "\n\nTesting \e[1mLightSource:\e[0m\n\n";
@@ -85,6 +115,191 @@ void test_ThickLens(){
 
     if (ThickL.getF()==200) cout << "\tThickLens -> getF() : works properly\n";
     else cout << "\tThickLens -> getF() : works faulty\n";
+
+    // The cached principal planes follow every setter, including setX through a base class pointer
+    ThickLens Cached = ThickLens(50, 1.5, 5, 30, -30);
+    LightSource LS = LightSource(0, 5);
+    Cached.Calculate(LS);
+    OpticalObject* Base = &Cached;
+    Base->setX(60);
+    Cached.setN(1.6);
+    Cached.setR_Left(40);
+    Image Moved = Cached.Calculate(LS);
+    Image Fresh = ThickLens(60, 1.6, 5, 40, -30).Calculate(LS);
+    if (Moved.getX() == Fresh.getX() && Moved.getY() == Fresh.getY())
+        cout << "\tThickLens -> Calculate(ImagingSubject) after setX(double) : works properly\n";
+    else cout << "\tThickLens -> Calculate(ImagingSubject) after setX(double) : works faulty\n";
+}
+void test_DispersionModel(){
+    cout << "\n\nTesting \e[1mDispersionModel:\e[0m\n\n";
+    DispersionModel Cauchy = DispersionModel("cauchy", {1.5, 0.004});
+    DispersionModel Sellmeier = DispersionModel("sellmeier", {1.03961212, 0.231792344, 1.01046945},
+                                                             {0.00600069867, 0.0200179144, 103.560653});
+
+    if (abs(Cauchy.getIndex(0.5) - 1.516) < 1e-12) cout << "\tDispersionModel -> getIndex(double) (Cauchy) : works properly\n";
+    else cout << "\tDispersionModel -> getIndex(double) (Cauchy) : works faulty\n";
+    // N-BK7 at the helium d-line
+    if (abs(Sellmeier.getIndex(0.5875618) - 1.5168) < 1e-4) cout << "\tDispersionModel -> getIndex(double) (Sellmeier) : works properly\n";
+    else cout << "\tDispersionModel -> getIndex(double) (Sellmeier) : works faulty\n";
+
+    // A dispersive thick lens images each wavelength like a plain lens with that wavelength's index
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThickLens ThickL = ThickLens(40, 1.5, 4, 20, -25);
+    ThickL.setDispersion(make_shared<DispersionModel>(Sellmeier));
+    OS.add(ThickL, "Lens1");
+    vector<double> Wavelengths = {0.4861327, 0.5875618, 0.6562725};
+    vector<Image> Images = OS.CalculateChromatic(Wavelengths);
+    vector<double> Focals = ThickL.getFocalLengths(Wavelengths);
+
+    bool ok = Images.size() == 3 && ThickL.getN() == Sellmeier.getIndex(0.5875618);
+    for (int i = 0; ok && i < 3; i++) {
+        OpticalSystem Plain = OpticalSystem();
+        Plain.add(LightSource(0, 5));
+        ThickLens PlainL = ThickLens(40, Sellmeier.getIndex(Wavelengths[i]), 4, 20, -25);
+        Plain.add(PlainL, "Lens1");
+        Image PlainI = Plain.Calculate();
+        ok = abs(Images[i].getX() - PlainI.getX()) < 1e-9 && abs(Images[i].getY() - PlainI.getY()) < 1e-9 &&
+             Images[i].getReal() == PlainI.getReal() && abs(Focals[i] - PlainL.getF()) < 1e-9;
+    }
+    if (ok && Focals[0] < Focals[2]) cout << "\tOpticalSystem -> CalculateChromatic(vector<double>) & getFocalLengths(vector<double>) : works properly\n";
+    else cout << "\tOpticalSystem -> CalculateChromatic(vector<double>) || getFocalLengths(vector<double>) : works faulty\n";
+
+    // The dispersion model survives save & reload
+    OS.save("saved_chromatic.json");
+    OpticalSystem OS2 = OpticalSystem("saved_chromatic.json");
+    remove("saved_chromatic.json");
+    vector<Image> Images2 = OS2.CalculateChromatic(Wavelengths);
+    if (Images2[0].getX() == Images[0].getX() && Images2[2].getX() == Images[2].getX())
+        cout << "\tOpticalSystem -> save(string) & OpticalSystem(string) with dispersion : works properly\n";
+    else cout << "\tOpticalSystem -> save(string) || OpticalSystem(string) with dispersion : works faulty\n";
+
+    // Setting the index replaces the dispersion, in memory and after save & reload
+    OS2.modifyOpticalObject("Lens1", "n", 1.8);
+    Image Modified = OS2.Calculate();
+    vector<Image> ModifiedChromatic = OS2.CalculateChromatic(Wavelengths);
+    OS2.save("saved_modified.json");
+    OpticalSystem OS3 = OpticalSystem("saved_modified.json");
+    remove("saved_modified.json");
+    element_info Info = OS3.getElement(0);
+    ok = Info.n == 1.8 && OS3.Calculate().getX() == Modified.getX();
+    for (const Image& I : ModifiedChromatic) ok &= I.getX() == Modified.getX();
+    if (ok) cout << "\tThickLens -> setN(double) on a dispersive lens & save(string) & OpticalSystem(string) : works properly\n";
+    else cout << "\tThickLens -> setN(double) on a dispersive lens || save(string) || OpticalSystem(string) : works faulty\n";
+
+    bool Rejected = false;
+    try {
+        stringstream Both("{\"object\": {\"position\": 0.0, \"size\": 1.0}, \"lenses\": [{\"type\": \"thick\", \"name\": \"L\", "
+                          "\"position\": 40.0, \"refractive_index\": 1.8, \"dispersion\": {\"model\": \"cauchy\", \"coefficients\": [1.5]}, "
+                          "\"thickness\": 4.0, \"radius_left\": 20.0, \"radius_right\": -25.0}]}");
+        OpticalSystem Invalid = OpticalSystem(Both);
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    if (Rejected) cout << "\tOpticalSystem -> OpticalSystem(istream) with a refractive index and a dispersion : works properly\n";
+    else cout << "\tOpticalSystem -> OpticalSystem(istream) with a refractive index and a dispersion : works faulty\n";
+}
+
+void test_MaterialCatalog(){
+    cout << "\n\nTesting \e[1mMaterialCatalog:\e[0m\n\n";
+    MaterialCatalog Catalog = MaterialCatalog();
+    ofstream Csv("test_catalog.csv");
+    Csv << "name,model,coefficients\n"
+        << "# Cauchy crown\n"
+        << "Crown,cauchy,1.5,0.004\n"
+        << "N-BK7,sellmeier,1.03961212,0.231792344,1.01046945,0.00600069867,0.0200179144,103.560653\n";
+    Csv.close();
+    Catalog.load("test_catalog.csv");
+    Catalog.load("test_catalog.csv");
+    int Crown = Catalog.getId("Crown");
+    int Bk7 = Catalog.getId("N-BK7");
+    if (Catalog.size() == 2 && Crown != Bk7 && Catalog.getName(Bk7) == "N-BK7" && abs(Catalog.getIndex(Crown, 0.5) - 1.516) < 1e-12 &&
+        abs(Catalog.getIndex(Bk7, 0.5875618) - 1.5168) < 1e-4)
+        cout << "\tMaterialCatalog -> load(string) (CSV) & getId(string) & getIndex(int, double) : works properly\n";
+    else cout << "\tMaterialCatalog -> load(string) (CSV) || getId(string) || getIndex(int, double) : works faulty\n";
+
+    // Re-adding a name keeps its ID, and a different model for it is rejected
+    bool Redefined = false;
+    try {
+        Catalog.add("Crown", make_shared<DispersionModel>("cauchy", vector<double>{1.6}));
+    } catch (OptiSimError&) {
+        Redefined = true;
+    }
+    if (Catalog.add("Crown", make_shared<DispersionModel>("cauchy", vector<double>{1.5, 0.004})) == Crown && Redefined &&
+        abs(Catalog.getIndex(Crown, 0.5) - 1.516) < 1e-12 && Catalog.size() == 2)
+        cout << "\tMaterialCatalog -> add(string, shared_ptr<const DispersionModel>) : works properly\n";
+    else cout << "\tMaterialCatalog -> add(string, shared_ptr<const DispersionModel>) : works faulty\n";
+
+    // Every (material, wavelength) pair is evaluated once, however many lenses share the material
+    ofstream Json("test_catalog.json");
+    Json << "{\"materials\": ["
+         << "{\"name\": \"Fused Silica\", \"model\": \"sellmeier\", \"B\": [0.6961663, 0.4079426, 0.8974794], \"C\": [0.004679148, 0.01351206, 97.934003]},"
+         << "{\"name\": \"F2\", \"model\": \"sellmeier\", \"B\": [1.34533359, 0.209073176, 0.937357162], \"C\": [0.00997743871, 0.0470450767, 111.886764]}]}";
+    Json.close();
+    MaterialCatalog& Global = MaterialCatalog::global();
+    Global.load("test_catalog.json");
+    int Silica = Global.getId("Fused Silica");
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    for (int i = 0; i < 4; i++) {
+        ThickLens ThickL = ThickLens(40 + 20 * i, 1.5, 4, 20, -25);
+        ThickL.setMaterial(Silica);
+        OS.add(ThickL, "Lens" + to_string(i));
+    }
+    vector<double> Wavelengths = {0.4861327, 0.5875618, 0.6562725, 0.4861327};
+    long long Before = Global.getEvaluations();
+    vector<Image> Images = OS.CalculateChromatic(Wavelengths);
+    OS.CalculateChromatic(Wavelengths);
+    bool ok = Global.getEvaluations() - Before == 2 && Images[0].getX() == Images[3].getX();
+
+    OpticalSystem Plain = OpticalSystem();
+    Plain.add(LightSource(0, 5));
+    for (int i = 0; i < 4; i++) {
+        ThickLens ThickL = ThickLens(40 + 20 * i, 1.5, 4, 20, -25);
+        ThickL.setDispersion(Global.getModel(Silica));
+        Plain.add(ThickL, "Lens" + to_string(i));
+    }
+    vector<Image> PlainImages = Plain.CalculateChromatic(Wavelengths);
+    for (int i = 0; ok && i < 4; i++) ok = Images[i].getX() == PlainImages[i].getX() && Images[i].getY() == PlainImages[i].getY();
+    if (ok) cout << "\tThickLens -> setMaterial(int) & MaterialCatalog -> getIndices(int, const double*, double*, size_t) : works properly\n";
+    else cout << "\tThickLens -> setMaterial(int) || MaterialCatalog -> getIndices(int, const double*, double*, size_t) : works faulty\n";
+
+    // Systems name their catalog and materials
+    ofstream System("test_materials.json");
+    System << "{\"glass_catalog\": \"test_catalog.json\", \"object\": {\"position\": 0.0, \"size\": 1.0}, \"lenses\": ["
+           << "{\"type\": \"thick\", \"name\": \"Flint\", \"material\": \"F2\", \"position\": 110.0, \"thickness\": 2.0, \"radius_left\": -25.0, \"radius_right\": -120.0}]}";
+    System.close();
+    OpticalSystem OS2 = OpticalSystem("test_materials.json");
+    remove("test_materials.json");
+    map<string, OpticalObject*> Elements = OS2.getSystemElements();
+    ThickLens* Flint = dynamic_cast<ThickLens*>(Elements["Flint"]);
+    if (Flint && Flint->getMaterial() == Global.getId("F2"))
+        cout << "\tOpticalSystem -> OpticalSystem(string) with materials : works properly\n";
+    else cout << "\tOpticalSystem -> OpticalSystem(string) with materials : works faulty\n";
+
+    // A system saved into another directory still finds its catalog, and a system without a catalog keeps its dispersion
+    filesystem::create_directory("test_saved");
+    OS2.save("test_saved/test_materials.json");
+    ifstream Saved("test_saved/test_materials.json");
+    string SavedText((istreambuf_iterator<char>(Saved)), istreambuf_iterator<char>());
+    Saved.close();
+    OpticalSystem Reloaded = OpticalSystem("test_saved/test_materials.json");
+    ThickLens* ReloadedFlint = dynamic_cast<ThickLens*>(Reloaded.getSystemElements()["Flint"]);
+    OS.save("test_saved/test_programmatic.json");
+    ifstream Programmatic("test_saved/test_programmatic.json");
+    string ProgrammaticText((istreambuf_iterator<char>(Programmatic)), istreambuf_iterator<char>());
+    Programmatic.close();
+    OpticalSystem ReloadedOS = OpticalSystem("test_saved/test_programmatic.json");
+    vector<Image> ReloadedImages = ReloadedOS.CalculateChromatic(Wavelengths);
+    filesystem::remove_all("test_saved");
+    remove("test_catalog.json");
+    remove("test_catalog.csv");
+    ok = SavedText.find("\"glass_catalog\": \"../test_catalog.json\"") != string::npos && ReloadedFlint && ReloadedFlint->getMaterial() == Global.getId("F2") &&
+         ProgrammaticText.find("\"material\"") == string::npos && ProgrammaticText.find("\"dispersion\"") != string::npos;
+    for (int i = 0; ok && i < 4; i++) ok = Images[i].getX() == ReloadedImages[i].getX() && Images[i].getY() == ReloadedImages[i].getY();
+    if (ok) cout << "\tOpticalSystem -> save(string) with materials : works properly\n";
+    else cout << "\tOpticalSystem -> save(string) with materials : works faulty\n";
+    for (auto& E : Elements) delete E.second;
 }
 
 void test_OpticalSystem(){
@@ -117,6 +332,18 @@ void test_OpticalSystem(){
         cout << "\tOpticalSystem -> add(OpticalObject&, string) & getSystemElements() : works properly\n";
     else cout << "\tOpticalSystem -> add(OpticalObject&, string) || getSystemElements() : works faulty\n";
 
+    // Describe the Lenses without copying them & export their parameters into arrays
+    vector<string> Names;
+    for (const element_info& Info : OS.getElements()) Names.push_back(string(Info.name));
+    element_info ThickInfo = OS.getElement(1);
+    int Types[2];
+    double Xs[2], Ns[2];
+    size_t Count = OS.exportElements(Types, Xs, nullptr, Ns, nullptr, nullptr, nullptr, 2);
+    if (Names == vector<string>{"Lens1", "Lens2"} && ThickInfo.type == ELEMENT_THICK_LENS && ThickInfo.r_left == ThickL.getR_Left() &&
+        Count == 2 && Types[0] == ELEMENT_THIN_LENS && Xs[0] == ThinL.getX() && Xs[1] == ThickL.getX() && isnan(Ns[0]) && Ns[1] == ThickL.getN())
+        cout << "\tOpticalSystem -> getElements() & exportElements(...) : works properly\n";
+    else cout << "\tOpticalSystem -> getElements() || exportElements(...) : works faulty\n";
+
     // Modify LightSource & get LightSource from OpticalSystem & check whether the modification was successful
     OS.modifyLightSource("x",-20);
     OS.modifyLightSource("y",10);
@@ -188,13 +415,1046 @@ void test_OpticalSystem(){
 }
 
 
+void test_Optimizer(){
+    cout << "\n\nTesting \e[1mOptimizer:\e[0m\n\n";
+    // Place the image of a single thin lens at x = 40 by changing its focal length
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens ThinL = ThinLens(10, 5);
+    OS.add(ThinL, "Lens1");
+
+    Optimizer Opt = Optimizer(OS);
+    Opt.addVariable("Lens1", "f", 1, 20);
+    Opt.addTarget("x", 40);
+    optimization_result Res = Opt.run();
+    Image FinalI = OS.Calculate();
+
+    if (Res.converged && abs(FinalI.getX() - 40) < 1e-6 && abs(OS.getSystemElements()["Lens1"]->getX() - 10) < 1e-12)
+        cout << "\tOptimizer -> addVariable(string, string, double, double) & addTarget(string, double) & run() : works properly\n";
+    else cout << "\tOptimizer -> addVariable(string, string, double, double) || addTarget(string, double) || run() : works faulty\n";
+
+    // Move and reshape a thick lens so that the image and magnification match a reference system
+    OpticalSystem OSRef = OpticalSystem();
+    OSRef.add(LightSource(0, 2));
+    ThickLens ThickRef = ThickLens(50, 1.5, 3, 25, -40);
+    OSRef.add(ThickRef, "Lens1");
+    Image RefI = OSRef.Calculate();
+
+    OpticalSystem OS2 = OpticalSystem();
+    OS2.add(LightSource(0, 2));
+    ThickLens ThickL = ThickLens(45, 1.5, 3, 30, -40);
+    OS2.add(ThickL, "Lens1");
+
+    Optimizer Opt2 = Optimizer(OS2);
+    Opt2.addVariable("Lens1", "x", 30, 70);
+    Opt2.addVariable("Lens1", "r_left", 10, 100);
+    Opt2.addTarget("x", RefI.getX());
+    Opt2.addTarget("magnification", RefI.getY() / 2);
+    Res = Opt2.run();
+    FinalI = OS2.Calculate();
+
+    if (Res.converged && abs(FinalI.getX() - RefI.getX()) < 1e-6 && abs(FinalI.getY() - RefI.getY()) < 1e-6)
+        cout << "\tOptimizer -> run() with thick lens position and radius : works properly\n";
+    else cout << "\tOptimizer -> run() with thick lens position and radius : works faulty\n";
+}
+void test_ToleranceAnalysis(){
+    cout << "\n\nTesting \e[1mToleranceAnalysis:\e[0m\n\n";
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens ThinL = ThinLens(10, 5);
+    ThickLens ThickL = ThickLens(30, 1.5, 5, -20, 25);
+    OS.add(ThinL, "Lens1");
+    OS.add(ThickL, "Lens2");
+    Image NominalI = OS.Calculate();
+
+    // Without perturbation every trial reproduces the nominal image
+    ToleranceAnalysis TA = ToleranceAnalysis(OS);
+    TA.addTolerance("Lens1", "f", "normal", 0);
+    tolerance_result Res = TA.run(1000);
+    if (Res.failed == 0 && Res.position.count == 1000 && Res.position.stddev == 0 &&
+        abs(Res.position.mean - NominalI.getX()) < 1e-9 && abs(Res.size.mean - NominalI.getY()) < 1e-9)
+        cout << "\tToleranceAnalysis -> addTolerance(string, string, string, double) & run(long long) : works properly\n";
+    else cout << "\tToleranceAnalysis -> addTolerance(string, string, string, double) || run(long long) : works faulty\n";
+
+    // The same seed gives the same statistics regardless of the number of threads
+    ToleranceAnalysis TA1 = ToleranceAnalysis(OS);
+    ToleranceAnalysis TA4 = ToleranceAnalysis(OS);
+    for (ToleranceAnalysis* T : {&TA1, &TA4}) {
+        T->addTolerance("Lens1", "f", "normal", 0.05);
+        T->addTolerance("Lens2", "n", "uniform", 0.01);
+        T->addTolerance("Lens2", "x", "normal", 0.1);
+        T->setSeed(42);
+    }
+    TA1.setThreads(1);
+    TA4.setThreads(4);
+    tolerance_result Res1 = TA1.run(50000);
+    tolerance_result Res4 = TA4.run(50000);
+    double Median = Res1.position.percentile(50);
+    if (Res1.position.mean == Res4.position.mean && Res1.size.stddev == Res4.size.stddev &&
+        Res1.position.histogram == Res4.position.histogram && Res1.failed == Res4.failed &&
+        Res1.position.stddev > 0 && Median >= Res1.position.min && Median <= Res1.position.max)
+        cout << "\tToleranceAnalysis -> setSeed(uint64_t) & setThreads(int) & percentile(double) : works properly\n";
+    else cout << "\tToleranceAnalysis -> setSeed(uint64_t) || setThreads(int) || percentile(double) : works faulty\n";
+}
+
+void test_SystemGenerator(){
+    cout << "\n\nTesting \e[1mSystemGenerator:\e[0m\n\n";
+    SystemGenerator Generator = SystemGenerator(42);
+    OpticalSystem OS = OpticalSystem();
+    Generator.generate(OS, 1000);
+    map<string, OpticalObject*> Elements = OS.getSystemElements();
+    int Thick = 0;
+    for (auto& E : Elements) if (dynamic_cast<ThickLens*>(E.second)) Thick++;
+    if (Elements.size() == 1000 && Thick > 400 && Thick < 600 && std::isfinite(OS.Calculate().getX()))
+        cout << "\tSystemGenerator -> generate(OpticalSystem&, long long) : works properly\n";
+    else cout << "\tSystemGenerator -> generate(OpticalSystem&, long long) : works faulty\n";
+
+    // The JSON output loads into the same system, and the same seed gives the same system
+    Generator.write("generated_system.json", 1000);
+    OpticalSystem OS2 = OpticalSystem("generated_system.json");
+    remove("generated_system.json");
+    OpticalSystem OS3 = OpticalSystem();
+    SystemGenerator(42).generate(OS3, 1000);
+    vector<Image> Images = OS.getImageSequence();
+    OS2.Calculate();
+    OS3.Calculate();
+    if (OS2.getImageSequence().size() == Images.size() && OS2.Calculate().getX() == Images.back().getX() &&
+        OS3.Calculate().getY() == Images.back().getY())
+        cout << "\tSystemGenerator -> write(string, long long) : works properly\n";
+    else cout << "\tSystemGenerator -> write(string, long long) : works faulty\n";
+
+    try {
+        Generator.setSpacing(0.001);
+        cout << "\tSystemGenerator -> setSpacing(double) : works faulty\n";
+    } catch (OptiSimError& e) {
+        cout << "\tSystemGenerator -> setSpacing(double) : works properly\n";
+    }
+    for (auto& E : Elements) delete E.second;
+}
+
+void test_Instrumentation(){
+    cout << "\n\nTesting \e[1mInstrumentation:\e[0m\n\n";
+    Instrumentation::reset();
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens ThinL = ThinLens(20, 10);
+    ThickLens ThickL = ThickLens(60, 1.5, 4, 20, -25);
+    OS.add(ThinL, "Lens1");
+    OS.add(ThickL, "Lens2");
+    OS.Calculate();
+    OS.Calculate();
+    try {
+        OS.add(ThinL, "Lens1");
+    } catch (OptiSimError& e) {}
+
+    if (Instrumentation::getCalls(PHASE_ADD) == 3 && Instrumentation::getCalls(PHASE_CALCULATE) == 2 &&
+        Instrumentation::getCount(COUNTER_ELEMENT_EVALUATIONS) == 4 && Instrumentation::getCount(COUNTER_ALLOCATIONS) == 3 &&
+        Instrumentation::getCount(COUNTER_EXCEPTIONS) == 1 && Instrumentation::getSeconds(PHASE_CALCULATE) > 0)
+        cout << "\tInstrumentation -> getCalls(stats_phase) & getCount(stats_counter) : works properly\n";
+    else cout << "\tInstrumentation -> getCalls(stats_phase) || getCount(stats_counter) : works faulty\n";
+
+    Instrumentation::reset();
+    if (Instrumentation::getCalls(PHASE_ADD) == 0 && Instrumentation::getCount(COUNTER_ALLOCATIONS) == 0)
+        cout << "\tInstrumentation -> reset() : works properly\n";
+    else cout << "\tInstrumentation -> reset() : works faulty\n";
+}
+
+void test_Trace(){
+    cout << "\n\nTesting \e[1mTrace:\e[0m\n\n";
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens ThinL = ThinLens(20, 10);
+    OS.add(ThinL, "Lens1");
+
+    Trace::clear();
+    Trace::enable(true);
+    OS.Calculate();
+    ToleranceAnalysis TA = ToleranceAnalysis(OS);
+    TA.addTolerance("Lens1", "f", "normal", 0.1);
+    TA.setThreads(2);
+    TA.run(20000);
+    Trace::enable(false);
+    long long Count = Trace::getEventCount();
+    OS.Calculate();
+    Trace::write("test_trace.json");
+
+    ifstream File("test_trace.json");
+    string Content((istreambuf_iterator<char>(File)), istreambuf_iterator<char>());
+    remove("test_trace.json");
+    if (Count > 2 && Trace::getEventCount() == Count && Content.find("\"name\": \"calculate\"") != string::npos &&
+        Content.find("\"name\": \"tolerance_block\"") != string::npos && Content.find("\"ph\": \"X\"") != string::npos)
+        cout << "\tTrace -> enable(bool) & write(string) : works properly\n";
+    else cout << "\tTrace -> enable(bool) || write(string) : works faulty\n";
+    Trace::clear();
+}
+
+void test_OutputWriter(){
+    cout << "\n\nTesting \e[1mOutputWriter:\e[0m\n\n";
+    vector<double> Values = {0, -0.0, 1, -1.5, 0.1, 1.0 / 3, 123456789.123, 1e-7, 1e30, -2.5e-300, 5e-324, 1.7976931348623157e308,
+                             HUGE_VAL, -HUGE_VAL, NAN};
+    // Every number as the stream formats it, in the default state, in a changed state and with widths
+    stringstream Expected, Actual, ExpectedFixed, ActualFixed;
+    ExpectedFixed << fixed << setprecision(3);
+    ActualFixed << fixed << setprecision(3);
+    {
+        OutputWriter Writer = OutputWriter(Actual, 16);
+        OutputWriter WriterFixed = OutputWriter(ActualFixed);
+        for (double V : Values) {
+            Expected << V << " " << right << fixed << setprecision(6) << setw(15) << V << defaultfloat
+                     << setprecision(17) << V << setprecision(6) << left << setw(13) << "|" << true << "\n";
+            Writer << V << " ";
+            Writer.writeFixed(V, 6, 15);
+            Writer.writeGeneral(V, 17);
+            Writer.writeText("|", 13);
+            Writer << true << "\n";
+            ExpectedFixed << V << ";";
+            WriterFixed << V << ";";
+        }
+    }
+    if (Actual.str() == Expected.str() && ActualFixed.str() == ExpectedFixed.str())
+        cout << "\tOutputWriter -> operator<<, writeFixed, writeGeneral, writeText : works properly\n";
+    else cout << "\tOutputWriter -> operator<<, writeFixed, writeGeneral, writeText : works faulty\n";
+
+    // toString goes through the writer and still honours the precision of the stream
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 1.0 / 3));
+    stringstream Summary;
+    Summary << setprecision(3);
+    OS.toString(Summary);
+    if (Summary.str().find("Object Position: 0, Size: 0.333\n") != string::npos)
+        cout << "\tOpticalSystem -> toString(OutputWriter&) : works properly\n";
+    else cout << "\tOpticalSystem -> toString(OutputWriter&) : works faulty\n";
+}
+
+void test_Report(){
+    cout << "\n\nTesting \e[1mReport:\e[0m\n\n";
+    // Two systems on consecutive lines of one stream
+    stringstream Input;
+    Input << "{\"object\": {\"position\": 0, \"size\": 5}, \"lenses\": [{\"name\": \"L1\", \"type\": \"thin\", \"position\": 20, \"focal_length\": 10}]}\n"
+          << "{\"object\": {\"position\": 0, \"size\": 2}, \"lenses\": [{\"name\": \"L1\", \"type\": \"thin\", \"position\": 30, \"focal_length\": 10}]}\n";
+    OpticalSystem OS1 = OpticalSystem(Input);
+    OpticalSystem OS2 = OpticalSystem(Input);
+    if (OS1.Calculate().getX() == 40 && OS2.Calculate().getX() == 45)
+        cout << "\tOpticalSystem -> OpticalSystem(istream&) : works properly\n";
+    else cout << "\tOpticalSystem -> OpticalSystem(istream&) : works faulty\n";
+
+    stringstream Output;
+    Report::writeJson(OS1, Output, true, true);
+    string Line = Output.str();
+    if (Line.find("\"image\":{\"real\":true,\"x\":40.0,\"y\":-5.0}") == 1 && Line.find("\"images\":[") != string::npos &&
+        Line.find("\"ray_2\":{\"x\":[0.0,20.0,40.0]") != string::npos && Line.find('\n') == Line.size() - 1)
+        cout << "\tReport -> writeJson(OpticalSystem&, ostream&, bool, bool) : works properly\n";
+    else cout << "\tReport -> writeJson(OpticalSystem&, ostream&, bool, bool) : works faulty\n";
+
+    stringstream Csv;
+    Report::write(OS1, Csv, true, true, Report::parseFormat("csv"));
+    if (Csv.str() == "kind,index,x,y,z,real\nimage,0,40,-5,0,1\nray_1,0,0,5,,\nray_1,1,20,5,,\nray_1,2,40,-5,,\n"
+                     "ray_2,0,0,5,,\nray_2,1,20,0,,\nray_2,2,40,-5,,\n")
+        cout << "\tReport -> writeCsv(OpticalSystem&, ostream&, bool, bool) : works properly\n";
+    else cout << "\tReport -> writeCsv(OpticalSystem&, ostream&, bool, bool) : works faulty\n";
+
+    // Header, image arrays and ray arrays at their documented offsets
+    stringstream Binary;
+    Report::writeBinary(OS1, Binary, true, true);
+    string Bytes = Binary.str();
+    uint32_t Version;
+    uint64_t Counts[2];
+    double FinalX, RayY;
+    memcpy(&Version, Bytes.data() + 8, 4);
+    memcpy(Counts, Bytes.data() + 16, 16);
+    memcpy(&FinalX, Bytes.data() + 32, 8);
+    memcpy(&RayY, Bytes.data() + 64 + 24 + 8 + 8 * 3, 8);
+    if (Bytes.compare(0, 8, "OPTISIMB") == 0 && Version == 2 && Counts[0] == 1 && Counts[1] == 3 && FinalX == 40 && RayY == 5 &&
+        Bytes.size() == 64 + 24 + 8 + 32 * 3)
+        cout << "\tReport -> writeBinary(OpticalSystem&, ostream&, bool, bool) : works properly\n";
+    else cout << "\tReport -> writeBinary(OpticalSystem&, ostream&, bool, bool) : works faulty\n";
+
+    // An object out of the meridional plane gives images with a z-coordinate in every format
+    OpticalSystem OS3 = OpticalSystem();
+    OS3.add(LightSource(0, 5, 2));
+    ThinLens OffLens = ThinLens(20, 10);
+    OS3.add(OffLens, "L1");
+    double FinalZ = OS3.Calculate().getZ();
+    stringstream Text, OffCsv, OffBinary;
+    Report::write(OS3, Text, true);
+    Report::writeCsv(OS3, OffCsv);
+    Report::writeBinary(OS3, OffBinary, true);
+    string OffBytes = OffBinary.str();
+    double BinaryZ[2];
+    memcpy(&BinaryZ[0], OffBytes.data() + 48, 8);
+    memcpy(&BinaryZ[1], OffBytes.data() + 64 + 16, 8);
+    if (FinalZ != 0 && Text.str().find(", Size z: ") != string::npos && Text.str().find("Z coordinate") != string::npos &&
+        OffCsv.str().find("image,0,40,-5," + to_string((int)FinalZ) + ",1\n") != string::npos && BinaryZ[0] == FinalZ && BinaryZ[1] == FinalZ)
+        cout << "\tReport -> write(OpticalSystem&, ostream&, bool, bool, report_format) off the meridional plane : works properly\n";
+    else cout << "\tReport -> write(OpticalSystem&, ostream&, bool, bool, report_format) off the meridional plane : works faulty\n";
+}
+
+void test_BatchRunner(){
+    cout << "\n\nTesting \e[1mBatchRunner:\e[0m\n\n";
+    for (int i = 0; i < 4; i++) SystemGenerator(i + 1).write("batch_system_" + to_string(i) + ".json", 200);
+    ofstream Broken("batch_system_broken.json");
+    Broken << "{\"object\": {\"position\": 0, \"size\": 1}, \"lenses\": [{\"name\": \"L\", \"position\": 10}]}";
+    Broken.close();
+    ofstream Manifest("batch_manifest.txt");
+    Manifest << "# systems\nbatch_system_0.json\n\nbatch_system_1.json\n";
+    Manifest.close();
+
+    BatchRunner Runner = BatchRunner();
+    Runner.addGlob("batch_system_?.json");
+    Runner.addManifest("batch_manifest.txt");
+    Runner.addInput("batch_system_broken.json");
+    if (Runner.getInputs().size() == 7 && Runner.getInputs()[4].find("batch_system_0.json") != string::npos)
+        cout << "\tBatchRunner -> addGlob(string), addManifest(string) : works properly\n";
+    else cout << "\tBatchRunner -> addGlob(string), addManifest(string) : works faulty\n";
+
+    // The aggregated output holds the reports in input order, each identical to a single run
+    Runner.setThreads(3);
+    Runner.setAggregateOutput("batch_output.txt");
+    batch_result Result = Runner.run();
+    OpticalSystem OS = OpticalSystem("batch_system_2.json");
+    OS.Calculate();
+    stringstream Expected;
+    Report::write(OS, Expected);
+    ifstream Output("batch_output.txt");
+    string Aggregated((istreambuf_iterator<char>(Output)), istreambuf_iterator<char>());
+    size_t Third = Aggregated.find("#    INPUT: ./batch_system_2.json\n");
+    if (Result.inputs == 7 && Result.failed == 1 && Result.errors.size() == 1 && Result.elements == 6 * 200 &&
+        Third != string::npos && Aggregated.compare(Third + 34, Expected.str().size(), Expected.str()) == 0 &&
+        Third > Aggregated.find("batch_system_1.json"))
+        cout << "\tBatchRunner -> run() : works properly\n";
+    else cout << "\tBatchRunner -> run() : works faulty\n";
+
+    // Other formats are written one report per input, named with the extension of the format
+    BatchRunner Formatted;
+    Formatted.addInput("batch_system_0.json");
+    Formatted.setFormat(FORMAT_CSV);
+    bool Rejected = false;
+    try {
+        Formatted.setAggregateOutput("batch_output.csv");
+        Formatted.run();
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    Formatted.setOutputDirectory("batch_reports");
+    Formatted.run();
+    ifstream Csv("batch_reports/batch_system_0.csv");
+    string Header;
+    getline(Csv, Header);
+    if (Rejected && Header.rfind("kind,index,", 0) == 0)
+        cout << "\tBatchRunner -> setFormat(report_format) : works properly\n";
+    else cout << "\tBatchRunner -> setFormat(report_format) : works faulty\n";
+    Csv.close();
+    filesystem::remove_all("batch_reports");
+    remove("batch_output.csv");
+
+    for (int i = 0; i < 4; i++) remove(("batch_system_" + to_string(i) + ".json").c_str());
+    remove("batch_system_broken.json");
+    remove("batch_manifest.txt");
+    remove("batch_output.txt");
+}
+
+void test_SimulationServer(){
+    cout << "\n\nTesting \e[1mSimulationServer:\e[0m\n\n";
+    SimulationServer Server = SimulationServer();
+    Server.handleCommand("{\"cmd\": \"add\", \"type\": \"object\", \"position\": 0, \"size\": 5}");
+    Server.handleCommand("{\"cmd\": \"add\", \"type\": \"thin\", \"name\": \"Lens1\", \"position\": 20, \"focal_length\": 10}");
+    Server.handleCommand("{\"cmd\": \"add\", \"type\": \"thick\", \"name\": \"Lens2\", \"position\": 60, \"refractive_index\": 1.5, "
+                         "\"thickness\": 4, \"radius_left\": 20, \"radius_right\": -25}");
+    Server.handleCommand("{\"cmd\": \"modify\", \"name\": \"Lens1\", \"param\": \"f\", \"value\": 12}");
+    string Response = Server.handleCommand("{\"cmd\": \"calculate\", \"id\": 7}");
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens ThinL = ThinLens(20, 12);
+    ThickLens ThickL = ThickLens(60, 1.5, 4, 20, -25);
+    OS.add(ThinL, "Lens1");
+    OS.add(ThickL, "Lens2");
+    // the coordinates are written with the fewest digits that read back as the same double
+    double Expected = OS.Calculate().getX();
+    auto ImageX = [](const string& R) { size_t p = R.find("\"x\":"); return p == string::npos ? 0.0 : stod(R.substr(p + 4)); };
+    if (Response.find("\"id\":7") != string::npos && Response.find("\"ok\":true") != string::npos && ImageX(Response) == Expected)
+        cout << "\tSimulationServer -> handleCommand(string) : works properly\n";
+    else cout << "\tSimulationServer -> handleCommand(string) : works faulty\n";
+
+    if (Server.handleCommand("{\"cmd\": \"remove\", \"name\": \"Lens3\"}").find("\"ok\":false") != string::npos &&
+        Server.handleCommand("not json").find("\"ok\":false") != string::npos)
+        cout << "\tSimulationServer -> handleCommand(string) with invalid requests : works properly\n";
+    else cout << "\tSimulationServer -> handleCommand(string) with invalid requests : works faulty\n";
+
+    // Two clients are served by the event loop at the same time
+    thread Loop([&Server]() { Server.serve("test_server.sock"); });
+    sockaddr_un Address{};
+    Address.sun_family = AF_UNIX;
+    strcpy(Address.sun_path, "test_server.sock");
+    int Client1 = socket(AF_UNIX, SOCK_STREAM, 0);
+    int Client2 = socket(AF_UNIX, SOCK_STREAM, 0);
+    for (int i = 0; i < 200 && connect(Client1, (sockaddr*)&Address, sizeof(Address)) < 0; i++) this_thread::sleep_for(chrono::milliseconds(10));
+    connect(Client2, (sockaddr*)&Address, sizeof(Address));
+    string Request = "{\"cmd\": \"calculate\"}\n";
+    send(Client1, Request.data(), Request.size(), 0);
+    send(Client2, Request.data(), Request.size(), 0);
+    string Answers[2];
+    int Clients[2] = {Client1, Client2};
+    for (int c = 0; c < 2; c++) {
+        char Buffer[4096];
+        ssize_t n;
+        while (Answers[c].find('\n') == string::npos && (n = read(Clients[c], Buffer, sizeof(Buffer))) > 0) Answers[c].append(Buffer, n);
+    }
+    // A client that stops sending still receives every answer, even when they overflow the socket buffer
+    int Client3 = socket(AF_UNIX, SOCK_STREAM, 0);
+    connect(Client3, (sockaddr*)&Address, sizeof(Address));
+    string Batch;
+    for (int i = 0; i < 20000; i++) Batch += "{\"cmd\": \"calculate\"}\n";
+    send(Client3, Batch.data(), Batch.size(), 0);
+    shutdown(Client3, SHUT_WR);
+    string Drained;
+    {
+        char Buffer[4096];
+        ssize_t n;
+        while ((n = read(Client3, Buffer, sizeof(Buffer))) > 0) Drained.append(Buffer, n);
+    }
+    close(Client3);
+    Request = "{\"cmd\": \"shutdown\"}\n";
+    send(Client1, Request.data(), Request.size(), 0);
+    Loop.join();
+    close(Client1);
+    close(Client2);
+    if (Answers[0] == Answers[1] && ImageX(Answers[0]) == Expected && count(Drained.begin(), Drained.end(), '\n') == 20000)
+        cout << "\tSimulationServer -> serve(string) : works properly\n";
+    else cout << "\tSimulationServer -> serve(string) : works faulty\n";
+}
+
+/**
+ * @brief A memory resource counting the memory it hands out, used to check where the element pool gets its memory.
+ */
+struct CountingResource : pmr::memory_resource {
+    long long Allocations = 0;
+    long long Outstanding = 0;
+    void* do_allocate(size_t Bytes, size_t Alignment) override {
+        Allocations++;
+        Outstanding += Bytes;
+        return pmr::new_delete_resource()->allocate(Bytes, Alignment);
+    }
+    void do_deallocate(void* Pointer, size_t Bytes, size_t Alignment) override {
+        Outstanding -= Bytes;
+        pmr::new_delete_resource()->deallocate(Pointer, Bytes, Alignment);
+    }
+    bool do_is_equal(const pmr::memory_resource& Other) const noexcept override { return this == &Other; }
+};
+
+void test_ElementPool(){
+    cout << "\n\nTesting \e[1mElementPool:\e[0m\n\n";
+    // Consecutive objects are neighbours and a freed slot is reused
+    ElementPool Pool = ElementPool();
+    ThinLens* First = Pool.create<ThinLens>(10, 5);
+    ThinLens* Second = Pool.create<ThinLens>(20, 5);
+    Pool.destroy(First);
+    ThinLens* Third = Pool.create<ThinLens>(30, 5);
+    // a slot holds a header of one alignment unit, the lens and at most one unit of padding
+    ptrdiff_t Distance = (char*)Second - (char*)Third;
+    if (Third == First && Distance > 0 && Distance <= sizeof(ThinLens) + 2 * alignof(max_align_t) && Pool.size() == 2 && Third->getX() == 30)
+        cout << "\tElementPool -> create(), destroy() : works properly\n";
+    else cout << "\tElementPool -> create(), destroy() : works faulty\n";
+    Pool.destroy(Second);
+    Pool.destroy(Third);
+
+    // A system of a thousand lenses asks its resource for a few chunks and gives all of them back
+    CountingResource Resource;
+    long long Chunks;
+    {
+        OpticalSystem OS = OpticalSystem(&Resource);
+        OS.add(LightSource(0, 5));
+        for (int i = 1; i <= 1000; i++) {
+            ThinLens L = ThinLens(i, 10);
+            OS.add(L, "L" + to_string(i));
+        }
+        Chunks = Resource.Allocations;
+        for (int i = 1; i <= 1000; i++) OS.modifyOpticalObject("L" + to_string(i), "x", i + 0.5);
+        Chunks = Resource.Allocations == Chunks ? Chunks : -1;
+    }
+    if (Chunks > 0 && Chunks < 20 && Resource.Outstanding == 0)
+        cout << "\tOpticalSystem -> OpticalSystem(pmr::memory_resource*) : works properly\n";
+    else cout << "\tOpticalSystem -> OpticalSystem(pmr::memory_resource*) : works faulty\n";
+}
+
+void test_NameTable(){
+    cout << "\n\nTesting \e[1mNameTable:\e[0m\n\n";
+    NameTable Names = NameTable();
+    int Id1 = Names.intern("Lens1");
+    int Id2 = Names.intern(string_view("Lens2"));
+    if (Id1 == 0 && Id2 == 1 && Names.intern(string("Lens1")) == Id1 && Names.find("Lens2") == Id2 && Names.find("Lens3") == -1 &&
+        Names.getName(Id2) == "Lens2")
+        cout << "\tNameTable -> intern(string_view), find(string_view), getName(int) : works properly\n";
+    else cout << "\tNameTable -> intern(string_view), find(string_view), getName(int) : works faulty\n";
+
+    // the released ID is handed to the next new name; the stored names never move
+    const string& Name2 = Names.getName(Id2);
+    Names.release(Id1);
+    for (int i = 0; i < 1000; i++) Names.intern("L" + to_string(i));
+    if (Names.find("Lens1") == -1 && Names.find("L0") == Id1 && Names.size() == 1001 && &Names.getName(Id2) == &Name2 && Name2 == "Lens2")
+        cout << "\tNameTable -> release(int) : works properly\n";
+    else cout << "\tNameTable -> release(int) : works faulty\n";
+
+    // The system looks names up without temporary strings and keeps a rejected element where it was
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens L1 = ThinLens(20, 10);
+    ThinLens L2 = ThinLens(40, 10);
+    string_view Name = "Lens1";
+    OS.add(L1, Name);
+    OS.add(L2, "Lens2");
+    bool Rejected = false;
+    try {
+        OS.modifyOpticalObject("Lens1", "x", 40.0001);
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    OS.modifyOpticalObject(OS.getElement(0).name, "x", 60);
+    if (Rejected && OS.getElement(0).name == "Lens2" && OS.getElement(1).name == "Lens1" && OS.getElement(1).x == 60)
+        cout << "\tOpticalSystem -> add(OpticalObject&, string_view), modifyOpticalObject(string_view, string_view, double) : works properly\n";
+    else cout << "\tOpticalSystem -> add(OpticalObject&, string_view), modifyOpticalObject(string_view, string_view, double) : works faulty\n";
+}
+
+void test_Allocations(){
+    cout << "\n\nTesting \e[1mallocations:\e[0m\n\n";
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens L1 = ThinLens(20, 10);
+    ThickLens L2 = ThickLens(60, 1.5, 5, 40, -40);
+    ThinLens L3 = ThinLens(90, -20);
+    OS.add(L1, "Lens1");
+    OS.add(L2, "Lens2");
+    OS.add(L3, "Lens3");
+
+    // the first calculation sizes the buffers, every later one reuses them
+    Image First = OS.Calculate();
+    long long Before = HeapAllocations;
+    Image Second = OS.Calculate();
+    long long During = HeapAllocations - Before;
+    if (During == 0 && Second.getX() == First.getX() && Second.getY() == First.getY())
+        cout << "\tOpticalSystem -> Calculate() : works properly (no heap allocations in steady state)\n";
+    else cout << "\tOpticalSystem -> Calculate() : works faulty (" << During << " heap allocations in steady state)\n";
+
+    Before = HeapAllocations;
+    const vector<Image>& Images = OS.getImageSequence();
+    const map<string, ray>& Rays = OS.getRays();
+    double X[3];
+    size_t Count = OS.exportElements(nullptr, X, nullptr, nullptr, nullptr, nullptr, nullptr, 3);
+    During = HeapAllocations - Before;
+    if (During == 0 && Images.size() == 3 && Rays.size() == 2 && Count == 3 && X[1] == 60)
+        cout << "\tOpticalSystem -> getImageSequence(), getRays(), exportElements(...) : works properly (no heap allocations)\n";
+    else cout << "\tOpticalSystem -> getImageSequence(), getRays(), exportElements(...) : works faulty\n";
+}
+
+/**
+ * @brief Tells whether every ray of a bundle passes through a point, within a relative tolerance.
+ */
+bool converges(const ray_bundle& Rays, const Image& Point){
+    for (size_t i = 0; i < Rays.x.size(); i++) {
+        double Y = Rays.y[i] + (Point.getX() - Rays.x[i]) * Rays.u[i];
+        double Z = Rays.z[i] + (Point.getX() - Rays.x[i]) * Rays.v[i];
+        if (abs(Y - Point.getY()) > 1e-9 * (1 + abs(Point.getY())) || abs(Z - Point.getZ()) > 1e-9 * (1 + abs(Point.getZ()))) return false;
+    }
+    return true;
+}
+
+void test_OffAxis(){
+    cout << "\n\nTesting \e[1moff-axis systems:\e[0m\n\n";
+    // a decentered lens images around its own axis
+    OpticalSystem Decentered = OpticalSystem();
+    Decentered.add(LightSource(0, 5));
+    ThinLens L = ThinLens(20, 10);
+    L.setY(1);
+    Decentered.add(L, "Lens1");
+    Image Shifted = Decentered.Calculate();
+    if (abs(Shifted.getX() - 40) < 1e-12 && abs(Shifted.getY() + 3) < 1e-12 && Shifted.getReal())
+        cout << "\tOpticalSystem -> Calculate() : works properly (decentered lens)\n";
+    else cout << "\tOpticalSystem -> Calculate() : works faulty (decentered lens)\n";
+
+    // every ray from the object meets at the image, on and off the axis
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens L1 = ThinLens(20, 10);
+    ThickLens L2 = ThickLens(60, 1.5, 5, 40, -40);
+    ThinLens L3 = ThinLens(90, -20);
+    OS.add(L1, "Lens1");
+    OS.add(L2, "Lens2");
+    OS.add(L3, "Lens3");
+    ray_bundle Rays;
+    for (int i = 0; i < 9; i++) {
+        Rays.x.push_back(0);
+        Rays.y.push_back(5);
+        Rays.z.push_back(0);
+        Rays.u.push_back(-0.2 + 0.05 * i);
+        Rays.v.push_back(0.1 - 0.02 * i);
+    }
+    ray_bundle Skew = Rays;
+    OS.TraceRays(Skew);
+    Image Centered = OS.Calculate();
+    bool CenteredOk = converges(Skew, Centered);
+
+    OS.modifyLightSource("z", 1);
+    OS.modifyOpticalObject("Lens2", "y", 0.5);
+    OS.modifyOpticalObject("Lens2", "z", -0.2);
+    OS.modifyOpticalObject("Lens2", "tilt_y", 5);
+    OS.modifyOpticalObject("Lens2", "tilt_z", -3);
+    Skew = Rays;
+    for (double& Z : Skew.z) Z = 1;
+    OS.TraceRays(Skew);
+    Image Tilted = OS.Calculate();
+    if (CenteredOk && converges(Skew, Tilted) && Tilted.getZ() != 0 && Tilted.getY() != Centered.getY())
+        cout << "\tOpticalSystem -> TraceRays(ray_bundle&), Calculate() : works properly\n";
+    else cout << "\tOpticalSystem -> TraceRays(ray_bundle&), Calculate() : works faulty\n";
+
+    // the placement survives saving and loading
+    OS.save("test_off_axis.json");
+    OpticalSystem Loaded = OpticalSystem("test_off_axis.json");
+    remove("test_off_axis.json");
+    Image Reloaded = Loaded.Calculate();
+    element_info Info = Loaded.getElement(1);
+    if (Info.y == 0.5 && Info.z == -0.2 && Info.tilt_y == 5 && Info.tilt_z == -3 && Loaded.getLightSource().getZ() == 1 &&
+        Reloaded.getX() == Tilted.getX() && Reloaded.getY() == Tilted.getY() && Reloaded.getZ() == Tilted.getZ())
+        cout << "\tOpticalSystem -> save(string), OpticalSystem(string) : works properly (decentered and tilted lenses)\n";
+    else cout << "\tOpticalSystem -> save(string), OpticalSystem(string) : works faulty (decentered and tilted lenses)\n";
+
+    bool Rejected = false;
+    try {
+        L1.setTiltY(90);
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    if (Rejected && L1.isCentered())
+        cout << "\tOpticalObject -> setTiltY(double) : works properly\n";
+    else cout << "\tOpticalObject -> setTiltY(double) : works faulty\n";
+}
+
+void test_ApertureStop(){
+    cout << "\n\nTesting \e[1mApertureStop:\e[0m\n\n";
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens L1 = ThinLens(20, 10);
+    ApertureStop Stop = ApertureStop(30, 1.5);
+    ThinLens L3 = ThinLens(90, -20);
+    L3.setAperture(30);
+    OS.add(L1, "Lens1");
+    OS.add(Stop, "Stop");
+    OS.add(L3, "Lens3");
+
+    // a stop does not move the image
+    OpticalSystem Reference = OpticalSystem();
+    Reference.add(LightSource(0, 5));
+    Reference.add(L1, "Lens1");
+    ThinLens Open = ThinLens(90, -20);
+    Reference.add(Open, "Lens3");
+    Image Img = OS.Calculate();
+    Image Expected = Reference.Calculate();
+    if (Img.getX() == Expected.getX() && Img.getY() == Expected.getY() && Img.getReal() == Expected.getReal())
+        cout << "\tApertureStop -> Calculate(ImagingSubject) : works properly\n";
+    else cout << "\tApertureStop -> Calculate(ImagingSubject) : works faulty\n";
+
+    // the rays outside an aperture are stopped there, the others are traced as without apertures
+    ray_bundle Rays;
+    for (int i = 0; i < 41; i++) {
+        Rays.x.push_back(0);
+        Rays.y.push_back(5);
+        Rays.z.push_back(0);
+        Rays.u.push_back(-0.2 + 0.01 * i);
+        Rays.v.push_back(0.05 - 0.0025 * i);
+    }
+    ray_bundle Traced = Rays;
+    OS.TraceRays(Traced);
+    ray_bundle Unlimited = Rays;
+    Reference.TraceRays(Unlimited);
+    int Blocked[3] = {0, 0, 0};
+    bool Consistent = true;
+    for (size_t i = 0; i < Rays.x.size(); i++) {
+        double R = sqrt(Traced.y[i] * Traced.y[i] + Traced.z[i] * Traced.z[i]);
+        if (Traced.vignetted[i] == -1) {
+            Consistent &= Traced.x[i] == Unlimited.x[i] && abs(Traced.y[i] - Unlimited.y[i]) < 1e-9 && abs(Traced.z[i] - Unlimited.z[i]) < 1e-9 &&
+                          abs(Traced.u[i] - Unlimited.u[i]) < 1e-12 && abs(Traced.v[i] - Unlimited.v[i]) < 1e-12;
+            Blocked[0]++;
+        } else if (Traced.vignetted[i] == 1) {
+            Consistent &= Traced.x[i] == 30 && R > 1.5;
+            Blocked[1]++;
+        } else if (Traced.vignetted[i] == 2) {
+            Consistent &= Traced.x[i] == 90 && R > 30;
+            Blocked[2]++;
+        } else Consistent = false;
+    }
+    if (Consistent && Blocked[0] > 0 && Blocked[1] > 0 && Blocked[2] > 0)
+        cout << "\tOpticalSystem -> TraceRays(ray_bundle&) : works properly (vignetting)\n";
+    else cout << "\tOpticalSystem -> TraceRays(ray_bundle&) : works faulty (vignetting)\n";
+
+    // the stop and the apertures survive saving and loading
+    OS.save("test_stop.json");
+    OpticalSystem Loaded = OpticalSystem("test_stop.json");
+    remove("test_stop.json");
+    ray_bundle Reloaded = Rays;
+    Loaded.TraceRays(Reloaded);
+    element_info Info = Loaded.getElement(1);
+    if (Info.type == ELEMENT_STOP && Info.aperture == 1.5 && isnan(Info.f) && Loaded.getElement(2).aperture == 30 &&
+        isinf(Loaded.getElement(0).aperture) && Reloaded.vignetted == Traced.vignetted && Reloaded.y == Traced.y)
+        cout << "\tOpticalSystem -> save(string), OpticalSystem(string) : works properly (aperture stop)\n";
+    else cout << "\tOpticalSystem -> save(string), OpticalSystem(string) : works faulty (aperture stop)\n";
+
+    bool Rejected = false;
+    try {
+        Loaded.modifyOpticalObject("Stop", "aperture", 0);
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    if (Rejected && Loaded.getElement(1).aperture == 1.5)
+        cout << "\tOpticalObject -> setAperture(double) : works properly\n";
+    else cout << "\tOpticalObject -> setAperture(double) : works faulty\n";
+}
+
+void test_Pupils(){
+    cout << "\n\nTesting \e[1mpupils:\e[0m\n\n";
+    // a lens with a stop behind it: the entrance pupil is the virtual image of the stop, the exit pupil the stop itself
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens L = ThinLens(20, 50);
+    L.setAperture(100);
+    ApertureStop Stop = ApertureStop(40, 2);
+    OS.add(L, "Lens");
+    OS.add(Stop, "Stop");
+    pupil_info Info = OS.getPupils();
+    if (Info.aperture_stop == 1 && Info.field_stop == 0 && abs(Info.entrance_x - 160.0 / 3) < 1e-9 &&
+        abs(Info.entrance_radius - 10.0 / 3) < 1e-9 && abs(Info.exit_x - 40) < 1e-9 && abs(Info.exit_radius - 2) < 1e-9 &&
+        abs(Info.marginal_u - 1.0 / 16) < 1e-12 && abs(Info.chief_u + 5 * 0.6 / 32) < 1e-12 && Info.field_height == 5 &&
+        abs(Info.na_object - Info.marginal_u / sqrt(1 + Info.marginal_u * Info.marginal_u)) < 1e-12)
+        cout << "\tOpticalSystem -> getPupils() : works properly\n";
+    else cout << "\tOpticalSystem -> getPupils() : works faulty\n";
+
+    // the cache follows the modifications of the system
+    OS.modifyOpticalObject("Stop", "aperture", 4);
+    OS.modifyOpticalObject("Lens", "aperture", 10);
+    const pupil_info& Modified = OS.getPupils();
+    bool Cached = &Modified == &OS.getPupils();
+    if (Cached && abs(Modified.entrance_radius - 20.0 / 3) < 1e-9 && abs(Modified.exit_radius - 4) < 1e-9 && Modified.aperture_stop == 1 &&
+        Modified.field_stop == 0 && Modified.field_height == 5)
+        cout << "\tOpticalSystem -> getPupils() : works properly (invalidated by modifyOpticalObject)\n";
+    else cout << "\tOpticalSystem -> getPupils() : works faulty (invalidated by modifyOpticalObject)\n";
+
+    // the sampled rays fill the stop, and the first ray of every field point is its chief ray
+    ray_bundle Rays = OS.SampleField(3, 4);
+    OS.TraceRays(Rays);
+    bool Filled = Rays.x.size() == 3 * 61;
+    double Widest = 0;
+    for (size_t i = 0; Filled && i < Rays.x.size(); i++) {
+        double R = sqrt(Rays.y[i] * Rays.y[i] + Rays.z[i] * Rays.z[i]);
+        Widest = max(Widest, R);
+        Filled = Rays.x[i] == 40 && R < 4 + 1e-9 && (i % 61 != 0 || R < 1e-12);
+    }
+    if (Filled && abs(Widest - 4) < 1e-9)
+        cout << "\tOpticalSystem -> SampleField(int, int) : works properly\n";
+    else cout << "\tOpticalSystem -> SampleField(int, int) : works faulty\n";
+
+    bool Rejected = false;
+    OpticalSystem Open = OpticalSystem();
+    Open.add(LightSource(0, 5));
+    ThinLens Unlimited = ThinLens(20, 50);
+    Open.add(Unlimited, "Lens");
+    try {
+        Open.getPupils();
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    if (Rejected)
+        cout << "\tOpticalSystem -> getPupils() : works properly (no aperture)\n";
+    else cout << "\tOpticalSystem -> getPupils() : works faulty (no aperture)\n";
+}
+
+void test_MirrorAndPlate(){
+    cout << "\n\nTesting \e[1mMirror and ParallelPlate:\e[0m\n\n";
+    // a concave mirror images like a thin lens of focal length -r/2
+    Mirror Concave = Mirror(20, -20);
+    ThinLens Equivalent = ThinLens(20, 10);
+    Image FromMirror = Concave.Calculate(LightSource(0, 5));
+    Image FromLens = Equivalent.Calculate(LightSource(0, 5));
+    if (Concave.getF() == 10 && FromMirror.getX() == FromLens.getX() && FromMirror.getY() == FromLens.getY() && FromMirror.getReal())
+        cout << "\tMirror -> Calculate(ImagingSubject) : works properly\n";
+    else cout << "\tMirror -> Calculate(ImagingSubject) : works faulty\n";
+
+    // a folding mirror leaves the image where it is and a plate moves it by d (1 - 1/n)
+    OpticalSystem OS = OpticalSystem();
+    OS.add(LightSource(0, 5));
+    ThinLens L = ThinLens(20, 10);
+    Mirror Fold = Mirror(25);
+    ParallelPlate Window = ParallelPlate(30, 1.5, 6);
+    OS.add(L, "Lens");
+    OS.add(Fold, "Fold");
+    OS.add(Window, "Window");
+    Image Img = OS.Calculate();
+    vector<Image> Chromatic = OS.CalculateChromatic({0.4861, 0.5876, 0.6563});
+    ray_bundle Rays;
+    for (int i = 0; i < 9; i++) {
+        Rays.x.push_back(0);
+        Rays.y.push_back(5);
+        Rays.z.push_back(0);
+        Rays.u.push_back(-0.2 + 0.05 * i);
+        Rays.v.push_back(0.1 - 0.02 * i);
+    }
+    OS.TraceRays(Rays);
+    bool Batched = true;
+    for (const Image& C : Chromatic) Batched &= C.getX() == Img.getX() && C.getY() == Img.getY() && C.getReal() == Img.getReal();
+    if (abs(Img.getX() - 42) < 1e-12 && abs(Img.getY() + 5) < 1e-12 && Img.getReal() && Batched && converges(Rays, Img))
+        cout << "\tOpticalSystem -> Calculate(), CalculateChromatic(vector), TraceRays(ray_bundle&) : works properly (mirror and plate)\n";
+    else cout << "\tOpticalSystem -> Calculate(), CalculateChromatic(vector), TraceRays(ray_bundle&) : works faulty (mirror and plate)\n";
+
+    // both types survive saving and loading, and are modified by name
+    OS.modifyOpticalObject("Fold", "r", -40);
+    OS.save("test_mirror.json");
+    OpticalSystem Loaded = OpticalSystem("test_mirror.json");
+    remove("test_mirror.json");
+    stringstream Summary;
+    Loaded.toString(Summary);
+    element_info M = Loaded.getElement(1);
+    element_info P = Loaded.getElement(2);
+    if (M.type == ELEMENT_MIRROR && M.r_left == -40 && M.f == 20 && P.type == ELEMENT_PLATE && P.n == 1.5 && P.d == 6 && isnan(P.f) &&
+        Loaded.Calculate().getX() == OS.Calculate().getX() && Summary.str().find("Mirror: Fold") != string::npos &&
+        Summary.str().find("Parallel Plate: Window") != string::npos)
+        cout << "\tOpticalSystem -> save(string), OpticalSystem(string), toString(ostream) : works properly (mirror and plate)\n";
+    else cout << "\tOpticalSystem -> save(string), OpticalSystem(string), toString(ostream) : works faulty (mirror and plate)\n";
+
+    bool Rejected = false;
+    try {
+        Loaded.modifyOpticalObject("Window", "f", 10);
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    if (Rejected)
+        cout << "\tOpticalSystem -> modifyOpticalObject(string, string, double) : works properly (plate)\n";
+    else cout << "\tOpticalSystem -> modifyOpticalObject(string, string, double) : works faulty (plate)\n";
+}
+
+void test_GaussianBeam(){
+    cout << "\n\nTesting \e[1mGaussian beams:\e[0m\n\n";
+    // a thin lens moves and resizes the waist as given by the closed form of the beam imaging equation
+    OpticalSystem OS = OpticalSystem();
+    ThinLens L = ThinLens(100, 50);
+    OS.add(L, "Lens");
+    beam_bundle Beams;
+    Beams.waist_x = {0, 20, -30};
+    Beams.waist_w = {0.5, 0.2, 0.05};
+    Beams.wavelength = {1.064, 0.6328, 0.5};
+    OS.PropagateBeams(Beams);
+    const double Pi = acos(-1.0);
+    bool Closed = Beams.x.size() == 3 && Beams.w.size() == 3 && Beams.rayleigh.size() == 3 && Beams.spot.size() == 3;
+    for (int j = 0; Closed && j < 3; j++) {
+        double ZR = Pi * Beams.waist_w[j] * Beams.waist_w[j] / (Beams.wavelength[j] * 1e-3);
+        double S = 100 - Beams.waist_x[j];
+        double D = (S - 50) * (S - 50) + ZR * ZR;
+        double W = Beams.waist_w[j] * 50 / sqrt(D);
+        double Spot = Beams.waist_w[j] * sqrt(1 + S * S / (ZR * ZR));
+        Closed = abs(Beams.x[j] - (150 + 2500 * (S - 50) / D)) < 1e-9 && abs(Beams.w[j] - W) < 1e-12 &&
+                 abs(Beams.rayleigh[j] - Pi * W * W / (Beams.wavelength[j] * 1e-3)) < 1e-9 && abs(Beams.spot[j] - Spot) < 1e-12;
+    }
+    if (Closed)
+        cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works properly (thin lens)\n";
+    else cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works faulty (thin lens)\n";
+
+    // a nearly point-like waist is imaged like a point object, thick lenses included
+    OpticalSystem Train = OpticalSystem();
+    Train.add(LightSource(0, 5));
+    ThinLens First = ThinLens(20, 15);
+    ThickLens Second = ThickLens(120, 1.5, 5, 30, -30);
+    Train.add(First, "First");
+    Train.add(Second, "Second");
+    Image Img = Train.Calculate();
+    beam_bundle Point;
+    Point.waist_x = {0};
+    Point.waist_w = {1e-4};
+    Point.wavelength = {0.5};
+    Train.PropagateBeams(Point);
+    if (Point.x.size() == 2 && abs(Point.x[0] - 80) < 1e-6 && abs(Point.x[1] - Img.getX()) < 1e-6 && Point.w[1] < 1e-2)
+        cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works properly (geometric limit)\n";
+    else cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works faulty (geometric limit)\n";
+
+    // a batch gives the same results as its beams one by one
+    beam_bundle Batch;
+    for (int j = 0; j < 17; j++) {
+        Batch.waist_x.push_back(-10 + j);
+        Batch.waist_w.push_back(0.01 + 0.02 * j);
+        Batch.wavelength.push_back(0.4 + 0.05 * j);
+    }
+    Train.PropagateBeams(Batch);
+    bool Same = Batch.x.size() == 2 * 17;
+    for (int j = 0; Same && j < 17; j++) {
+        beam_bundle Single;
+        Single.waist_x = {Batch.waist_x[j]};
+        Single.waist_w = {Batch.waist_w[j]};
+        Single.wavelength = {Batch.wavelength[j]};
+        Train.PropagateBeams(Single);
+        for (int i = 0; i < 2; i++) {
+            Same &= abs(Single.x[i] - Batch.x[i * 17 + j]) <= 1e-12 * abs(Single.x[i]) &&
+                    abs(Single.w[i] - Batch.w[i * 17 + j]) <= 1e-12 * Single.w[i] &&
+                    abs(Single.rayleigh[i] - Batch.rayleigh[i * 17 + j]) <= 1e-12 * Single.rayleigh[i] &&
+                    abs(Single.spot[i] - Batch.spot[i * 17 + j]) <= 1e-12 * Single.spot[i];
+        }
+    }
+    if (Same)
+        cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works properly (batch)\n";
+    else cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works faulty (batch)\n";
+
+    bool Rejected = false;
+    beam_bundle Invalid;
+    Invalid.waist_x = {0};
+    Invalid.waist_w = {0};
+    Invalid.wavelength = {0.5};
+    try {
+        Train.PropagateBeams(Invalid);
+    } catch (OptiSimError&) {
+        Rejected = true;
+    }
+    if (Rejected)
+        cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works properly (invalid waist)\n";
+    else cout << "\tOpticalSystem -> PropagateBeams(beam_bundle&) : works faulty (invalid waist)\n";
+}
+
+// A lens type that only this test knows about, registered at run time
+class FieldLens: public ThinLens{
+    public:
+        using ThinLens::ThinLens;
+};
+
+void test_ElementRegistry(){
+    cout << "\n\nTesting \e[1mElementRegistry:\e[0m\n\n";
+    element_class Field = {0, "field", "Field Lens", &typeid(FieldLens),
+        {{"f", "focal_length", NAN,
+          [](const OpticalObject& E){ return static_cast<const FieldLens&>(E).getF(); },
+          [](OpticalObject& E, double V){ static_cast<FieldLens&>(E).setF(V); }}},
+        [](double X, const double* V) -> unique_ptr<OpticalObject> { return make_unique<FieldLens>(X, V[0]); },
+        copy_element<FieldLens>, clone_element<FieldLens>,
+        [](const OpticalObject& E, double* DF, double*, double*) -> principal_planes {
+            if (DF) DF[0] = 1;
+            return {static_cast<const FieldLens&>(E).getF(), E.getX(), E.getX()};
+        },
+        nullptr, nullptr, nullptr, nullptr, nullptr};
+    int Id = ElementRegistry::global().add(Field);
+    bool Twice = false;
+    try {
+        ElementRegistry::global().add(Field);
+    } catch (OptiSimError&) {
+        Twice = true;
+    }
+    if (Id == ElementRegistry::global().size() - 1 && Id > ELEMENT_PLATE && Twice && ElementRegistry::global().find("field")->id == Id)
+        cout << "\tElementRegistry -> add(element_class), find(string) : works properly\n";
+    else cout << "\tElementRegistry -> add(element_class), find(string) : works faulty\n";
+
+    // the new type is loaded, printed, modified, saved and optimized without further code
+    stringstream Input;
+    Input << "{\"object\": {\"position\": 0, \"size\": 5}, \"lenses\": [{\"name\": \"F1\", \"type\": \"field\", \"position\": 20, \"focal_length\": 10}]}";
+    OpticalSystem OS = OpticalSystem(Input);
+    OS.modifyOpticalObject("F1", "f", 15);
+    stringstream Summary;
+    OS.toString(Summary);
+    OS.save("test_registry.json");
+    OpticalSystem Loaded = OpticalSystem("test_registry.json");
+    remove("test_registry.json");
+    if (OS.getElement(0).type == Id && OS.getParameter("F1", "f") == 15 && abs(OS.Calculate().getX() - 80) < 1e-12 &&
+        Loaded.getParameter("F1", "f") == 15 && Summary.str().find("Field Lens: F1, Position: 20, f: 15") != string::npos)
+        cout << "\tOpticalSystem -> OpticalSystem(istream), modifyOpticalObject, toString, save with a registered type : works properly\n";
+    else cout << "\tOpticalSystem -> OpticalSystem(istream), modifyOpticalObject, toString, save with a registered type : works faulty\n";
+
+    Optimizer Opt = Optimizer(OS);
+    Opt.addVariable("F1", "f", 1, 30);
+    Opt.addTarget("x", 40);
+    optimization_result Res = Opt.run();
+    if (Res.converged && abs(OS.Calculate().getX() - 40) < 1e-6)
+        cout << "\tOptimizer -> run() with a registered type : works properly\n";
+    else cout << "\tOptimizer -> run() with a registered type : works faulty\n";
+
+    // the schema of a built-in type drives the optimizer too: a plate's thickness moves the image by d (1 - 1/n)
+    OpticalSystem OS2 = OpticalSystem();
+    OS2.add(LightSource(0, 5));
+    ThinLens L = ThinLens(20, 10);
+    ParallelPlate Window = ParallelPlate(30, 1.5, 6);
+    OS2.add(L, "Lens");
+    OS2.add(Window, "Window");
+    Optimizer Opt2 = Optimizer(OS2);
+    Opt2.addVariable("Window", "d", 1, 20);
+    Opt2.addTarget("x", 43);
+    Res = Opt2.run();
+    bool ReadOnly = false;
+    ThickLens Thick = ThickLens(60, 1.5, 3, 25, -40);
+    OS2.add(Thick, "Thick");
+    try {
+        OS2.modifyOpticalObject("Thick", "f", 10);
+    } catch (OptiSimError&) {
+        ReadOnly = true;
+    }
+    if (Res.converged && abs(OS2.getParameter("Window", "d") - 9) < 1e-6 && ReadOnly && OS2.getParameter("Thick", "f") == Thick.getF())
+        cout << "\tOptimizer -> run() with a plate & OpticalSystem -> getParameter(string, string) : works properly\n";
+    else cout << "\tOptimizer -> run() with a plate & OpticalSystem -> getParameter(string, string) : works faulty\n";
+}
+
+void test_FileWatcher(){
+    cout << "\n\nTesting \e[1mFileWatcher:\e[0m\n\n";
+    // Only the changed lens is rebuilt, the unchanged one is kept
+    stringstream Before, After;
+    Before << "{\"object\": {\"position\": 0, \"size\": 5}, \"lenses\": [{\"name\": \"L1\", \"type\": \"thin\", \"position\": 20, \"focal_length\": 10}, "
+           << "{\"name\": \"L2\", \"type\": \"thin\", \"position\": 60, \"focal_length\": 10}]}";
+    After << "{\"object\": {\"position\": 0, \"size\": 5}, \"lenses\": [{\"name\": \"L1\", \"type\": \"thin\", \"position\": 20, \"focal_length\": 10}, "
+          << "{\"name\": \"L3\", \"type\": \"thin\", \"position\": 70, \"focal_length\": 10}]}";
+    OpticalSystem Resident = OpticalSystem(Before);
+    OpticalSystem Parsed = OpticalSystem(After);
+    int Changed = Resident.update(Parsed);
+    int Unchanged = Resident.update(Parsed);
+    OpticalSystem Expected = OpticalSystem();
+    Expected.add(LightSource(0, 5));
+    ThinLens L1 = ThinLens(20, 10);
+    ThinLens L3 = ThinLens(70, 10);
+    Expected.add(L1, "L1");
+    Expected.add(L3, "L3");
+    if (Changed == 2 && Unchanged == 0 && Resident.Calculate().getX() == Expected.Calculate().getX())
+        cout << "\tOpticalSystem -> update(OpticalSystem&) : works properly\n";
+    else cout << "\tOpticalSystem -> update(OpticalSystem&) : works faulty\n";
+
+    // A write of the watched file is reported, a write of another file is not
+    ofstream("test_watch.json") << "{}";
+    FileWatcher Watcher = FileWatcher("test_watch.json");
+    ofstream("test_watch_other.json") << "{}";
+    bool Other = Watcher.wait(100);
+    thread Writer([]() {
+        this_thread::sleep_for(chrono::milliseconds(50));
+        ofstream("test_watch.json") << "{\"lenses\": []}";
+    });
+    bool Written = Watcher.wait(5000);
+    Writer.join();
+    remove("test_watch.json");
+    remove("test_watch_other.json");
+    if (!Other && Written)
+        cout << "\tFileWatcher -> wait(int) : works properly\n";
+    else cout << "\tFileWatcher -> wait(int) : works faulty\n";
+}
 
 int main(int argc, char* argv[]){
     try{
         test_LightSource();
         test_ThinLens();
         test_ThickLens();
+        test_DispersionModel();
+        test_MaterialCatalog();
         test_OpticalSystem();
+        test_Optimizer();
+        test_ToleranceAnalysis();
+        test_SystemGenerator();
+        test_Instrumentation();
+        test_Trace();
+        test_OutputWriter();
+        test_Report();
+        test_BatchRunner();
+        test_SimulationServer();
+        test_FileWatcher();
+        test_ElementPool();
+        test_NameTable();
+        test_Allocations();
+        test_OffAxis();
+        test_ApertureStop();
+        test_Pupils();
+        test_MirrorAndPlate();
+        test_ElementRegistry();
+        test_GaussianBeam();
         
     }catch(exception& e) // Catch any standard exception or custom OptiSimError
     {
@@ -1,4 +1,5 @@
 import optisim as op # import optisim library components
+import array # writable buffers for the bulk export
 
 def test_LightSource():
     print("\n\nTesting LightSource:\n\n")
@@ -140,6 +141,16 @@ def test_OpticalSystem():
     else: 
         print("\tOpticalSystem -> add(OpticalObject&, string) || getSystemElements() : works faulty\n")
 
+    # Describe the Lenses without copying them & export their parameters into arrays
+    Elements = OS.getElements()
+    X = array.array("d", [0.0] * OS.getElementCount())
+    Types = array.array("i", [0] * OS.getElementCount())
+    Count = OS.exportElements(type=Types, x=X)
+    if Elements[0]["name"] == "Lens1" and Elements[1]["type"] == op.ElementType.THICK_LENS and Count == 2 and list(X) == [10, 30] and Types[1] == int(op.ElementType.THICK_LENS):
+        print("\tOpticalSystem -> getElements() & exportElements(...) : works properly\n")
+    else:
+        print("\tOpticalSystem -> getElements() || exportElements(...) : works faulty\n")
+
     # Modify LightSource & get LightSource from OpticalSystem & check whether the modification was successful
     OS.modifyLightSource("x",-20)
     OS.modifyLightSource("y",10)